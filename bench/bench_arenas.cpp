@@ -0,0 +1,94 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include "segregated_allocator.h"
+#include "arena_allocator.h"
+
+//small-object churn: every thread keeps a window of live blocks and replaces one per op
+const int OPS_PER_THREAD = 200000;
+const int WINDOW = 128;
+
+//one SegregatedListAllocator behind one lock
+struct GlobalLockAllocator {
+    SegregatedListAllocator allocator;
+    std::mutex lock;
+
+    word_t* alloc(size_t size) {
+        std::lock_guard<std::mutex> guard(lock);
+        return allocator.alloc(size);
+    }
+
+    void free(word_t* data) {
+        std::lock_guard<std::mutex> guard(lock);
+        allocator.free(data);
+    }
+};
+
+struct CpuArenas : ArenaAllocator {
+    CpuArenas() : ArenaAllocator(0, Selection::CurrentCpu) {}
+};
+
+struct RoundRobinArenas : ArenaAllocator {
+    RoundRobinArenas() : ArenaAllocator(0, Selection::RoundRobin) {}
+};
+
+template <typename Allocator>
+void worker(Allocator& allocator, unsigned seed) {
+    std::vector<word_t*> live(WINDOW, nullptr);
+
+    for(int i = 0; i < OPS_PER_THREAD; i++) {
+        seed = seed * 1103515245 + 12345;
+        int slot = (seed >> 8) % WINDOW;
+        size_t size = 8 + (seed >> 16) % 121; //8..128 bytes, slab runs and small buckets
+
+        if(live[slot]) allocator.free(live[slot]);
+        live[slot] = allocator.alloc(size);
+        *live[slot] = i;
+    }
+
+    for(word_t* ptr : live) {
+        if(ptr) allocator.free(ptr);
+    }
+}
+
+template <typename Allocator>
+double run(int numThreads) {
+    Allocator allocator;
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&allocator, t]() { worker(allocator, 12345u + t); });
+    }
+    for(auto& thread : threads) thread.join();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return 2.0 * OPS_PER_THREAD * numThreads / seconds / 1e6; //alloc + free per op
+}
+
+int main() {
+    std::cout << "Arena Benchmark (" << std::thread::hardware_concurrency() << " hardware threads, "
+              << CpuArenas().arenaCount() << " arenas)\n";
+    std::cout << "=========================================\n";
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "global lock"
+              << std::setw(16) << "per-cpu"
+              << std::setw(16) << "round robin" << "\n";
+
+    for(int numThreads : {1, 2, 4, 8, 16}) {
+        double locked = run<GlobalLockAllocator>(numThreads);
+        double perCpu = run<CpuArenas>(numThreads);
+        double roundRobin = run<RoundRobinArenas>(numThreads);
+
+        std::cout << std::setw(8) << numThreads
+                  << std::setw(11) << std::fixed << std::setprecision(2) << locked << " Mop/s"
+                  << std::setw(11) << perCpu << " Mop/s"
+                  << std::setw(11) << roundRobin << " Mop/s\n";
+    }
+
+    return 0;
+}
\ No newline at end of file
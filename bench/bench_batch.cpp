@@ -0,0 +1,84 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "segregated_allocator.h"
+
+//graph-style workload: nodes of one size come and go in groups, each round builds
+//GROUPS groups of GROUP_SIZE nodes and then tears them down group by group
+const int ROUNDS = 200;
+const int GROUPS = 64;
+const size_t GROUP_SIZE = 256;
+
+struct Timing {
+    double allocNs = 0;
+    double freeNs = 0;
+};
+
+double nsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+Timing oneByOne(size_t size) {
+    SegregatedListAllocator allocator;
+    std::vector<word_t*> nodes(GROUPS * GROUP_SIZE);
+    Timing timing;
+
+    for(int round = 0; round < ROUNDS; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < nodes.size(); i++) nodes[i] = allocator.alloc(size);
+        timing.allocNs += nsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < nodes.size(); i++) allocator.free(nodes[i]);
+        timing.freeNs += nsSince(start);
+    }
+
+    return timing;
+}
+
+Timing batched(size_t size) {
+    SegregatedListAllocator allocator;
+    std::vector<word_t*> nodes(GROUPS * GROUP_SIZE);
+    Timing timing;
+
+    for(int round = 0; round < ROUNDS; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for(int group = 0; group < GROUPS; group++) {
+            allocator.allocBatch(size, GROUP_SIZE, &nodes[group * GROUP_SIZE]);
+        }
+        timing.allocNs += nsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for(int group = 0; group < GROUPS; group++) {
+            allocator.freeBatch(&nodes[group * GROUP_SIZE], GROUP_SIZE);
+        }
+        timing.freeNs += nsSince(start);
+    }
+
+    return timing;
+}
+
+int main() {
+    const double objects = double(ROUNDS) * GROUPS * GROUP_SIZE;
+
+    std::cout << "Batch Benchmark: " << ROUNDS << " rounds of " << GROUPS << " groups x "
+              << GROUP_SIZE << " nodes, ns per object\n\n";
+    std::cout << std::setw(8) << "size" << std::setw(14) << "alloc" << std::setw(14) << "allocBatch"
+              << std::setw(10) << "speedup" << std::setw(12) << "free" << std::setw(14) << "freeBatch"
+              << std::setw(10) << "speedup" << "\n";
+
+    for(size_t size : {48, 96, 256, 1024}) {
+        Timing single = oneByOne(size);
+        Timing batch = batched(size);
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << size
+                  << std::setw(14) << single.allocNs / objects << std::setw(14) << batch.allocNs / objects
+                  << std::setw(9) << single.allocNs / batch.allocNs << "x"
+                  << std::setw(12) << single.freeNs / objects << std::setw(14) << batch.freeNs / objects
+                  << std::setw(9) << single.freeNs / batch.freeNs << "x\n";
+    }
+
+    return 0;
+}
\ No newline at end of file
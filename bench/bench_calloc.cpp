@@ -0,0 +1,81 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <sys/resource.h>
+#include "explicit_allocator.h"
+#include "segregated_allocator.h"
+
+//builds up many large zeroed arrays, then frees them all and builds them again:
+//the first round is served from fresh OS memory, the second from recycled blocks
+const int ARRAYS = 256;
+const size_t ARRAY_BYTES = 256 * 1024; //64 MB per round
+
+long minorFaults() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+struct Round {
+    double ms = 0;
+    long faults = 0;
+};
+
+template<typename Allocator, typename Zeroing>
+Round round(Allocator& allocator, std::vector<word_t*>& arrays, Zeroing zeroed) {
+    Round result;
+    long faults = minorFaults();
+    auto start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < ARRAYS; i++) arrays[i] = zeroed(allocator);
+
+    auto end = std::chrono::steady_clock::now();
+    result.ms = std::chrono::duration<double, std::milli>(end - start).count();
+    result.faults = minorFaults() - faults;
+    return result;
+}
+
+template<typename Allocator, typename Zeroing>
+void measure(const char* name, Zeroing zeroed) {
+    Allocator allocator;
+    std::vector<word_t*> arrays(ARRAYS);
+
+    Round fresh = round(allocator, arrays, zeroed);
+    for(word_t* array : arrays) allocator.free(array);
+    Round recycled = round(allocator, arrays, zeroed);
+    for(word_t* array : arrays) allocator.free(array);
+
+    std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << fresh.ms << std::setw(10) << fresh.faults
+              << std::setw(12) << recycled.ms << std::setw(10) << recycled.faults << "\n";
+}
+
+template<typename Allocator>
+word_t* allocAndClear(Allocator& allocator) {
+    word_t* data = allocator.alloc(ARRAY_BYTES);
+    memset(data, 0, ARRAY_BYTES);
+    return data;
+}
+
+template<typename Allocator>
+word_t* callocArray(Allocator& allocator) {
+    return allocator.calloc(ARRAY_BYTES / sizeof(int), sizeof(int));
+}
+
+int main() {
+    std::cout << "Calloc Benchmark: " << ARRAYS << " arrays of " << ARRAY_BYTES / 1024 << " KB per round\n\n";
+    std::cout << std::left << std::setw(30) << "" << std::right
+              << std::setw(20) << "fresh memory" << std::setw(22) << "recycled blocks" << "\n";
+    std::cout << std::left << std::setw(30) << "allocator / method" << std::right
+              << std::setw(10) << "ms" << std::setw(10) << "faults"
+              << std::setw(12) << "ms" << std::setw(10) << "faults" << "\n";
+
+    measure<ExplicitAllocator>("explicit alloc + memset", allocAndClear<ExplicitAllocator>);
+    measure<ExplicitAllocator>("explicit calloc", callocArray<ExplicitAllocator>);
+    measure<SegregatedListAllocator>("segregated alloc + memset", allocAndClear<SegregatedListAllocator>);
+    measure<SegregatedListAllocator>("segregated calloc", callocArray<SegregatedListAllocator>);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <string>
+#include "std_allocator.h"
+#include "bump_allocator.h"
+#include "explicit_allocator.h"
+#include "segregated_allocator.h"
+
+//STL workloads through HeapAllocator, against std::allocator (glibc malloc)
+//every run gets a fresh heap, so the bump allocator never runs out of its reservation
+const int ROUNDS = 20;
+const int VECTOR_ELEMENTS = 1 << 20;
+const int MAP_KEYS = 1 << 16;
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+//push_back growth: a few large blocks, each one copied into the next
+struct VectorWorkload {
+    using value_type = int;
+
+    template<class Alloc>
+    static size_t run(const Alloc& allocator) {
+        std::vector<int, Alloc> numbers(allocator);
+        for(int i = 0; i < VECTOR_ELEMENTS; i++) numbers.push_back(i);
+        return numbers.size();
+    }
+};
+
+//node churn: one small block per key, half of them freed and inserted again
+struct MapWorkload {
+    using value_type = std::pair<const int, int>;
+
+    template<class Alloc>
+    static size_t run(const Alloc& allocator) {
+        std::map<int, int, std::less<int>, Alloc> squares(allocator);
+        for(int i = 0; i < MAP_KEYS; i++) squares[i] = i;
+        for(int i = 0; i < MAP_KEYS; i += 2) squares.erase(i);
+        for(int i = 0; i < MAP_KEYS; i += 2) squares[i] = i;
+        return squares.size();
+    }
+};
+
+//nodes plus a bucket array that is reallocated on every rehash
+struct UnorderedMapWorkload {
+    using value_type = std::pair<const int, int>;
+
+    template<class Alloc>
+    static size_t run(const Alloc& allocator) {
+        std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, Alloc> squares(0, std::hash<int>(), std::equal_to<int>(), allocator);
+        for(int i = 0; i < MAP_KEYS; i++) squares[i] = i;
+        for(int i = 0; i < MAP_KEYS; i += 2) squares.erase(i);
+        for(int i = 0; i < MAP_KEYS; i += 2) squares[i] = i;
+        return squares.size();
+    }
+};
+
+//ms per round on a fresh heap
+template<class Workload, class Heap>
+double timeOnHeap(size_t& check) {
+    using T = typename Workload::value_type;
+
+    Heap heap;
+    auto start = std::chrono::steady_clock::now();
+    check += Workload::run(HeapAllocator<T, Heap>(heap));
+    return msSince(start);
+}
+
+template<class Workload>
+void benchmark(const std::string& name) {
+    using T = typename Workload::value_type;
+
+    double ms[4] = {};
+    size_t check = 0;
+
+    for(int round = 0; round < ROUNDS; round++) {
+        auto start = std::chrono::steady_clock::now();
+        check += Workload::run(std::allocator<T>());
+        ms[0] += msSince(start);
+
+        ms[1] += timeOnHeap<Workload, BumpAllocator>(check);
+        ms[2] += timeOnHeap<Workload, ExplicitAllocator>(check);
+        ms[3] += timeOnHeap<Workload, SegregatedListAllocator>(check);
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << std::setw(16) << name;
+    for(double total : ms) std::cout << std::setw(14) << total / ROUNDS;
+    std::cout << (check ? "" : " (empty)") << "\n";
+}
+
+int main() {
+    std::cout << "Container Benchmark: " << ROUNDS << " rounds, ms per round\n";
+    std::cout << "vector: " << VECTOR_ELEMENTS << " push_backs, maps: " << MAP_KEYS
+              << " inserts, half erased and inserted again\n\n";
+    std::cout << std::setw(16) << "workload" << std::setw(14) << "std" << std::setw(14) << "bump"
+              << std::setw(14) << "explicit" << std::setw(14) << "segregated" << "\n";
+
+    benchmark<VectorWorkload>("vector");
+    benchmark<MapWorkload>("map");
+    benchmark<UnorderedMapWorkload>("unordered_map");
+
+    return 0;
+}
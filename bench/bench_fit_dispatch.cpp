@@ -0,0 +1,87 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "explicit_allocator.h"
+
+//cost of choosing the fit: the searches are short (the free list is a few blocks long),
+//so the call into the fit is a large share of each one
+//"member pointer" is the dispatch findBlock used before fit policies, "searchMode" the
+//switch findBlock uses now, "policy" the fit fixed at compile time
+const int SEARCHES = 50000000;
+const int ALLOCS = 20000000;
+const int FREE_BLOCKS = 4;
+
+using FitFunction = Block* (ExplicitAllocator::*)(size_t);
+
+volatile size_t sink; //keeps the search results alive
+
+double nsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+//FREE_BLOCKS free blocks of growing size between used guards
+void fragment(ExplicitAllocator& heap) {
+    std::vector<word_t*> holes;
+    for(int i = 0; i < FREE_BLOCKS; i++) {
+        holes.push_back(heap.alloc(64 + i * 64));
+        heap.alloc(32);
+    }
+    for(word_t* hole : holes) heap.free(hole);
+}
+
+//`size` changes every call, so the searches cannot be hoisted out of the loop
+template<class Search>
+double timeSearches(Search search) {
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < SEARCHES; i++) {
+        found += (uintptr_t)search(64 + (i & 3) * 64);
+    }
+    double ns = nsSince(start);
+    sink = found;
+    return ns / SEARCHES;
+}
+
+template<class Alloc>
+double timeAllocs(ExplicitAllocator& heap, Alloc alloc) {
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < ALLOCS; i++) {
+        word_t* data = alloc(64 + (i & 3) * 64);
+        heap.free(data);
+    }
+    return nsSince(start) / ALLOCS;
+}
+
+int main() {
+    ExplicitAllocator heap;
+    fragment(heap);
+
+    //kept in a volatile so the compiler cannot see which fit it names, as with searchMode
+    volatile FitFunction fit = &ExplicitAllocator::firstFit;
+
+    std::cout << "Fit Dispatch Benchmark: first fit over " << FREE_BLOCKS << " free blocks, ns per op\n\n";
+    std::cout << std::setw(16) << "" << std::setw(16) << "member pointer" << std::setw(14) << "searchMode"
+              << std::setw(14) << "policy" << "\n";
+
+    double pointerSearch = timeSearches([&](size_t size) { FitFunction f = fit; return (heap.*f)(size); });
+    double modeSearch = timeSearches([&](size_t size) { return heap.findBlock(size); });
+    double policySearch = timeSearches([&](size_t size) { return heap.findBlock<FirstFit>(size); });
+
+    double pointerAlloc = timeAllocs(heap, [&](size_t size) {
+        size = heap.requestSize(size);
+        FitFunction f = fit;
+        Block* block = (heap.*f)(size);
+        return block ? heap.takeFreeBlock(block, size) : heap.allocFromOS(size);
+    });
+    double modeAlloc = timeAllocs(heap, [&](size_t size) { return heap.alloc(size); });
+    double policyAlloc = timeAllocs(heap, [&](size_t size) { return heap.alloc<FirstFit>(size); });
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(16) << "findBlock" << std::setw(16) << pointerSearch << std::setw(14) << modeSearch
+              << std::setw(14) << policySearch << "\n"
+              << std::setw(16) << "alloc + free" << std::setw(16) << pointerAlloc << std::setw(14) << modeAlloc
+              << std::setw(14) << policyAlloc << "\n";
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "explicit_allocator.h"
+
+//long-running churn: a window of live blocks of random size, one replaced per op
+const int OPS = 200000;
+const int WINDOW = 2000;
+
+struct HeapReport {
+    size_t heapBytes = 0;
+    size_t liveBytes = 0;
+    size_t freeBytes = 0;
+    size_t freeBlocks = 0;
+    size_t largestFree = 0;
+    double seconds = 0;
+};
+
+//walks the physical heap from heapStart to top
+HeapReport inspect(ExplicitAllocator& allocator) {
+    HeapReport report;
+    Block* block = allocator.heapStart;
+
+    while(block) {
+        size_t blockBytes = allocSize(block->size());
+        report.heapBytes += blockBytes;
+
+        if(block->isUsed()) {
+            report.liveBytes += block->size();
+        } else {
+            report.freeBytes += block->size();
+            report.freeBlocks++;
+            if(block->size() > report.largestFree) report.largestFree = block->size();
+        }
+
+        block = allocator.getPhysicalNextBlock(block);
+    }
+
+    return report;
+}
+
+HeapReport run(ExplicitAllocator::CoalesceMode mode) {
+    ExplicitAllocator allocator;
+    allocator.coalesceMode = mode;
+
+    std::vector<word_t*> live(WINDOW, nullptr);
+    unsigned seed = 42;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < OPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        int slot = (seed >> 8) % WINDOW;
+        //mostly small objects with the occasional large buffer
+        size_t size = ((seed >> 20) % 16 == 0) ? 1024 + (seed >> 4) % 4096 : 16 + (seed >> 12) % 240;
+
+        if(live[slot]) allocator.free(live[slot]);
+        live[slot] = allocator.alloc(size);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    HeapReport report = inspect(allocator);
+    report.seconds = std::chrono::duration<double>(end - start).count();
+    return report;
+}
+
+void print(const char* name, const HeapReport& report) {
+    double fragmentation = report.freeBytes ? 1.0 - (double)report.largestFree / report.freeBytes : 0.0;
+
+    std::cout << std::setw(16) << name
+              << std::setw(12) << report.heapBytes / 1024 << " KB"
+              << std::setw(12) << report.liveBytes / 1024 << " KB"
+              << std::setw(12) << report.freeBytes / 1024 << " KB"
+              << std::setw(12) << report.freeBlocks
+              << std::setw(12) << std::fixed << std::setprecision(3) << fragmentation
+              << std::setw(10) << std::setprecision(2) << report.seconds << " s\n";
+}
+
+int main() {
+    std::cout << "Fragmentation Benchmark (" << OPS << " ops, " << WINDOW << " live blocks)\n";
+    std::cout << "=====================================================\n";
+    std::cout << std::setw(16) << "coalescing"
+              << std::setw(15) << "heap"
+              << std::setw(15) << "live"
+              << std::setw(15) << "free"
+              << std::setw(12) << "free blocks"
+              << std::setw(12) << "frag"
+              << std::setw(12) << "time" << "\n";
+
+    print("forward-only", run(ExplicitAllocator::CoalesceMode::Forward));
+    print("bidirectional", run(ExplicitAllocator::CoalesceMode::Bidirectional));
+
+    std::cout << "\nfrag = 1 - largest free block / free bytes\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "implicit_allocator.h"
+#include "explicit_allocator.h"
+
+//best-fit alloc latency as the number of free blocks grows: the heap is filled with
+//free blocks of random size separated by used guards, then each measured op
+//allocates a random size and frees it again, so the free count stays put
+//the implicit heap walk also makes building the heap quadratic, so it stops at WALK_LIMIT
+const size_t WALK_LIMIT = 10000;
+
+unsigned seed = 42;
+
+size_t randomSize() {
+    seed = seed * 1103515245 + 12345;
+    return 48 + ((seed >> 16) % 32) * 8; //48..296 bytes
+}
+
+template<typename Allocator>
+double measure(size_t freeBlocks, bool indexed) {
+    Allocator allocator;
+    allocator.indexFreeBlocks = indexed;
+    allocator.searchMode = Allocator::SearchMode::BestFit;
+
+    std::vector<word_t*> holes;
+    holes.reserve(freeBlocks);
+    for(size_t i = 0; i < freeBlocks; i++) {
+        holes.push_back(allocator.alloc(randomSize()));
+        allocator.alloc(48); //guard, keeps the holes from merging
+    }
+    for(word_t* hole : holes) allocator.free(hole);
+
+    int ops = freeBlocks >= 100000 ? 100 : 2000;
+    auto start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < ops; i++) {
+        word_t* data = allocator.alloc(randomSize());
+        allocator.free(data);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+int main() {
+    std::cout << "Best-fit alloc + free latency (ns/op) by number of free blocks\n\n";
+    std::cout << std::setw(10) << "free" << std::setw(16) << "explicit list" << std::setw(16) << "explicit tree"
+              << std::setw(16) << "implicit walk" << std::setw(16) << "implicit tree" << "\n";
+
+    for(size_t freeBlocks = 10; freeBlocks <= 1000000; freeBlocks *= 10) {
+        std::cout << std::setw(10) << freeBlocks << std::fixed << std::setprecision(0)
+                  << std::setw(16) << measure<ExplicitAllocator>(freeBlocks, false)
+                  << std::setw(16) << measure<ExplicitAllocator>(freeBlocks, true)
+                  << std::setw(16);
+        if(freeBlocks <= WALK_LIMIT) std::cout << measure<ImplicitAllocator>(freeBlocks, false);
+        else std::cout << "-";
+        std::cout << std::setw(16) << measure<ImplicitAllocator>(freeBlocks, true) << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
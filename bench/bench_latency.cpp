@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "implicit_allocator.h"
+#include "explicit_allocator.h"
+#include "segregated_allocator.h"
+#include "tlsf_allocator.h"
+
+//per-operation latency under a fragmented heap: a window of live blocks of random
+//size where every op frees one slot and allocates a new block into it
+const int OPS = 50000;
+const int WINDOW = 4000;
+
+struct LatencyReport {
+    std::vector<long long> allocNs;
+    std::vector<long long> freeNs;
+};
+
+template<typename Allocator>
+LatencyReport run(Allocator& allocator) {
+    using clock = std::chrono::steady_clock;
+    LatencyReport report;
+    report.allocNs.reserve(OPS);
+    report.freeNs.reserve(OPS);
+
+    std::vector<word_t*> live(WINDOW, nullptr);
+    unsigned seed = 42;
+
+    auto nextSize = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        //mostly small, some medium, a few large
+        unsigned r = (seed >> 16) % 100;
+        if(r < 70) return size_t(16 + (seed >> 8) % 112);
+        if(r < 95) return size_t(128 + (seed >> 8) % 896);
+        return size_t(1024 + (seed >> 8) % 7168);
+    };
+
+    for(int i = 0; i < WINDOW; i++) live[i] = allocator.alloc(nextSize());
+
+    for(int i = 0; i < OPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        int slot = (seed >> 8) % WINDOW;
+        size_t size = nextSize();
+
+        auto t0 = clock::now();
+        allocator.free(live[slot]);
+        auto t1 = clock::now();
+        live[slot] = allocator.alloc(size);
+        auto t2 = clock::now();
+
+        report.freeNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        report.allocNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    }
+
+    for(int i = 0; i < WINDOW; i++) allocator.free(live[i]);
+
+    return report;
+}
+
+void printRow(const char* name, const char* op, std::vector<long long>& samples) {
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&samples](double p) { return samples[(size_t)(p * (samples.size() - 1))]; };
+
+    std::cout << std::left << std::setw(12) << name << std::setw(7) << op << std::right
+              << std::setw(10) << pct(0.50)
+              << std::setw(10) << pct(0.99)
+              << std::setw(10) << pct(0.999)
+              << std::setw(12) << samples.back() << "\n";
+}
+
+template<typename Allocator>
+void measure(const char* name, Allocator& allocator) {
+    LatencyReport report = run(allocator);
+    printRow(name, "alloc", report.allocNs);
+    printRow(name, "free", report.freeNs);
+}
+
+int main() {
+    std::cout << "Latency per op in ns, " << OPS << " ops over " << WINDOW << " live blocks\n\n";
+    std::cout << std::left << std::setw(12) << "allocator" << std::setw(7) << "op" << std::right
+              << std::setw(10) << "p50"
+              << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9"
+              << std::setw(12) << "max" << "\n";
+
+    ImplicitAllocator implicitAllocator;
+    measure("implicit", implicitAllocator);
+
+    ExplicitAllocator explicitAllocator;
+    measure("explicit", explicitAllocator);
+
+    SegregatedListAllocator segregatedAllocator;
+    measure("segregated", segregatedAllocator);
+
+    TlsfAllocator tlsfAllocator;
+    measure("tlsf", tlsfAllocator);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <new>
+#include <cstdint>
+#include "pool.h"
+#include "segregated_allocator.h"
+
+//order-book style churn of one fixed-size type: a book of LIVE orders where each step
+//cancels a pseudo-random order and places a new one in its slot
+const int LIVE = 10000;
+const int STEPS = 10000000;
+
+struct Order {
+    uint64_t id;
+    uint64_t price;
+    uint32_t quantity;
+    uint32_t side;
+    Order* next;
+    Order* prev;
+
+    Order(uint64_t id, uint64_t price, uint32_t quantity)
+        : id(id), price(price), quantity(quantity), side(0), next(nullptr), prev(nullptr) {}
+};
+
+double nsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+//the same victim sequence for every allocator
+template<class Create, class Destroy>
+double churn(Create create, Destroy destroy) {
+    std::vector<Order*> book(LIVE);
+    for(int i = 0; i < LIVE; i++) book[i] = create(i);
+
+    uint32_t state = 12345;
+    auto start = std::chrono::steady_clock::now();
+    for(int step = 0; step < STEPS; step++) {
+        state = state * 1664525 + 1013904223;
+        int victim = state % LIVE;
+        destroy(book[victim]);
+        book[victim] = create(step);
+    }
+    double ns = nsSince(start);
+
+    for(Order* order : book) destroy(order);
+    return ns;
+}
+
+int main() {
+    std::cout << "Pool Benchmark: " << STEPS << " cancel/place steps over " << LIVE
+              << " live " << sizeof(Order) << "-byte orders, ns per step\n\n";
+
+    double newDeleteNs = churn(
+        [](int i) { return new Order(i, i, 1); },
+        [](Order* order) { delete order; });
+
+    SegregatedListAllocator heap;
+    double segregatedNs = churn(
+        [&](int i) { return new (heap.alloc(sizeof(Order))) Order(i, i, 1); },
+        [&](Order* order) { order->~Order(); heap.free(reinterpret_cast<word_t*>(order)); });
+
+    SegregatedListAllocator sizedHeap;
+    double sizedNs = churn(
+        [&](int i) { return new (sizedHeap.alloc(sizeof(Order))) Order(i, i, 1); },
+        [&](Order* order) { order->~Order(); sizedHeap.free(reinterpret_cast<word_t*>(order), sizeof(Order)); });
+
+    Pool<Order> pool;
+    double poolNs = churn(
+        [&](int i) { return pool.create(i, i, 1); },
+        [&](Order* order) { pool.destroy(order); });
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(28) << "new/delete" << std::setw(10) << newDeleteNs / STEPS << "\n"
+              << std::setw(28) << "SegregatedList" << std::setw(10) << segregatedNs / STEPS << "\n"
+              << std::setw(28) << "SegregatedList sized free" << std::setw(10) << sizedNs / STEPS << "\n"
+              << std::setw(28) << "Pool<Order>" << std::setw(10) << poolNs / STEPS << "\n";
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "bump_allocator.h"
+#include "segregated_allocator.h"
+#include "region_allocator.h"
+
+//request-scoped workload: each request allocates OBJECTS small objects of mixed sizes,
+//touches them and drops all of them when it ends
+const int REQUESTS = 2000;
+const int OBJECTS = 1000;
+
+double nsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t objectSize(int i) {
+    return 16 + (i % 7) * 24;
+}
+
+//objects freed one by one at the end of the request
+template<class Heap>
+double perObject(Heap& heap) {
+    std::vector<word_t*> objects(OBJECTS);
+
+    auto start = std::chrono::steady_clock::now();
+    for(int request = 0; request < REQUESTS; request++) {
+        for(int i = 0; i < OBJECTS; i++) {
+            objects[i] = heap.alloc(objectSize(i));
+            objects[i][0] = i;
+        }
+        for(int i = 0; i < OBJECTS; i++) heap.free(objects[i]);
+    }
+    return nsSince(start);
+}
+
+double region() {
+    RegionAllocator region;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int request = 0; request < REQUESTS; request++) {
+        for(int i = 0; i < OBJECTS; i++) {
+            word_t* data = region.alloc(objectSize(i));
+            data[0] = i;
+        }
+        region.reset();
+    }
+    return nsSince(start);
+}
+
+int main() {
+    const double objects = double(REQUESTS) * OBJECTS;
+
+    std::cout << "Region Benchmark: " << REQUESTS << " requests of " << OBJECTS
+              << " objects (16..160 bytes), ns per object\n\n";
+
+    //the bump allocator never reuses memory, give it room for every request
+    MmapChunkProvider bumpHeap(size_t(4) << 30);
+    BumpAllocator bump(&bumpHeap);
+    SegregatedListAllocator segregated;
+
+    double bumpNs = perObject(bump);
+    double segregatedNs = perObject(segregated);
+    double regionNs = region();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(28) << "BumpAllocator + free" << std::setw(10) << bumpNs / objects << "\n"
+              << std::setw(28) << "SegregatedList + free" << std::setw(10) << segregatedNs / objects << "\n"
+              << std::setw(28) << "RegionAllocator + reset" << std::setw(10) << regionNs / objects << "\n";
+
+    return 0;
+}
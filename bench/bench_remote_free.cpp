@@ -0,0 +1,84 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "arena_allocator.h"
+
+//pipeline: each producer allocates messages, its consumer frees them on another thread
+const int MESSAGES_PER_PAIR = 500000;
+const size_t RING_SIZE = 1024;
+
+//single-producer single-consumer handoff, cheap enough not to hide the allocator
+struct Ring {
+    word_t* slots[RING_SIZE];
+    alignas(64) std::atomic<size_t> head{0}; //next slot to read
+    alignas(64) std::atomic<size_t> tail{0}; //next slot to write
+
+    void push(word_t* msg) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        while(t - head.load(std::memory_order_acquire) == RING_SIZE) std::this_thread::yield();
+        slots[t % RING_SIZE] = msg;
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    word_t* pop() {
+        size_t h = head.load(std::memory_order_relaxed);
+        while(tail.load(std::memory_order_acquire) == h) std::this_thread::yield();
+        word_t* msg = slots[h % RING_SIZE];
+        head.store(h + 1, std::memory_order_release);
+        return msg;
+    }
+};
+
+double run(int numPairs, bool deferRemoteFrees) {
+    //round robin puts every thread on an arena of its own
+    ArenaAllocator allocator(2 * numPairs, ArenaAllocator::Selection::RoundRobin);
+    allocator.deferRemoteFrees = deferRemoteFrees;
+    std::vector<Ring> rings(numPairs);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int p = 0; p < numPairs; p++) {
+        Ring& ring = rings[p];
+        threads.emplace_back([&allocator, &ring]() {
+            for(int i = 0; i < MESSAGES_PER_PAIR; i++) {
+                word_t* msg = allocator.alloc(16 + (i % 8) * 16); //16..128 bytes
+                *msg = i;
+                ring.push(msg);
+            }
+        });
+        threads.emplace_back([&allocator, &ring]() {
+            for(int i = 0; i < MESSAGES_PER_PAIR; i++) {
+                allocator.free(ring.pop());
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return (double)MESSAGES_PER_PAIR * numPairs / seconds / 1e6;
+}
+
+int main() {
+    std::cout << "Remote Free Benchmark (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+    std::cout << "=========================================\n";
+    std::cout << std::setw(8) << "pairs"
+              << std::setw(18) << "owner's lock"
+              << std::setw(18) << "remote list"
+              << std::setw(12) << "speedup" << "\n";
+
+    for(int numPairs : {1, 2, 4, 8}) {
+        double locked = run(numPairs, false);
+        double remote = run(numPairs, true);
+
+        std::cout << std::setw(8) << numPairs
+                  << std::setw(12) << std::fixed << std::setprecision(2) << locked << " Mmsg/s"
+                  << std::setw(12) << remote << " Mmsg/s"
+                  << std::setw(11) << remote / locked << "x\n";
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,569 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "implicit_allocator.h"
+#include "explicit_allocator.h"
+#include "segregated_allocator.h"
+#include "tlsf_allocator.h"
+#include "thread_cache.h"
+#include "arena_allocator.h"
+
+//standard allocator workloads against every general-purpose allocator class and the
+//system malloc, results as JSON on stdout (progress on stderr):
+//  larson         windows of random-size blocks handed to a different thread every round,
+//                 so most blocks are freed by another thread than the one that allocated them
+//  threadtest     every thread allocates a batch of small objects and frees it, over and over
+//  cache-scratch  each thread frees a neighbouring object handed to it, then allocs, writes
+//                 and frees in a loop; a heap that gives that slot back to it shares the line
+//  xmalloc        producer threads allocate messages, consumer threads free them
+//  churn          one thread replaces random slots of a window of mixed-size blocks
+//  realloc        one thread grows many buffers in small steps
+//every run is a fresh process, so its resident set is its own; the bump allocator is
+//left out (it never reuses memory), the region and pool are not general-purpose heaps
+//
+//  ops_per_sec     allocator calls (alloc, free, realloc) per second
+//  rss_bytes       resident growth once the workload freed everything, what the heap keeps
+//  peak_rss_bytes  highest resident growth during the run
+//  fragmentation   peak_rss_bytes / peak live requested bytes, 1.0 means no overhead
+//                  (thread stacks count too, so it only means much when live bytes are large)
+
+struct Config {
+    int threads = 4;
+    double scale = 1.0;
+    std::string workload;  //run only this workload if set
+    std::string allocator; //run only this allocator if set
+
+    int scaled(int count) const { return std::max(1, (int)(count * this->scale)); }
+};
+
+//--- resident set ---------------------------------------------------------------------
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+size_t peakResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line)) {
+        if(line.compare(0, 6, "VmHWM:") == 0) return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+    return 0;
+}
+
+//peak resident set back to the current one, so the child does not report its parent's
+void resetPeakResident() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+//--- live bytes and call counts -------------------------------------------------------
+
+struct RunState {
+    std::atomic<uint64_t> ops{0};
+    std::atomic<int64_t> live{0};
+    std::atomic<int64_t> peakLive{0};
+};
+
+//one thread's share of RunState, published every FLUSH_OPS calls so counting stays off
+//the hot path; the peak is sampled at those points rather than exact
+struct Tally {
+    static const int FLUSH_OPS = 64;
+
+    RunState& run;
+    int64_t pending = 0;
+    uint64_t ops = 0;
+
+    explicit Tally(RunState& run) : run(run) {}
+    ~Tally() {
+        this->publish();
+        this->run.ops.fetch_add(this->ops, std::memory_order_relaxed);
+    }
+
+    void count(int64_t bytes) {
+        this->pending += bytes;
+        if(++this->ops % FLUSH_OPS == 0) this->publish();
+    }
+
+    void publish() {
+        int64_t now = this->run.live.fetch_add(this->pending, std::memory_order_relaxed) + this->pending;
+        this->pending = 0;
+
+        int64_t seen = this->run.peakLive.load(std::memory_order_relaxed);
+        while(now > seen && !this->run.peakLive.compare_exchange_weak(seen, now, std::memory_order_relaxed)) {}
+    }
+};
+
+//--- allocators -----------------------------------------------------------------------
+
+//alloc + copy + free for heaps without a realloc of their own
+template<class Heap>
+auto reallocIn(Heap& heap, word_t* data, size_t, size_t size, int) -> decltype(heap.realloc(data, size)) {
+    return heap.realloc(data, size);
+}
+
+template<class Heap>
+word_t* reallocIn(Heap& heap, word_t* data, size_t oldSize, size_t size, long) {
+    word_t* moved = heap.alloc(size);
+    if(moved) {
+        std::memcpy(moved, data, std::min(oldSize, size));
+        heap.free(data, oldSize);
+    }
+    return moved;
+}
+
+struct SystemMalloc {
+    explicit SystemMalloc(bool) {}
+
+    void* alloc(size_t size) { return std::malloc(size); }
+    void free(void* data, size_t) { std::free(data); }
+    void* realloc(void* data, size_t, size_t size) { return std::realloc(data, size); }
+};
+
+//a single-threaded heap behind one lock, the lock is skipped for single-threaded workloads
+template<class Heap>
+struct Locked {
+    Heap heap;
+    std::mutex lock;
+    bool concurrent;
+
+    explicit Locked(bool concurrent) : concurrent(concurrent) {}
+
+    void* alloc(size_t size) {
+        std::unique_lock<std::mutex> guard(this->lock, std::defer_lock);
+        if(this->concurrent) guard.lock();
+        return this->heap.alloc(size);
+    }
+
+    void free(void* data, size_t size) {
+        std::unique_lock<std::mutex> guard(this->lock, std::defer_lock);
+        if(this->concurrent) guard.lock();
+        this->heap.free(static_cast<word_t*>(data), size);
+    }
+
+    void* realloc(void* data, size_t oldSize, size_t size) {
+        std::unique_lock<std::mutex> guard(this->lock, std::defer_lock);
+        if(this->concurrent) guard.lock();
+        return reallocIn(this->heap, static_cast<word_t*>(data), oldSize, size, 0);
+    }
+};
+
+//a heap that does its own locking
+template<class Heap>
+struct ThreadSafe {
+    Heap heap;
+
+    explicit ThreadSafe(bool) {}
+
+    void* alloc(size_t size) { return this->heap.alloc(size); }
+    void free(void* data, size_t size) { this->heap.free(static_cast<word_t*>(data), size); }
+    void* realloc(void* data, size_t oldSize, size_t size) {
+        return reallocIn(this->heap, static_cast<word_t*>(data), oldSize, size, 0);
+    }
+};
+
+//--- workloads ------------------------------------------------------------------------
+
+struct Slot {
+    void* data = nullptr;
+    size_t size = 0;
+};
+
+unsigned nextRandom(unsigned& seed) {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+//one write per page, so the resident set follows what the heap hands out
+void touch(void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    for(size_t offset = 0; offset < size; offset += 4096) bytes[offset] = 1;
+    bytes[size - 1] = 1;
+}
+
+template<class Heap>
+void allocSlot(Heap& heap, Tally& tally, Slot& slot, size_t size) {
+    slot.data = heap.alloc(size);
+    slot.size = size;
+    touch(slot.data, size);
+    tally.count(size);
+}
+
+template<class Heap>
+void freeSlot(Heap& heap, Tally& tally, Slot& slot) {
+    heap.free(slot.data, slot.size);
+    tally.count(-(int64_t)slot.size);
+    slot.data = nullptr;
+}
+
+template<class Heap>
+void larson(Heap& heap, RunState& run, const Config& config) {
+    const int SLOTS = 1000;
+    const int ROUNDS = 8;
+    const int replacements = config.scaled(10000);
+
+    std::vector<std::vector<Slot>> windows(config.threads, std::vector<Slot>(SLOTS));
+    {
+        Tally tally(run);
+        unsigned seed = 1;
+        for(auto& window : windows) {
+            for(Slot& slot : window) allocSlot(heap, tally, slot, 16 + nextRandom(seed) % 497);
+        }
+    }
+
+    for(int round = 0; round < ROUNDS; round++) {
+        std::vector<std::thread> threads;
+        for(int t = 0; t < config.threads; t++) {
+            //thread t takes over the window another thread filled last round
+            std::vector<Slot>& window = windows[(t + round) % config.threads];
+            threads.emplace_back([&heap, &run, &window, replacements, seed = 100u * round + t]() mutable {
+                Tally tally(run);
+                for(int i = 0; i < replacements; i++) {
+                    Slot& slot = window[nextRandom(seed) % SLOTS];
+                    freeSlot(heap, tally, slot);
+                    allocSlot(heap, tally, slot, 16 + nextRandom(seed) % 497);
+                }
+            });
+        }
+        for(auto& thread : threads) thread.join();
+    }
+
+    Tally tally(run);
+    for(auto& window : windows) {
+        for(Slot& slot : window) freeSlot(heap, tally, slot);
+    }
+}
+
+template<class Heap>
+void threadtest(Heap& heap, RunState& run, const Config& config) {
+    const int BATCH = 1000;
+    const size_t SIZE = 64;
+    const int iterations = config.scaled(100);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < config.threads; t++) {
+        threads.emplace_back([&heap, &run, iterations]() {
+            Tally tally(run);
+            std::vector<Slot> batch(BATCH);
+            for(int i = 0; i < iterations; i++) {
+                for(Slot& slot : batch) allocSlot(heap, tally, slot, SIZE);
+                for(Slot& slot : batch) freeSlot(heap, tally, slot);
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+}
+
+template<class Heap>
+void cacheScratch(Heap& heap, RunState& run, const Config& config) {
+    const size_t SIZE = 8;
+    const int WRITES = 100;
+    const int iterations = config.scaled(50000);
+
+    //allocated back to back by one thread, so neighbours likely share a cache line
+    std::vector<Slot> handed(config.threads);
+    {
+        Tally tally(run);
+        for(Slot& slot : handed) allocSlot(heap, tally, slot, SIZE);
+    }
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < config.threads; t++) {
+        threads.emplace_back([&heap, &run, &slot = handed[t], iterations]() {
+            Tally tally(run);
+            freeSlot(heap, tally, slot);
+            for(int i = 0; i < iterations; i++) {
+                Slot own;
+                allocSlot(heap, tally, own, SIZE);
+                volatile char* bytes = static_cast<char*>(own.data);
+                for(int w = 0; w < WRITES; w++) bytes[w % SIZE]++;
+                freeSlot(heap, tally, own);
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+}
+
+//single-producer single-consumer handoff, cheap enough not to hide the allocator
+struct Ring {
+    static const size_t RING_SIZE = 1024;
+
+    Slot slots[RING_SIZE];
+    alignas(64) std::atomic<size_t> head{0}; //next slot to read
+    alignas(64) std::atomic<size_t> tail{0}; //next slot to write
+
+    void push(Slot msg) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        while(t - head.load(std::memory_order_acquire) == RING_SIZE) std::this_thread::yield();
+        slots[t % RING_SIZE] = msg;
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    Slot pop() {
+        size_t h = head.load(std::memory_order_relaxed);
+        while(tail.load(std::memory_order_acquire) == h) std::this_thread::yield();
+        Slot msg = slots[h % RING_SIZE];
+        head.store(h + 1, std::memory_order_release);
+        return msg;
+    }
+};
+
+template<class Heap>
+void xmalloc(Heap& heap, RunState& run, const Config& config) {
+    const int pairs = std::max(1, config.threads / 2);
+    const int messages = config.scaled(100000);
+
+    std::vector<Ring> rings(pairs);
+    std::vector<std::thread> threads;
+    for(int p = 0; p < pairs; p++) {
+        Ring& ring = rings[p];
+        threads.emplace_back([&heap, &run, &ring, messages, seed = 7u + p]() mutable {
+            Tally tally(run);
+            for(int i = 0; i < messages; i++) {
+                Slot msg;
+                allocSlot(heap, tally, msg, 16 + nextRandom(seed) % 241);
+                ring.push(msg);
+            }
+        });
+        threads.emplace_back([&heap, &run, &ring, messages]() {
+            Tally tally(run);
+            for(int i = 0; i < messages; i++) {
+                Slot msg = ring.pop();
+                freeSlot(heap, tally, msg);
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+}
+
+template<class Heap>
+void churn(Heap& heap, RunState& run, const Config& config) {
+    const int WINDOW = 2000;
+    const int replacements = config.scaled(200000);
+
+    Tally tally(run);
+    std::vector<Slot> window(WINDOW);
+    unsigned seed = 42;
+
+    auto nextSize = [&seed]() {
+        unsigned r = nextRandom(seed) % 100;
+        //mostly small, some medium, a few large buffers
+        if(r < 80) return size_t(16 + nextRandom(seed) % 241);
+        if(r < 95) return size_t(256 + nextRandom(seed) % 3841);
+        return size_t(4096 + nextRandom(seed) % 61441);
+    };
+
+    for(Slot& slot : window) allocSlot(heap, tally, slot, nextSize());
+    for(int i = 0; i < replacements; i++) {
+        Slot& slot = window[nextRandom(seed) % WINDOW];
+        freeSlot(heap, tally, slot);
+        allocSlot(heap, tally, slot, nextSize());
+    }
+    for(Slot& slot : window) freeSlot(heap, tally, slot);
+}
+
+template<class Heap>
+void reallocGrowth(Heap& heap, RunState& run, const Config& config) {
+    const int BUFFERS = 1000;
+    const size_t START = 16;
+    const size_t LIMIT = 16 * 1024; //a buffer this big is dropped and started over
+    const int steps = config.scaled(200000);
+
+    Tally tally(run);
+    std::vector<Slot> buffers(BUFFERS);
+    unsigned seed = 9;
+
+    for(Slot& buffer : buffers) allocSlot(heap, tally, buffer, START);
+    for(int i = 0; i < steps; i++) {
+        Slot& buffer = buffers[i % BUFFERS];
+        if(buffer.size >= LIMIT) {
+            freeSlot(heap, tally, buffer);
+            allocSlot(heap, tally, buffer, START);
+            continue;
+        }
+
+        size_t size = buffer.size + 16 + nextRandom(seed) % 241;
+        buffer.data = heap.realloc(buffer.data, buffer.size, size);
+        static_cast<char*>(buffer.data)[size - 1] = 1;
+        tally.count(size - buffer.size);
+        buffer.size = size;
+    }
+    for(Slot& buffer : buffers) freeSlot(heap, tally, buffer);
+}
+
+//--- runner ---------------------------------------------------------------------------
+
+struct Workload {
+    const char* name;
+    bool concurrent; //runs config.threads threads, otherwise one
+};
+
+const Workload WORKLOADS[] = {
+    {"larson", true},
+    {"threadtest", true},
+    {"cache-scratch", true},
+    {"xmalloc", true},
+    {"churn", false},
+    {"realloc", false},
+};
+
+//what a child process sends back through its pipe
+struct Result {
+    uint64_t ops;
+    double seconds;
+    size_t rssBytes;
+    size_t peakRssBytes;
+    size_t peakLiveBytes;
+};
+
+template<class Heap>
+Result measure(int workload, const Config& config) {
+    resetPeakResident();
+    size_t baseline = residentBytes();
+
+    RunState run;
+    Heap heap(WORKLOADS[workload].concurrent);
+
+    auto start = std::chrono::steady_clock::now();
+    switch(workload) {
+        case 0: larson(heap, run, config); break;
+        case 1: threadtest(heap, run, config); break;
+        case 2: cacheScratch(heap, run, config); break;
+        case 3: xmalloc(heap, run, config); break;
+        case 4: churn(heap, run, config); break;
+        default: reallocGrowth(heap, run, config); break;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    size_t resident = residentBytes();
+    size_t peak = std::max(peakResidentBytes(), resident);
+
+    Result result;
+    result.ops = run.ops.load();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.rssBytes = resident > baseline ? resident - baseline : 0;
+    result.peakRssBytes = peak > baseline ? peak - baseline : 0;
+    result.peakLiveBytes = run.peakLive.load();
+    return result;
+}
+
+struct Allocator {
+    const char* name;
+    Result (*measure)(int workload, const Config& config);
+};
+
+const Allocator ALLOCATORS[] = {
+    {"malloc", measure<SystemMalloc>},
+    {"implicit", measure<Locked<ImplicitAllocator>>},
+    {"explicit", measure<Locked<ExplicitAllocator>>},
+    {"segregated", measure<Locked<SegregatedListAllocator>>},
+    {"tlsf", measure<Locked<TlsfAllocator>>},
+    {"thread_cache", measure<ThreadSafe<ThreadCachedAllocator>>},
+    {"arena", measure<ThreadSafe<ArenaAllocator>>},
+};
+
+//runs one measurement in a child process, false with `error` set if the child failed
+bool runIsolated(const Allocator& allocator, int workload, const Config& config, Result& result, std::string& error) {
+    int fds[2];
+    if(pipe(fds) != 0) {
+        error = "pipe failed";
+        return false;
+    }
+
+    pid_t pid = fork();
+    if(pid == 0) {
+        close(fds[0]);
+        Result measured = allocator.measure(workload, config);
+        bool sent = write(fds[1], &measured, sizeof(measured)) == (ssize_t)sizeof(measured);
+        _exit(sent ? 0 : 1);
+    }
+
+    close(fds[1]);
+    bool received = pid > 0 && read(fds[0], &result, sizeof(result)) == (ssize_t)sizeof(result);
+    close(fds[0]);
+
+    int status = 0;
+    if(pid > 0) waitpid(pid, &status, 0);
+    if(received) return true;
+
+    if(pid < 0) error = "fork failed";
+    else if(WIFSIGNALED(status)) error = "killed by signal " + std::to_string(WTERMSIG(status));
+    else error = "exit status " + std::to_string(WEXITSTATUS(status));
+    return false;
+}
+
+bool parseArgs(int argc, char** argv, Config& config) {
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if(flag == "--threads") config.threads = std::max(1, std::atoi(argv[i + 1]));
+        else if(flag == "--scale") config.scale = std::atof(argv[i + 1]);
+        else if(flag == "--workload") config.workload = argv[i + 1];
+        else if(flag == "--allocator") config.allocator = argv[i + 1];
+        else return false;
+    }
+    return argc % 2 == 1 && config.scale > 0;
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    if(!parseArgs(argc, argv, config)) {
+        std::cerr << "usage: " << argv[0] << " [--threads N] [--scale X] [--workload NAME] [--allocator NAME]\n";
+        return 1;
+    }
+
+    std::cout << "{\n  \"threads\": " << config.threads << ",\n  \"scale\": " << config.scale << ",\n  \"results\": [";
+    bool first = true;
+
+    for(int w = 0; w < (int)(sizeof(WORKLOADS) / sizeof(WORKLOADS[0])); w++) {
+        const Workload& workload = WORKLOADS[w];
+        if(!config.workload.empty() && config.workload != workload.name) continue;
+
+        for(const Allocator& allocator : ALLOCATORS) {
+            if(!config.allocator.empty() && config.allocator != allocator.name) continue;
+            std::cerr << workload.name << " / " << allocator.name << "\n";
+
+            Result result;
+            std::string error;
+            bool ok = runIsolated(allocator, w, config, result, error);
+
+            std::cout << (first ? "\n" : ",\n") << "    {\"workload\": \"" << workload.name
+                      << "\", \"allocator\": \"" << allocator.name
+                      << "\", \"threads\": " << (workload.concurrent ? config.threads : 1);
+            first = false;
+
+            if(!ok) {
+                std::cout << ", \"error\": \"" << error << "\"}";
+                continue;
+            }
+
+            double fragmentation = result.peakLiveBytes ? (double)result.peakRssBytes / result.peakLiveBytes : 0.0;
+            std::cout << std::fixed
+                      << ", \"ops\": " << result.ops
+                      << ", \"seconds\": " << std::setprecision(6) << result.seconds
+                      << ", \"ops_per_sec\": " << std::setprecision(0) << result.ops / result.seconds
+                      << ", \"rss_bytes\": " << result.rssBytes
+                      << ", \"peak_rss_bytes\": " << result.peakRssBytes
+                      << ", \"peak_live_bytes\": " << result.peakLiveBytes
+                      << ", \"fragmentation\": " << std::setprecision(3) << fragmentation << "}";
+            std::cout.unsetf(std::ios::fixed);
+        }
+    }
+
+    std::cout << "\n  ]\n}\n";
+    return 0;
+}
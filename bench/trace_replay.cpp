@@ -0,0 +1,390 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "alloc_trace.h"
+#include "implicit_allocator.h"
+#include "explicit_allocator.h"
+#include "segregated_allocator.h"
+#include "tlsf_allocator.h"
+#include "thread_cache.h"
+#include "arena_allocator.h"
+
+//replays a trace recorded by libcustomalloc.so (CUSTOMALLOC_TRACE=path) against every
+//allocator class and the system malloc, each in a process of its own
+//the calls run on one thread in the order they were recorded, so every allocator sees
+//the identical sequence; the recording threads only show up in the summary
+//JSON on stdout:
+//  seconds            whole replay, reading the trace included
+//  allocator_seconds  seconds minus a replay that only reads the trace
+//  footprint          live requested bytes and resident growth at evenly spaced points
+
+const int MAX_SAMPLES = 256;
+
+struct Options {
+    const char* path = nullptr;
+    std::string allocator; //replay only this allocator if set
+    int samples = 32;
+};
+
+//what the first pass over the trace found out
+struct Summary {
+    uint64_t events = 0;
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t reallocs = 0;
+    uint64_t aligned = 0;
+    uint32_t threads = 0;
+    uint64_t objects = 0;
+    uint64_t durationNs = 0;
+    bool truncated = false;
+};
+
+//--- resident set ---------------------------------------------------------------------
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+size_t peakResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line)) {
+        if(line.compare(0, 6, "VmHWM:") == 0) return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+    return 0;
+}
+
+//peak resident set back to the current one, so the child does not report its parent's
+void resetPeakResident() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+//--- allocators -----------------------------------------------------------------------
+
+//heaps without allocAligned (or asked for more than they support) get a plain block,
+//the replay only needs the memory
+template<class Heap>
+auto allocAlignedIn(Heap& heap, size_t size, size_t alignment, int) -> decltype(heap.allocAligned(size, alignment)) {
+    word_t* data = heap.allocAligned(size, alignment);
+    return data ? data : heap.alloc(size);
+}
+
+template<class Heap>
+word_t* allocAlignedIn(Heap& heap, size_t size, size_t, long) {
+    return heap.alloc(size);
+}
+
+//alloc + copy + free for heaps without a realloc of their own
+template<class Heap>
+auto reallocIn(Heap& heap, word_t* data, size_t, size_t size, int) -> decltype(heap.realloc(data, size)) {
+    return heap.realloc(data, size);
+}
+
+template<class Heap>
+word_t* reallocIn(Heap& heap, word_t* data, size_t oldSize, size_t size, long) {
+    word_t* moved = heap.alloc(size);
+    if(moved) {
+        std::memcpy(moved, data, std::min(oldSize, size));
+        heap.free(data, oldSize);
+    }
+    return moved;
+}
+
+struct SystemMalloc {
+    word_t* alloc(size_t size) { return static_cast<word_t*>(std::malloc(size)); }
+    word_t* allocAligned(size_t size, size_t alignment) {
+        void* data = nullptr;
+        return posix_memalign(&data, std::max(alignment, sizeof(void*)), size) == 0 ? static_cast<word_t*>(data) : nullptr;
+    }
+    word_t* realloc(word_t* data, size_t size) { return static_cast<word_t*>(std::realloc(data, size)); }
+    void free(word_t* data, size_t) { std::free(data); }
+};
+
+//--- replay ---------------------------------------------------------------------------
+
+struct Slot {
+    word_t* data = nullptr;
+    size_t size = 0;
+};
+
+struct Sample {
+    uint64_t event;
+    uint64_t timeNs;  //trace time of the event
+    int64_t liveBytes;
+    size_t rssBytes;
+};
+
+//what a child process sends back through its pipe
+struct Result {
+    double seconds;
+    size_t peakRssBytes;
+    size_t finalRssBytes;
+    int64_t peakLiveBytes;
+    int sampleCount;
+    Sample samples[MAX_SAMPLES];
+};
+
+//one write per page from `from` on, so the resident set follows what the heap hands out
+void touch(word_t* data, size_t from, size_t size) {
+    char* bytes = reinterpret_cast<char*>(data);
+    for(size_t offset = from; offset < size; offset += 4096) bytes[offset] = 1;
+    bytes[size - 1] = 1;
+}
+
+template<class Heap, class Configure>
+Result replay(TraceReader& trace, const Options& options, const Summary& summary, Configure configure) {
+    using clock = std::chrono::steady_clock;
+
+    resetPeakResident();
+    size_t baseline = residentBytes();
+
+    Heap heap;
+    configure(heap);
+    std::vector<Slot> live(summary.objects);
+    uint64_t interval = std::max<uint64_t>(1, summary.events / options.samples);
+
+    Result result = {};
+    int64_t liveBytes = 0;
+    double seconds = 0;
+    TraceEvent event;
+    uint64_t index = 0;
+
+    trace.rewind();
+    auto start = clock::now();
+    while(trace.next(event)) {
+        Slot& slot = live[event.object];
+        size_t size = event.size ? event.size : 1;
+
+        switch(event.op) {
+            case TraceOp::Alloc:
+                slot.data = event.alignment ? allocAlignedIn(heap, size, event.alignment, 0) : heap.alloc(size);
+                slot.size = size;
+                touch(slot.data, 0, size);
+                liveBytes += size;
+                break;
+            case TraceOp::Free:
+                heap.free(slot.data, slot.size);
+                liveBytes -= slot.size;
+                slot.data = nullptr;
+                break;
+            case TraceOp::Realloc:
+                slot.data = reallocIn(heap, slot.data, slot.size, size, 0);
+                touch(slot.data, std::min(slot.size, size), size);
+                liveBytes += (int64_t)size - (int64_t)slot.size;
+                slot.size = size;
+                break;
+        }
+        result.peakLiveBytes = std::max(result.peakLiveBytes, liveBytes);
+
+        //the clock stops while the resident set is read
+        if(++index % interval == 0 && result.sampleCount < options.samples) {
+            seconds += std::chrono::duration<double>(clock::now() - start).count();
+            size_t resident = residentBytes();
+            result.samples[result.sampleCount++] = {index, event.time, liveBytes, resident > baseline ? resident - baseline : 0};
+            start = clock::now();
+        }
+    }
+    seconds += std::chrono::duration<double>(clock::now() - start).count();
+
+    size_t resident = residentBytes();
+    size_t peak = std::max(peakResidentBytes(), resident);
+    result.seconds = seconds;
+    result.finalRssBytes = resident > baseline ? resident - baseline : 0;
+    result.peakRssBytes = peak > baseline ? peak - baseline : 0;
+    return result;
+}
+
+template<class Heap>
+Result replay(TraceReader& trace, const Options& options, const Summary& summary) {
+    return replay<Heap>(trace, options, summary, [](Heap&) {});
+}
+
+struct Allocator {
+    const char* name;
+    Result (*replay)(TraceReader& trace, const Options& options, const Summary& summary);
+};
+
+const Allocator ALLOCATORS[] = {
+    {"malloc", replay<SystemMalloc>},
+    {"implicit", replay<ImplicitAllocator>},
+    {"explicit-first", replay<ExplicitAllocator>},
+    {"explicit-next", [](TraceReader& trace, const Options& options, const Summary& summary) {
+        return replay<ExplicitAllocator>(trace, options, summary,
+            [](ExplicitAllocator& heap) { heap.searchMode = ExplicitAllocator::SearchMode::NextFit; });
+    }},
+    {"explicit-best", [](TraceReader& trace, const Options& options, const Summary& summary) {
+        return replay<ExplicitAllocator>(trace, options, summary,
+            [](ExplicitAllocator& heap) { heap.searchMode = ExplicitAllocator::SearchMode::BestFit; });
+    }},
+    {"explicit-worst", [](TraceReader& trace, const Options& options, const Summary& summary) {
+        return replay<ExplicitAllocator>(trace, options, summary,
+            [](ExplicitAllocator& heap) { heap.searchMode = ExplicitAllocator::SearchMode::WorstFit; });
+    }},
+    {"segregated", replay<SegregatedListAllocator>},
+    {"tlsf", replay<TlsfAllocator>},
+    {"thread_cache", replay<ThreadCachedAllocator>},
+    {"arena", replay<ArenaAllocator>},
+};
+
+//--- runner ---------------------------------------------------------------------------
+
+Summary summarize(TraceReader& trace, double& decodeSeconds) {
+    Summary summary;
+    TraceEvent event;
+
+    trace.rewind();
+    auto start = std::chrono::steady_clock::now();
+    while(trace.next(event)) {
+        summary.events++;
+        if(event.op == TraceOp::Alloc) summary.allocs++;
+        else if(event.op == TraceOp::Free) summary.frees++;
+        else summary.reallocs++;
+        if(event.alignment) summary.aligned++;
+        summary.threads = std::max(summary.threads, event.thread + 1);
+        summary.durationNs = event.time;
+    }
+    decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    summary.objects = trace.objectCount();
+    summary.truncated = trace.truncated();
+    return summary;
+}
+
+bool readAll(int fd, char* out, size_t size) {
+    while(size > 0) {
+        ssize_t got = read(fd, out, size);
+        if(got <= 0) return false;
+        out += got;
+        size -= got;
+    }
+    return true;
+}
+
+//runs one replay in a child process, false with `error` set if the child failed
+bool runIsolated(const Allocator& allocator, TraceReader& trace, const Options& options, const Summary& summary,
+                 Result& result, std::string& error) {
+    int fds[2];
+    if(pipe(fds) != 0) {
+        error = "pipe failed";
+        return false;
+    }
+
+    pid_t pid = fork();
+    if(pid == 0) {
+        close(fds[0]);
+        Result measured = allocator.replay(trace, options, summary);
+        const char* bytes = reinterpret_cast<const char*>(&measured);
+        size_t left = sizeof(measured);
+        while(left > 0) {
+            ssize_t sent = write(fds[1], bytes, left);
+            if(sent <= 0) _exit(1);
+            bytes += sent;
+            left -= sent;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    bool received = pid > 0 && readAll(fds[0], reinterpret_cast<char*>(&result), sizeof(result));
+    close(fds[0]);
+
+    int status = 0;
+    if(pid > 0) waitpid(pid, &status, 0);
+    if(received) return true;
+
+    if(pid < 0) error = "fork failed";
+    else if(WIFSIGNALED(status)) error = "killed by signal " + std::to_string(WTERMSIG(status));
+    else error = "exit status " + std::to_string(WEXITSTATUS(status));
+    return false;
+}
+
+bool parseArgs(int argc, char** argv, Options& options) {
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--allocator" && i + 1 < argc) options.allocator = argv[++i];
+        else if(arg == "--samples" && i + 1 < argc) options.samples = std::atoi(argv[++i]);
+        else if(arg.compare(0, 2, "--") != 0 && !options.path) options.path = argv[i];
+        else return false;
+    }
+    return options.path && options.samples > 0 && options.samples <= MAX_SAMPLES;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parseArgs(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " TRACE [--allocator NAME] [--samples 1.." << MAX_SAMPLES << "]\n";
+        return 1;
+    }
+
+    TraceReader trace;
+    if(!trace.open(options.path)) {
+        std::cerr << options.path << ": not a readable trace\n";
+        return 1;
+    }
+
+    double decodeSeconds;
+    Summary summary = summarize(trace, decodeSeconds);
+    if(summary.truncated) std::cerr << options.path << ": trace cut short, replaying the records before the cut\n";
+
+    std::cout << std::fixed << "{\n  \"trace\": \"" << options.path << "\""
+              << ",\n  \"bytes\": " << trace.fileSize()
+              << ",\n  \"events\": " << summary.events
+              << ",\n  \"allocs\": " << summary.allocs
+              << ",\n  \"frees\": " << summary.frees
+              << ",\n  \"reallocs\": " << summary.reallocs
+              << ",\n  \"aligned\": " << summary.aligned
+              << ",\n  \"threads\": " << summary.threads
+              << ",\n  \"duration_ns\": " << summary.durationNs
+              << ",\n  \"truncated\": " << (summary.truncated ? "true" : "false")
+              << ",\n  \"decode_seconds\": " << std::setprecision(6) << decodeSeconds
+              << ",\n  \"results\": [";
+    bool first = true;
+
+    for(const Allocator& allocator : ALLOCATORS) {
+        if(!options.allocator.empty() && options.allocator != allocator.name) continue;
+        std::cerr << "replaying on " << allocator.name << "\n";
+
+        Result result;
+        std::string error;
+        bool ok = runIsolated(allocator, trace, options, summary, result, error);
+
+        std::cout << (first ? "\n" : ",\n") << "    {\"allocator\": \"" << allocator.name << "\"";
+        first = false;
+
+        if(!ok) {
+            std::cout << ", \"error\": \"" << error << "\"}";
+            continue;
+        }
+
+        std::cout << std::setprecision(6)
+                  << ", \"seconds\": " << result.seconds
+                  << ", \"allocator_seconds\": " << std::max(0.0, result.seconds - decodeSeconds)
+                  << ", \"ns_per_event\": " << std::setprecision(2) << (summary.events ? result.seconds * 1e9 / summary.events : 0.0)
+                  << ", \"peak_rss_bytes\": " << result.peakRssBytes
+                  << ", \"final_rss_bytes\": " << result.finalRssBytes
+                  << ", \"peak_live_bytes\": " << result.peakLiveBytes
+                  << ",\n     \"footprint\": [";
+        for(int i = 0; i < result.sampleCount; i++) {
+            const Sample& sample = result.samples[i];
+            std::cout << (i ? ", " : "") << "{\"event\": " << sample.event << ", \"time_ns\": " << sample.timeNs
+                      << ", \"live_bytes\": " << sample.liveBytes << ", \"rss_bytes\": " << sample.rssBytes << "}";
+        }
+        std::cout << "]}";
+    }
+
+    std::cout << "\n  ]\n}\n";
+    return 0;
+}
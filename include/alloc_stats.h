@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//a counter written by the one thread that owns the heap it counts for (under the heap's
+//lock, if it has one) and read by anyone: a relaxed load and store instead of a locked
+//read-modify-write, so the hot path pays a plain add on a line it already holds, and a
+//scraper on another thread reads it without taking the lock
+class StatCounter {
+public:
+    void add(uint64_t n = 1) {
+        this->value.store(this->value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void sub(uint64_t n = 1) {
+        this->value.store(this->value.load(std::memory_order_relaxed) - n, std::memory_order_relaxed);
+    }
+
+    //for counters several threads write without a common lock, on paths slow enough
+    //(a syscall each) that a locked add does not show
+    void addShared(uint64_t n = 1) { this->value.fetch_add(n, std::memory_order_relaxed); }
+    void subShared(uint64_t n = 1) { this->value.fetch_sub(n, std::memory_order_relaxed); }
+
+    uint64_t get() const { return this->value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+//a snapshot of an allocator's counters; counters read while the heap is busy are each
+//exact but may be a few operations apart from one another
+//bytes are payload bytes, the block headers only show up in osBytes
+struct AllocStats {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t splits = 0;
+    uint64_t coalesces = 0;
+    uint64_t osRequests = 0; //times the heap grew through its provider (or mapped a block)
+    uint64_t osBytes = 0;    //bytes held from the provider now, given-back tails deducted
+    uint64_t liveBytes = 0;  //payload of the blocks handed out and not freed yet
+    uint64_t freeBytes = 0;  //payload of the blocks on the free lists
+    uint64_t freeBlocks = 0; //free list length
+
+    //share of the free and live payload that sits unused on the free lists
+    double fragmentation() const {
+        uint64_t total = this->liveBytes + this->freeBytes;
+        return total ? (double)this->freeBytes / total : 0.0;
+    }
+
+    AllocStats& operator+=(const AllocStats& other);
+};
+
+//the counters behind an AllocStats, one set per heap
+struct AllocCounters {
+    StatCounter allocs;
+    StatCounter frees;
+    StatCounter splits;
+    StatCounter coalesces;
+    StatCounter osRequests;
+    StatCounter osBytes;
+    StatCounter liveBytes;
+    StatCounter freeBytes;
+    StatCounter freeBlocks;
+
+    AllocStats read() const;
+};
+
+//builds a JSON document in a caller's buffer without allocating, so it can run inside
+//a malloc; like snprintf it keeps counting past the end, length() is the size the whole
+//document needs and the buffer always holds a terminated prefix of it
+class StatsJson {
+public:
+    StatsJson(char* buffer, size_t capacity);
+
+    //a key only inside objects, values inside arrays take nullptr
+    void beginObject(const char* key = nullptr);
+    void endObject();
+    void beginArray(const char* key = nullptr);
+    void endArray();
+    //the counters as an object, plus the fragmentation they work out to
+    void add(const char* key, const AllocStats& stats);
+    void add(const char* key, uint64_t value);
+
+    size_t length() const { return this->used; }
+
+private:
+    char* buffer;
+    size_t capacity;
+    size_t used = 0;
+    bool needComma = false;
+
+    void put(const char* text);
+    void key(const char* name);
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//compact binary trace of a program's allocator calls, recorded by libcustomalloc.so
+//(CUSTOMALLOC_TRACE=path) and replayed against any allocator class by bench/trace_replay
+//
+//the file is TRACE_MAGIC and a version byte, then one record per call:
+//  tag byte  TraceOp in the low two bits, plus TRACE_THREAD_CHANGED and TRACE_ALIGNED
+//  varint    nanoseconds since the previous record
+//  varint    thread id, only when it differs from the previous record's
+//  varint    object id, free and realloc only
+//  varint    size, alloc and realloc only
+//  varint    log2 of the alignment, only when TRACE_ALIGNED
+//objects are numbered instead of keeping their addresses: an alloc takes the id freed
+//last, or the next unused one; the reader follows the same rule, so alloc records carry
+//no id and ids stay as dense as the live set
+
+enum class TraceOp : uint8_t {
+    Alloc = 0,
+    Free = 1,
+    Realloc = 2
+};
+
+struct TraceEvent {
+    TraceOp op = TraceOp::Alloc;
+    uint32_t thread = 0;
+    uint64_t time = 0;      //nanoseconds since recording started
+    uint64_t object = 0;    //id of the object allocated, freed or resized
+    size_t size = 0;        //requested bytes, alloc and realloc
+    size_t alignment = 0;   //0 unless the caller asked for more than malloc's default
+};
+
+const char TRACE_MAGIC[4] = {'A', 'T', 'R', 'C'};
+const uint8_t TRACE_VERSION = 1;
+const uint8_t TRACE_OP_MASK = 0x03;
+const uint8_t TRACE_THREAD_CHANGED = 0x04;
+const uint8_t TRACE_ALIGNED = 0x08;
+
+//writes a trace without allocating: records go through a fixed buffer and the
+//address -> id table lives in pages mapped for it, so it can run inside malloc itself
+//not thread safe, the caller serializes calls in the order the allocator saw them
+//(libcustomalloc records under its heap lock); on any write or mapping failure it
+//stops recording and leaves the program alone
+class TraceRecorder {
+public:
+    static const size_t BUFFER_SIZE = 64 * 1024;
+
+    TraceRecorder() = default;
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    //creates (or truncates) the trace file and writes the header
+    bool open(const char* path);
+    //flushes what is buffered and closes the file
+    void close();
+    bool isOpen() const { return this->fd >= 0; }
+
+    //`alignment` 0 for the allocator's default
+    void recordAlloc(const void* data, size_t size, size_t alignment, uint32_t thread);
+    //pointers the trace never saw allocated are skipped
+    void recordFree(const void* data, uint32_t thread);
+    void recordRealloc(const void* old, const void* data, size_t size, uint32_t thread);
+    void flush();
+
+    uint64_t records() const { return this->recordCount; }
+
+    //small sequential id for the calling thread, handed out on its first call
+    static uint32_t currentThread();
+
+private:
+    struct Entry {
+        uintptr_t address; //0 marks an empty slot
+        uint64_t object;
+    };
+
+    int fd = -1;
+    char buffer[BUFFER_SIZE];
+    size_t used = 0;
+    uint64_t recordCount = 0;
+    uint64_t lastTime = 0;
+    uint32_t lastThread = 0;
+
+    //live addresses -> ids, open addressing with linear probing
+    Entry* table = nullptr;
+    size_t capacity = 0;
+    size_t liveCount = 0;
+    //ids freed, the last one is handed out next
+    uint64_t* freeIds = nullptr;
+    size_t freeCount = 0;
+    size_t freeCapacity = 0;
+    uint64_t nextId = 0;
+
+    void beginRecord(TraceOp op, uint32_t thread, bool aligned);
+    void putVarint(uint64_t value);
+    bool write(const char* bytes, size_t size);
+
+    bool endStale(uintptr_t address, uint32_t thread);
+    uint64_t takeId();
+    void releaseId(uint64_t object);
+    bool insert(uintptr_t address, uint64_t object);
+    //finds the id of `address` and drops it from the table
+    bool remove(uintptr_t address, uint64_t& object);
+    bool grow();
+};
+
+//reads a trace through a read-only mapping, one record per next()
+class TraceReader {
+public:
+    TraceReader() = default;
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool open(const char* path);
+    void close();
+    //back to the first record, object ids start over
+    void rewind();
+
+    //false at the end of the trace or at a record cut short (see truncated())
+    bool next(TraceEvent& event);
+    //the last next() stopped inside a record or on a malformed one
+    bool truncated() const { return this->broken; }
+
+    //ids handed out so far, an id table this big covers every object read yet
+    uint64_t objectCount() const { return this->nextId; }
+    size_t fileSize() const { return this->size; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+    bool broken = false;
+
+    uint64_t time = 0;
+    uint32_t thread = 0;
+    std::vector<uint64_t> freeIds;
+    uint64_t nextId = 0;
+
+    bool getVarint(uint64_t& value);
+};
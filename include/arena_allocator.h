@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "block_utils.h"
+#include "chunk_provider.h"
+#include "remote_free_list.h"
+#include "segregated_allocator.h"
+
+//several independent SegregatedListAllocators, each behind its own lock
+//a thread allocates from the arena of the CPU it runs on (or a round-robin pick),
+//so threads only contend when they share a CPU; all arenas live in one reserved
+//range sliced into ARENA_SPAN pieces, which makes the owner of a pointer an index
+//computation and lets a free from any thread go back to the arena it came from
+//a free from a thread allocating elsewhere does not take the owner's lock: the block
+//is pushed on the owner's remote free list and reclaimed on its next allocation
+class ArenaAllocator {
+public:
+    enum class Selection {
+        CurrentCpu, //arena of the CPU the thread is running on
+        RoundRobin  //fixed arena per thread, handed out in turn
+    };
+
+    static const int MAX_ARENAS = 64;
+    static const size_t ARENA_SPAN = size_t(4) << 30;      //address space per arena, not memory
+    static const size_t RUN_SPAN = size_t(1) << 30;        //tail of each span kept for slab runs
+    static const size_t BLOCK_SPAN = ARENA_SPAN - RUN_SPAN; //bucket heap
+
+    //arenaCount 0 means one arena per configured CPU
+    explicit ArenaAllocator(int arenaCount = 0, Selection selection = Selection::CurrentCpu);
+    ~ArenaAllocator();
+
+    ArenaAllocator(const ArenaAllocator&) = delete;
+    ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+    int arenaCount() const { return (int)this->arenas.size(); }
+    //arena the calling thread allocates from
+    int currentArena();
+    //arena a pointer belongs to, -1 for mapped blocks and foreign pointers
+    int arenaOf(const void* data) const;
+
+    word_t* alloc(size_t size);
+    word_t* calloc(size_t count, size_t size);
+    //see SegregatedListAllocator::allocAligned
+    word_t* allocAligned(size_t size, size_t alignment);
+    word_t* realloc(word_t* data, size_t size);
+    void free(word_t* data);
+    //see SegregatedListAllocator::free(data, size), remote frees do not need the size
+    void free(word_t* data, size_t size);
+    //payload bytes usable behind a pointer handed out by alloc
+    size_t usableSize(word_t* data);
+    //collects pending remote frees and trims every arena, returns the bytes purged
+    size_t trim();
+
+    //counters summed over the arenas, read without their locks; blocks pushed on a
+    //remote free list still count as live until their arena collects them
+    AllocStats getStats() const;
+    //heap blocks of one arena; mapped blocks only add up over all arenas, one is counted
+    //by the arena that mapped it and uncounted by the arena of the thread unmapping it
+    AllocStats arenaStats(int arena) const { return this->arenas[arena]->heap.heapStats(); }
+    //{"total", "mapped", "arenas": [{"total", "buckets", "slabs", "slab_pool"}, ...]} as one
+    //JSON object in `buffer`, returns the length it needs (see StatsJson)
+    size_t statsJson(char* buffer, size_t capacity) const;
+
+    Selection selection;
+    //push frees of other arenas' blocks on their remote free list instead of locking them
+    bool deferRemoteFrees = true;
+    //sized frees abort when the size does not fit the block, instead of trusting it
+    bool verifySizedFree = false;
+
+private:
+    struct alignas(64) Arena {
+        std::mutex lock;
+        MmapChunkProvider blocks;
+        MmapChunkProvider runs;
+        SegregatedListAllocator heap;
+        alignas(64) RemoteFreeList remoteFrees; //own cache line, hammered by other threads
+
+        explicit Arena(char* span);
+    };
+
+    //frees what other threads pushed, called with the arena's lock held
+    void collectRemoteFrees(Arena& arena);
+
+    std::vector<std::unique_ptr<Arena>> arenas;
+    char* base = nullptr; //start of the reservation holding every arena
+    size_t reserved = 0;
+};
\ No newline at end of file
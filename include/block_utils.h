@@ -5,18 +5,86 @@
 
 using word_t = intptr_t;
 
+class ChunkProvider;
+
+//an allocated block is one size word followed by the payload
+//sizes are word aligned, so the low bits of the size word hold the flags
+//free blocks keep their list links (and a footer) inside the payload
 struct Block {
-    size_t size;
-    bool used;
-    Block *prev;
-    Block *next;
-    word_t data[1];
+    static const size_t USED = 1;      //block is allocated
+    static const size_t PREV_USED = 2; //physical predecessor is allocated (free predecessors leave a footer)
+    static const size_t MAPPED = 4;    //block has a mapping of its own, outside any heap
+    static const size_t FLAGS = sizeof(word_t) - 1;
+
+    size_t header;
+    union {
+        word_t data[1];
+        struct {
+            Block *prev;
+            Block *next;
+        };
+    };
+
+    size_t size() const { return this->header & ~FLAGS; }
+    bool isUsed() const { return this->header & USED; }
+    bool isPrevUsed() const { return this->header & PREV_USED; }
+    bool isMapped() const { return this->header & MAPPED; }
+
+    void setSize(size_t size) { this->header = size | (this->header & FLAGS); }
+    void setUsed(bool used) { this->header = used ? (this->header | USED) : (this->header & ~USED); }
+    void setPrevUsed(bool prevUsed) { this->header = prevUsed ? (this->header | PREV_USED) : (this->header & ~PREV_USED); }
+    void setMapped(bool mapped) { this->header = mapped ? (this->header | MAPPED) : (this->header & ~MAPPED); }
+
+    //the flag in a used neighbour's header, written under the heap's lock while the thread
+    //holding that block may read its size without it (a thread cache's free): a relaxed
+    //load and store, the size bits never change and no other thread writes the word
+    void setPrevUsedShared(bool prevUsed) {
+        size_t word = __atomic_load_n(&this->header, __ATOMIC_RELAXED);
+        word = prevUsed ? (word | PREV_USED) : (word & ~PREV_USED);
+        __atomic_store_n(&this->header, word, __ATOMIC_RELAXED);
+    }
+    //size() for a reader without the heap's lock, see setPrevUsedShared
+    size_t sharedSize() const { return __atomic_load_n(&this->header, __ATOMIC_RELAXED) & ~FLAGS; }
 };
 
+const size_t HEADER_SIZE = sizeof(size_t);
+//payload a free block needs for its prev/next links and footer
+const size_t MIN_FREE_PAYLOAD = 2 * sizeof(Block*) + sizeof(size_t);
+//largest request a heap takes: no provider hands out half the address space, and below
+//it align(), allocSize() and the padding allocAligned adds cannot wrap
+const size_t MAX_REQUEST = SIZE_MAX / 2;
+
 //extern Block* heapStart;
 //extern Block* top;
 
 size_t align(size_t n);
 size_t allocSize(size_t size);
-Block* requestFromOS(size_t size);
-Block* getHeader(word_t *data); 
\ No newline at end of file
+Block* requestFromOS(ChunkProvider* provider, size_t size);
+Block* getHeader(word_t *data);
+//sized frees with verifySizedFree on: a size the block cannot hold means the caller has
+//the wrong pointer or size, so it stops here before any free list is corrupted
+void verifyFreeSize(const void* data, size_t size, size_t usable);
+
+//alignments allocAligned takes: powers of two up to the page size
+bool isValidAlignment(size_t alignment);
+//distance from `data` to the first `alignment`-aligned address that is either `data`
+//itself or far enough past it to leave a free block of `minPayload` bytes in front,
+//never more than minPayload + alignment
+size_t alignedLead(word_t* data, size_t alignment, size_t minPayload);
+//gives the first `lead` bytes of a block a block of their own, `block` keeps them as
+//lead - HEADER_SIZE bytes of payload and the block returned holds the rest
+Block* splitFront(Block* block, size_t lead);
+
+//large blocks skip the heap: one private mapping per block, page-rounded,
+//handed straight back to the OS when freed; the payload starts `alignment` bytes into
+//the first page when that is more than a word, so it may be aligned up to a page
+Block* mapBlock(size_t size, size_t alignment = sizeof(word_t));
+//resizes a mapped block with mremap, the kernel moves the pages instead of copying them
+Block* remapBlock(Block* block, size_t size);
+void unmapBlock(Block* block);
+//bytes of the mapping behind a mapped block
+size_t mappingSize(Block* block);
+
+//boundary tags: a free block repeats its size in the last word of its payload
+void writeFooter(Block* block);
+Block* getPreviousFromFooter(Block* block);
\ No newline at end of file
@@ -1,12 +1,35 @@
 #pragma once
 
 #include <cstddef>
+#include "alloc_stats.h"
 #include "block_utils.h"
+#include "chunk_provider.h"
 
 class BumpAllocator {
+private:
+    MmapChunkProvider defaultProvider; //private heap unless the caller supplies one
+
 public:
+    BumpAllocator() = default;
+    explicit BumpAllocator(ChunkProvider* provider) : provider(provider) {}
+
     Block* top = nullptr;
     Block* heapStart = nullptr;
+    ChunkProvider* provider = &defaultProvider; //where the heap grows from
+    bool verifySizedFree = false; //sized frees abort when the size does not fit the block
+
+    //counters of this heap, readable from any thread; freed blocks are never reused,
+    //so free bytes only grow until the heap goes away
+    AllocCounters stats;
+    AllocStats getStats() const { return this->stats.read(); }
+
     word_t* alloc(size_t size);
+    //appends a new block after top, size must already be aligned; not counted as an alloc
+    word_t* allocFromOS(size_t size);
+    //payload aligned to `alignment` (a power of two up to the page size, else nullptr),
+    //the gap in front of it is taken by an unused filler block
+    word_t* allocAligned(size_t size, size_t alignment);
     void free(word_t* data);
+    //`size` as passed to alloc, only checked against the header when verifySizedFree is set
+    void free(word_t* data, size_t size);
 };
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+
+//supplies the memory an allocator's heap grows into
+//every extension is contiguous with the previous one, so the blocks
+//between heapStart and top always form one unbroken physical chain
+class ChunkProvider {
+public:
+    virtual ~ChunkProvider() = default;
+
+    //hands out the next `size` bytes of the heap, nullptr when the backend is exhausted
+    virtual void* extend(size_t size) = 0;
+
+    //true if memory handed out by extend is known to read as zero (fresh OS pages)
+    virtual bool zeroFilled() const { return false; }
+
+    //takes back the last `size` bytes handed out, so the heap can shrink from its top
+    //whole pages go back to the OS, false if the backend cannot give them back
+    virtual bool release(size_t size) { (void)size; return false; }
+};
+
+//program break backend: grows the break in doubling chunks and bumps inside them
+//needs the break to itself, it refuses to grow once anything else has moved it
+class SbrkChunkProvider : public ChunkProvider {
+public:
+    static const size_t MIN_GROWTH = 64 * 1024;
+    static const size_t MAX_GROWTH = 16 * 1024 * 1024;
+
+    void* extend(size_t size) override;
+    bool zeroFilled() const override { return true; }
+    bool release(size_t size) override;
+
+private:
+    char* start = nullptr; //first byte handed out
+    char* end = nullptr;   //next free byte
+    char* limit = nullptr; //current program break
+    size_t growth = MIN_GROWTH;
+};
+
+//reserves one large virtual range up front and commits it in growing chunks
+//allocators use this by default, each one gets its own private range
+class MmapChunkProvider : public ChunkProvider {
+public:
+    static const size_t DEFAULT_RESERVE = size_t(1) << 30; //1 GiB of address space, not memory
+    static const size_t MIN_COMMIT = 64 * 1024;
+    static const size_t MAX_COMMIT = 16 * 1024 * 1024;
+
+    explicit MmapChunkProvider(size_t reserveSize = DEFAULT_RESERVE);
+    //commits inside a PROT_NONE range the caller reserved and keeps ownership of
+    MmapChunkProvider(void* range, size_t size);
+    ~MmapChunkProvider() override;
+
+    MmapChunkProvider(const MmapChunkProvider&) = delete;
+    MmapChunkProvider& operator=(const MmapChunkProvider&) = delete;
+
+    void* extend(size_t size) override;
+    bool zeroFilled() const override { return true; }
+    bool release(size_t size) override;
+
+private:
+    size_t reserveSize;
+    char* base = nullptr;      //start of the reservation, mapped lazily on first use
+    char* end = nullptr;       //next free byte
+    char* committed = nullptr; //end of the read/write part
+    size_t commitStep = MIN_COMMIT;
+    bool ownsRange = true;     //unmapped on destruction unless it was handed in
+
+    bool reserve();
+    bool commit(char* needed);
+};
+
+//carves the heap out of a caller-owned buffer, never talks to the OS
+class BufferChunkProvider : public ChunkProvider {
+public:
+    BufferChunkProvider(void* buffer, size_t size);
+
+    void* extend(size_t size) override;
+    bool release(size_t size) override;
+
+private:
+    char* start;
+    char* end;
+    char* limit;
+};
\ No newline at end of file
@@ -1,18 +1,37 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include "alloc_stats.h"
 #include "block_utils.h"
+#include "chunk_provider.h"
+#include "fit_policy.h"
+#include "free_tree.h"
 
 class ExplicitAllocator {
+private:
+    MmapChunkProvider defaultProvider; //private heap unless the caller supplies one
+
 public:
-    using FitFunction = Block* (ExplicitAllocator::*)(size_t);
+    ExplicitAllocator() = default;
+    explicit ExplicitAllocator(ChunkProvider* provider) : provider(provider) {}
 
     Block* top = nullptr;
     Block* heapStart = nullptr;
+    ChunkProvider* provider = &defaultProvider; //where the heap grows from
+    bool verifySizedFree = false; //sized frees abort when the size does not fit the block
     Block* freeListHead = nullptr;
     Block* lastAllocated = nullptr;
     Block* searchStart = nullptr;
 
+    enum class CoalesceMode {
+        None,         //physical neighbours may belong to someone else (e.g. the segregated buckets)
+        Forward,      //merge with the next block only
+        Bidirectional //merge with both neighbours using the boundary tags
+    };
+
+    CoalesceMode coalesceMode = CoalesceMode::Bidirectional;
+
     enum class SearchMode {
         FirstFit,
         NextFit,
@@ -20,7 +39,50 @@ public:
         WorstFit
     };
 
-    Block* findBlock(size_t size, FitFunction strategy);
+    SearchMode searchMode = SearchMode::FirstFit;
+
+    //keeps free blocks in a tree by (size, address) as well, so bestFit and
+    //worstFit are O(log n) instead of a list scan; free blocks then need room
+    //for the tree node, set it before the first alloc
+    bool indexFreeBlocks = false;
+    FreeTree freeTree{2 * sizeof(Block*)}; //node sits after the list links
+
+    //returning memory to the OS
+    static const size_t DEFAULT_TRIM_THRESHOLD = 128 * 1024;
+    static const size_t TOP_PAD = 64 * 1024; //kept in the top block by automatic trimming
+    static const long DEFAULT_DECAY_MS = 10000;
+
+    //a free top block of at least this many bytes is shrunk to TOP_PAD on free and the
+    //tail handed back to the provider; 0 turns it off (as does CoalesceMode::None,
+    //where the top block may sit on someone else's list)
+    size_t trimThreshold = DEFAULT_TRIM_THRESHOLD;
+
+    enum class PurgeAdvice {
+        DontNeed, //pages are dropped at once and read as zero when touched again
+        Free      //pages are reclaimed lazily under memory pressure and may keep their contents
+    };
+
+    PurgeAdvice purgeAdvice = PurgeAdvice::DontNeed;
+
+    //whole pages inside a free block are purged once the block has stayed free this long,
+    //0 purges as soon as a block is freed, negative leaves it to purge()/trim()
+    //checked when a block with whole pages is freed, there is no background thread
+    long decayMillis = DEFAULT_DECAY_MS;
+    uint64_t lastDirtied = 0; //time the latest block with whole pages was freed
+    uint64_t nextDecay = 0;   //no decay pass before this time
+
+    //counters of this heap, bumped under whatever serializes its calls and readable
+    //from any thread; a heap whose blocks are handed out by someone else (the segregated
+    //buckets) only counts its splits, merges, free lists and growth itself
+    AllocCounters stats;
+    AllocStats getStats() const { return this->stats.read(); }
+
+    //free block for `size` bytes with the fit searchMode names
+    Block* findBlock(size_t size);
+    //free block for `size` bytes with a fit policy fixed at compile time (see fit_policy.h)
+    template<class Fit>
+    Block* findBlock(size_t size) { return Fit::find(*this, size); }
+    //the search loops are defined below the class, so they inline into findBlock and alloc
     Block* firstFit(size_t size);
     Block* nextFit(size_t size);
     Block* bestFit(size_t size);
@@ -29,14 +91,161 @@ public:
     Block* getPhysicalPreviousBlock(Block* block);
     Block* getPhysicalNextBlock(Block* block);
 
+    size_t minPayload();
     bool canSplit(Block* block, size_t size);
     bool canCoalesce(Block* block);
+    bool canCoalescePrevious(Block* block);
     Block* split(Block* block, size_t size);
     Block* coalesce(Block* block);
 
     void removeFromFreeList(Block* block);
     void addToFreeList(Block* block);
+    //puts a chain of free blocks linked through prev/next in front of the list at once,
+    //only for blocks the tree and the decay stamps need not see (unindexed, under a page);
+    //`blocks` and `bytes` are the chain's length and payload, for the stats
+    void addChainToFreeList(Block* first, Block* last, size_t blocks, size_t bytes);
+    void setPhysicalNextPrevUsed(Block* block, bool prevUsed);
+
+    bool absorbNext(Block* block, size_t size);
+    bool growTop(Block* block, size_t size);
     
+    bool purgeableRange(Block* block, char*& start, char*& end);
+    uint64_t* purgeStamp(Block* block);
+    size_t purgeBlock(Block* block);
+    //purges every dirty free page now, returns the bytes advised
+    size_t purge();
+    //purges the pages of blocks that stayed free for decayMillis
+    size_t decay();
+    void decayTick();
+    //shrinks a free top block to `keep` bytes, returns the bytes given back to the provider
+    size_t releaseTop(size_t keep);
+    //gives back everything it can: the free top beyond `pad` bytes and all dirty free pages
+    size_t trim(size_t pad = 0);
+
+    word_t* alloc(size_t size);
+    //alloc with a fit policy fixed at compile time instead of searchMode, e.g. alloc<BestFit>(n)
+    template<class Fit>
     word_t* alloc(size_t size);
+    //payload size alloc works with: aligned, and room for the free list links once freed
+    size_t requestSize(size_t size);
+    word_t* allocFromFreeList(size_t size);
+    //hands out a free block found for `size` bytes, splitting off what the request does not need
+    word_t* takeFreeBlock(Block* block, size_t size);
+    word_t* allocFromOS(size_t size);
+    word_t* calloc(size_t count, size_t size);
+    //payload aligned to `alignment` (a power of two up to the page size, else nullptr),
+    //the slack in front of it and behind it goes back on the free list
+    word_t* allocAligned(size_t size, size_t alignment);
+    word_t* realloc(word_t* data, size_t size);
     void free(word_t* data);
+    //puts a block back on the free list, merged with its free neighbours, without counting
+    //a free: for the slack alloc calls cut off and for blocks their owner counts itself
+    void freeBlock(Block* block);
+    //counts a block handed out to the caller
+    void countAlloc(Block* block) {
+        this->stats.allocs.add();
+        this->stats.liveBytes.add(block->size());
+    }
+    //counts a block the caller gave back
+    void countFree(Block* block) {
+        this->stats.frees.add();
+        this->stats.liveBytes.sub(block->size());
+    }
+    //`size` as passed to alloc; merging with the neighbours needs the header anyway,
+    //so the size is only checked against it when verifySizedFree is set
+    void free(word_t* data, size_t size);
 };
+
+inline Block* ExplicitAllocator::firstFit(size_t size) {
+    Block* block = this->freeListHead;
+    
+    while(block != nullptr) {
+        if(!block->isUsed() && block->size() >= size) {
+            return block;
+        }
+        
+        block = block->next;
+    }
+
+    return nullptr;
+}
+
+inline Block* ExplicitAllocator::nextFit(size_t size) {
+    if(!this->searchStart) {
+        return this->firstFit(size);
+    }
+
+    Block* block = this->searchStart;
+
+    do {
+        if(!block->isUsed() && block->size() >= size) {
+            return block;
+        }
+        block = block->next ? block->next : this->freeListHead;
+    } while(block != this->searchStart);
+
+    return nullptr;
+}
+
+inline Block* ExplicitAllocator::bestFit(size_t size) {
+    if(this->indexFreeBlocks) return this->freeTree.lowerBound(size);
+
+    Block* block = this->freeListHead;
+    Block* resBlock = nullptr;
+
+    while(block != nullptr) {
+        if(!block->isUsed() && block->size() >= size) {
+            if(resBlock == nullptr || block->size() < resBlock->size()) {
+                resBlock = block;
+            }
+        }
+        
+        block = block->next;
+    }
+
+    return resBlock;
+}
+
+inline Block* ExplicitAllocator::worstFit(size_t size) {
+    if(this->indexFreeBlocks) {
+        Block* largest = this->freeTree.largest();
+        return (largest && largest->size() >= size) ? largest : nullptr;
+    }
+
+    Block* block = this->freeListHead;
+    Block* resBlock = nullptr;
+
+    while(block != nullptr) {
+        if(!block->isUsed() && block->size() >= size) {
+            if(resBlock == nullptr || block->size() > resBlock->size()) {
+                resBlock = block;
+            }
+        }
+        
+        block = block->next;
+    }
+
+    return resBlock;
+}
+
+inline Block* ExplicitAllocator::findBlock(size_t size) {
+    switch(this->searchMode) {
+        case SearchMode::NextFit: return this->nextFit(size);
+        case SearchMode::BestFit: return this->bestFit(size);
+        case SearchMode::WorstFit: return this->worstFit(size);
+        default: return this->firstFit(size);
+    }
+}
+
+template<class Fit>
+word_t* ExplicitAllocator::alloc(size_t size) {
+    if(size > MAX_REQUEST) return nullptr;
+    size = this->requestSize(size);
+
+    word_t* data = nullptr;
+    if(Block* block = this->findBlock<Fit>(size)) data = this->takeFreeBlock(block, size);
+    else data = this->allocFromOS(size);
+
+    if(data) this->countAlloc(getHeader(data));
+    return data;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include "block_utils.h"
+
+//compile-time fit policies for alloc<Fit> and findBlock<Fit> of ExplicitAllocator and
+//ImplicitAllocator: a policy is any type with a static find(heap, size) that returns a
+//free block of at least `size` bytes, or nullptr
+//the built-in ones call the heaps' inline search loops, so the whole search is inlined
+//into the caller; alloc without a policy picks one from searchMode at run time
+struct FirstFit {
+    template<class Heap>
+    static Block* find(Heap& heap, size_t size) { return heap.firstFit(size); }
+};
+
+struct NextFit {
+    template<class Heap>
+    static Block* find(Heap& heap, size_t size) { return heap.nextFit(size); }
+};
+
+struct BestFit {
+    template<class Heap>
+    static Block* find(Heap& heap, size_t size) { return heap.bestFit(size); }
+};
+
+struct WorstFit {
+    template<class Heap>
+    static Block* find(Heap& heap, size_t size) { return heap.worstFit(size); }
+};
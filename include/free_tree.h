@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "block_utils.h"
+
+//red-black tree of free blocks keyed by (size, address), stored inside the free
+//blocks themselves: each node lives `nodeOffset` bytes into the block payload
+//best fit is a lower bound and worst fit the rightmost node, both O(log n)
+class FreeTree {
+public:
+    static const size_t NODE_SIZE = 3 * sizeof(Block*); //left, right, parent + color
+
+    explicit FreeTree(size_t nodeOffset = 0) : nodeOffset(nodeOffset) {}
+
+    Block* root = nullptr;
+    size_t count = 0;
+
+    void insert(Block* block);
+    void remove(Block* block);
+
+    //smallest block of at least `size` bytes, lowest address among equal sizes
+    Block* lowerBound(size_t size) const;
+    Block* largest() const;
+
+    //in-order walk, smallest first
+    Block* first() const;
+    Block* next(Block* block) const;
+
+    //checks ordering, parent links and red-black invariants, for tests
+    bool isValid() const;
+
+private:
+    struct Node {
+        Block* left;
+        Block* right;
+        uintptr_t parentColor; //parent pointer, low bit set when the node is red
+    };
+
+    size_t nodeOffset;
+
+    Node* node(Block* block) const;
+    Block*& left(Block* block) const { return this->node(block)->left; }
+    Block*& right(Block* block) const { return this->node(block)->right; }
+    Block* parent(Block* block) const;
+    bool isRed(Block* block) const;
+    void setParent(Block* block, Block* parent);
+    void setRed(Block* block, bool red);
+
+    static bool less(Block* a, Block* b);
+    Block* minimum(Block* block) const;
+
+    void rotateLeft(Block* block);
+    void rotateRight(Block* block);
+    void transplant(Block* from, Block* to);
+    void insertFixup(Block* block);
+    void removeFixup(Block* block, Block* parent);
+
+    int blackHeight(Block* block, bool& valid) const;
+};
\ No newline at end of file
@@ -1,14 +1,27 @@
 #pragma once
 
 #include <cstddef>
+#include "alloc_stats.h"
 #include "block_utils.h"
+#include "chunk_provider.h"
+#include "fit_policy.h"
+#include "free_tree.h"
 
 class ImplicitAllocator {
+private:
+    MmapChunkProvider defaultProvider; //private heap unless the caller supplies one
+
 public:
-    using FitFunction = Block* (ImplicitAllocator::*)(size_t);
+    ImplicitAllocator() = default;
+    explicit ImplicitAllocator(ChunkProvider* provider) : provider(provider) {}
+
+    //blocks are found by walking sizes, a free block needs no links
+    static const size_t MIN_PAYLOAD = sizeof(word_t);
 
     Block* top = nullptr;
     Block* heapStart = nullptr;
+    ChunkProvider* provider = &defaultProvider; //where the heap grows from
+    bool verifySizedFree = false; //sized frees abort when the size does not fit the block
     Block* lastAllocated = nullptr;
 
     enum class SearchMode {
@@ -18,17 +31,178 @@ public:
         WorstFit
     };
 
-    Block* findBlock(size_t size, FitFunction strategy);
+    SearchMode searchMode = SearchMode::FirstFit;
+
+    //keeps free blocks in a tree by (size, address), so bestFit and worstFit
+    //are O(log n) instead of a heap walk; free blocks then need room for the
+    //tree node, set it before the first alloc
+    bool indexFreeBlocks = false;
+    FreeTree freeTree;
+
+    //counters of this heap, bumped under whatever serializes its calls and readable
+    //from any thread; free blocks are the unused blocks in the heap walk
+    AllocCounters stats;
+    AllocStats getStats() const { return this->stats.read(); }
+
+    //free block for `size` bytes with the fit searchMode names
+    Block* findBlock(size_t size);
+    //free block for `size` bytes with a fit policy fixed at compile time (see fit_policy.h)
+    template<class Fit>
+    Block* findBlock(size_t size) { return Fit::find(*this, size); }
+    //the search loops are defined below the class, so they inline into findBlock and alloc
     Block* firstFit(size_t size);
     Block* nextFit(size_t size);
     Block* bestFit(size_t size);
     Block* worstFit(size_t size);
 
+    Block* getPhysicalNextBlock(Block* block);
+
+    size_t minPayload();
     bool canSplit(Block* block, size_t size);
     bool canCoalesce(Block* block);
     Block* split(Block* block, size_t size);
     Block* coalesce(Block* block);
 
+    bool absorbNext(Block* block, size_t size);
+    bool growTop(Block* block, size_t size);
+
+    word_t* alloc(size_t size);
+    //alloc with a fit policy fixed at compile time instead of searchMode, e.g. alloc<BestFit>(n)
+    template<class Fit>
     word_t* alloc(size_t size);
+    //payload size alloc works with: aligned, and room for the tree node once freed if indexed
+    size_t requestSize(size_t size);
+    //hands out a free block found for `size` bytes, splitting off what the request does not need
+    word_t* takeFreeBlock(Block* block, size_t size);
+    word_t* allocFromOS(size_t size);
+    //payload aligned to `alignment` (a power of two up to the page size, else nullptr),
+    //the slack in front of it and behind it is left as free blocks
+    word_t* allocAligned(size_t size, size_t alignment);
+    word_t* realloc(word_t* data, size_t size);
     void free(word_t* data);
+    //marks a block free, merged with a free successor, without counting a free:
+    //for the slack alloc calls cut off
+    void freeBlock(Block* block);
+    //counts a block handed out to the caller
+    void countAlloc(Block* block) {
+        this->stats.allocs.add();
+        this->stats.liveBytes.add(block->size());
+    }
+    //counts a block the caller gave back
+    void countFree(Block* block) {
+        this->stats.frees.add();
+        this->stats.liveBytes.sub(block->size());
+    }
+    //`size` as passed to alloc; merging with the neighbours needs the header anyway,
+    //so the size is only checked against it when verifySizedFree is set
+    void free(word_t* data, size_t size);
 };
+
+//blocks sit back to back between heapStart and top, so the next one
+//starts right after this payload
+inline Block* ImplicitAllocator::getPhysicalNextBlock(Block* block) {
+    if(block == this->top) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<Block*>(reinterpret_cast<char*>(block->data) + block->size());
+}
+
+//return the first empty block that can fit the requirement
+inline Block* ImplicitAllocator::firstFit(size_t size) {
+    Block* block = this->heapStart;
+    
+    while(block != nullptr) {
+        if(!block->isUsed() && block->size() >= size) {
+            return block;
+        }
+        
+        block = this->getPhysicalNextBlock(block);
+    }
+
+    return nullptr;
+}
+
+//returns the first empty block starting from the last allocated block that can fit the requirement
+inline Block* ImplicitAllocator::nextFit(size_t size) {
+    if(!this->lastAllocated) return nullptr; // no blocks yet
+
+    Block* block = this->getPhysicalNextBlock(this->lastAllocated);
+    if(!block) block = this->heapStart;
+    Block* start = block;
+
+    do {
+        if(!block->isUsed() && block->size() >= size) {
+            return block;
+        }
+
+        block = this->getPhysicalNextBlock(block);
+        if(!block) block = this->heapStart;
+    } while(block != start);
+
+    return nullptr;
+}
+
+//returns the block that can fit the requirement and of the smallest possible size
+inline Block* ImplicitAllocator::bestFit(size_t size) {
+    if(this->indexFreeBlocks) return this->freeTree.lowerBound(size);
+
+    Block* block = this->heapStart;
+    Block* resBlock = nullptr;
+
+    while(block != nullptr) {
+        if(!block->isUsed() && block->size() >= size) {
+            if(resBlock == nullptr || block->size() < resBlock->size()) {
+                resBlock = block;
+            }
+        }
+        
+        block = this->getPhysicalNextBlock(block);
+    }
+
+    return resBlock;
+}
+
+inline Block* ImplicitAllocator::worstFit(size_t size) {
+    if(this->indexFreeBlocks) {
+        Block* largest = this->freeTree.largest();
+        return (largest && largest->size() >= size) ? largest : nullptr;
+    }
+
+    Block* block = this->heapStart;
+    Block* resBlock = nullptr;
+
+    while(block != nullptr) {
+        if(!block->isUsed() && block->size() >= size) {
+            if(resBlock == nullptr || block->size() > resBlock->size()) {
+                resBlock = block;
+            }
+        }
+        
+        block = this->getPhysicalNextBlock(block);
+    }
+
+    return resBlock;
+}
+
+inline Block* ImplicitAllocator::findBlock(size_t size) {
+    switch(this->searchMode) {
+        case SearchMode::NextFit: return this->nextFit(size);
+        case SearchMode::BestFit: return this->bestFit(size);
+        case SearchMode::WorstFit: return this->worstFit(size);
+        default: return this->firstFit(size);
+    }
+}
+
+template<class Fit>
+word_t* ImplicitAllocator::alloc(size_t size) {
+    if(size > MAX_REQUEST) return nullptr;
+    size = this->requestSize(size);
+
+    word_t* data;
+    if(Block* block = this->findBlock<Fit>(size)) data = this->takeFreeBlock(block, size);
+    else data = this->allocFromOS(size);
+
+    if(data) this->countAlloc(getHeader(data));
+    return data;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "block_utils.h"
+#include "chunk_provider.h"
+
+//fixed-size object pool for one type known at compile time
+//slots are cut from chunks of ChunkObjects slots; a dead object's slot holds the link
+//of an intrusive singly linked free list, so alloc and free are a pointer pop and push
+//chunks are carved lazily like slab runs, a fresh chunk touches only its header
+//chunks come from requestFromOS on the pool's provider, or from a backing allocator
+//(any class with alloc(size) and free(data)) that gets them back when the pool dies;
+//objects still alive then are not destroyed
+template<class T, size_t ChunkObjects = 256>
+class Pool {
+    static_assert(ChunkObjects > 0, "a chunk holds at least one object");
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char object[sizeof(T)];
+    };
+
+    struct Chunk {
+        Chunk* next;
+    };
+
+    static size_t slotsOffset() {
+        return (sizeof(Chunk) + alignof(Slot) - 1) & ~(alignof(Slot) - 1);
+    }
+
+    //chunk memory is word aligned, stricter slots need room to move up
+    static size_t chunkBytes() {
+        size_t padding = alignof(Slot) > sizeof(word_t) ? alignof(Slot) - sizeof(word_t) : 0;
+        return padding + slotsOffset() + ChunkObjects * sizeof(Slot);
+    }
+
+    MmapChunkProvider defaultProvider; //private heap unless the caller supplies one
+    Slot* freeList = nullptr;
+    Slot* unused = nullptr;    //slots of the newest chunk from here on were never handed out
+    Slot* unusedEnd = nullptr;
+    Chunk* chunks = nullptr;   //every chunk, for handing them back to a backing allocator
+
+    void* backing = nullptr;
+    word_t* (*backingAlloc)(void* heap, size_t size) = nullptr;
+    void (*backingFree)(void* heap, word_t* data) = nullptr;
+
+    T* refill() {
+        word_t* memory;
+        if(this->backing) {
+            memory = this->backingAlloc(this->backing, chunkBytes());
+        } else {
+            Block* block = requestFromOS(this->provider, chunkBytes());
+            memory = block ? block->data : nullptr;
+        }
+        if(!memory) return nullptr;
+
+        uintptr_t first = (uintptr_t)memory + sizeof(Chunk);
+        first = (first + alignof(Slot) - 1) & ~(uintptr_t)(alignof(Slot) - 1);
+
+        Chunk* chunk = reinterpret_cast<Chunk*>(memory);
+        chunk->next = this->chunks;
+        this->chunks = chunk;
+
+        Slot* slots = reinterpret_cast<Slot*>(first);
+        this->unused = slots + 1;
+        this->unusedEnd = slots + ChunkObjects;
+        return reinterpret_cast<T*>(slots);
+    }
+
+public:
+    Pool() = default;
+    explicit Pool(ChunkProvider* provider) : provider(provider) {}
+    template<class Heap, class = decltype(std::declval<Heap&>().alloc(size_t(0)))>
+    explicit Pool(Heap& heap)
+        : backing(&heap),
+          backingAlloc([](void* h, size_t size) { return static_cast<Heap*>(h)->alloc(size); }),
+          backingFree([](void* h, word_t* data) { static_cast<Heap*>(h)->free(data); }) {}
+
+    ~Pool() {
+        if(!this->backing) return; //provider memory goes with the provider
+        while(Chunk* chunk = this->chunks) {
+            this->chunks = chunk->next;
+            this->backingFree(this->backing, reinterpret_cast<word_t*>(chunk));
+        }
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    ChunkProvider* provider = &defaultProvider; //where chunks come from without a backing allocator
+
+    //raw slot for a T, nullptr when memory runs out
+    T* alloc() {
+        if(Slot* slot = this->freeList) {
+            this->freeList = slot->next;
+            return reinterpret_cast<T*>(slot);
+        }
+        if(this->unused != this->unusedEnd) return reinterpret_cast<T*>(this->unused++);
+        return this->refill();
+    }
+
+    void free(T* object) {
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = this->freeList;
+        this->freeList = slot;
+    }
+
+    //constructs a T in a fresh slot, nullptr when memory runs out
+    //a throwing constructor gives the slot back before the exception leaves
+    template<class... Args>
+    T* create(Args&&... args) {
+        T* object = this->alloc();
+        if(!object) return nullptr;
+
+        try {
+            return new (object) T(std::forward<Args>(args)...);
+        } catch(...) {
+            this->free(object);
+            throw;
+        }
+    }
+
+    void destroy(T* object) {
+        if(object == nullptr) return;
+        object->~T();
+        this->free(object);
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include "alloc_stats.h"
+#include "block_utils.h"
+#include "chunk_provider.h"
+
+//region mode of the bump allocator: objects are bumped out of large chunks with no
+//header of their own and are never freed one by one
+//checkpoint/rewind drops everything allocated since the checkpoint, reset drops everything
+//in O(1); dropped chunks are kept on a spare list and reused before the heap grows
+class RegionAllocator {
+public:
+    static const size_t MIN_CHUNK = 64 * 1024;       //first chunk, each new one doubles
+    static const size_t MAX_CHUNK = 4 * 1024 * 1024; //until this size
+
+private:
+    //chunks in use are chained newest to oldest, spare chunks the same way
+    struct Chunk {
+        Chunk* prev;
+        char* end;
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    MmapChunkProvider defaultProvider; //private heap unless the caller supplies one
+    Chunk* current = nullptr; //chunk being bumped
+    Chunk* first = nullptr;   //oldest chunk in use, where reset splices the chain onto the spares
+    Chunk* spare = nullptr;
+    char* cursor = nullptr;   //next free byte in current
+    char* limit = nullptr;    //end of current
+    size_t growth = MIN_CHUNK;
+    AllocCounters stats; //only the chunks taken from the provider, alloc stays a compare and an add
+
+    word_t* carve(size_t size, size_t alignment);
+    bool nextChunk(size_t needed);
+
+public:
+    //where a region stood; valid until the region is rewound past it or reset
+    struct Checkpoint {
+        Chunk* chunk;
+        char* cursor;
+    };
+
+    RegionAllocator() = default;
+    explicit RegionAllocator(ChunkProvider* provider) : provider(provider) {}
+
+    ChunkProvider* provider = &defaultProvider; //where the chunks come from
+
+    //word aligned; the room test is strict so that an empty region (no chunk yet)
+    //and exact fits go through carve
+    word_t* alloc(size_t size) {
+        if(size < (size_t)(this->limit - this->cursor)) {
+            word_t* data = reinterpret_cast<word_t*>(this->cursor);
+            this->cursor += (size + sizeof(word_t) - 1) & ~(sizeof(word_t) - 1);
+            return data;
+        }
+        return this->carve(size, sizeof(word_t));
+    }
+    //payload aligned to `alignment` (a power of two up to the page size, else nullptr)
+    word_t* allocAligned(size_t size, size_t alignment);
+    //objects go away with the region, single frees are no-ops
+    void free(word_t* data) { (void)data; }
+    void free(word_t* data, size_t size) { (void)data; (void)size; }
+
+    Checkpoint checkpoint() const { return {this->current, this->cursor}; }
+    //drops everything allocated since `mark`, the chunks after its chunk become spares
+    void rewind(Checkpoint mark);
+    //drops everything, all chunks become spares
+    void reset();
+
+    //chunks taken from the provider, plus bytes worked out from the chunk chains: live is
+    //what was carved from the chunks in use (skipped tails included), free is the rest of
+    //the current chunk and the spares, which are the free blocks; objects are not counted
+    //one by one, allocs and frees stay 0; walks the chains, so only on the region's thread
+    AllocStats getStats() const;
+};
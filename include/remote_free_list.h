@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include "block_utils.h"
+
+//blocks freed by threads that do not own them, waiting for the owner to take them back
+//multi-producer single-consumer: any thread pushes with one CAS, the owner takes the
+//whole chain with one exchange, so single entries are never popped and there is no ABA
+//blocks are chained through their first payload word, which every block
+//(down to an 8-byte slab object) has
+struct RemoteFreeList {
+    std::atomic<word_t*> head{nullptr};
+
+    static word_t* next(word_t* data) {
+        return *reinterpret_cast<word_t**>(data);
+    }
+
+    void push(word_t* data) {
+        word_t* old = this->head.load(std::memory_order_relaxed);
+        do {
+            *reinterpret_cast<word_t**>(data) = old;
+        } while(!this->head.compare_exchange_weak(old, data, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    }
+
+    bool empty() const {
+        return this->head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    //detaches everything pushed so far, walk it with next()
+    word_t* takeAll() {
+        if(this->empty()) return nullptr;
+        return this->head.exchange(nullptr, std::memory_order_acquire);
+    }
+};
\ No newline at end of file
@@ -1,17 +1,118 @@
 #pragma once
 
 #include <cstddef>
+#include "alloc_stats.h"
 #include "block_utils.h"
 #include "explicit_allocator.h"
+#include "slab_allocator.h"
 
 class SegregatedListAllocator {
-private:
+public:
     static const int NUM_BUCKETS = 6;
+    //small buckets never coalesce, so a free block only needs room for its list links
+    static const size_t MIN_PAYLOAD = 2 * sizeof(Block*);
+    static const size_t DEFAULT_MMAP_THRESHOLD = 128 * 1024;
+    //list entries allocAligned looks at per bucket for a block that is already aligned
+    static const int ALIGNED_SCAN = 8;
+
+private:
     ExplicitAllocator segregatedList[NUM_BUCKETS];
-    
-    int getBucket(size_t size);
-    
+    SlabAllocator slabs; //header-free runs for buckets 0..3
+    unsigned nonEmptyBuckets = 0; //bit i set while bucket i has a free block
+    //blocks with a mapping of their own, written with addShared: an arena unmaps a block
+    //without taking any lock, so the frees may come from any thread
+    AllocCounters mappedStats;
+
+    void updateBucketBit(int bucket);
+    //allocs, frees and live bytes of heap blocks go to the bucket a free by pointer
+    //returns the block to (see homeBucket), so a bucket's live bytes never drift
+    void countAlloc(Block* block);
+    void countFree(Block* block);
+    //a heap block back on the list its size serves, not counted as a free
+    void releaseBlock(Block* block);
+    word_t* allocMapped(size_t size, size_t alignment = sizeof(word_t));
+    word_t* takeBlock(int source, Block* block, size_t size);
+    bool shrinkBlock(Block* block, size_t size);
+    Block* takeAligned(size_t size, size_t alignment);
+    size_t minSlack();
+    size_t largeMinPayload();
+    bool largeMerges() const;
+    bool inLargeHeap(Block* block);
+    int homeBucket(Block* block);
+    word_t* allocBlock(size_t size, bool& zeroed);
+
 public:
+    //one private heap per bucket, the open-ended bucket merges its free blocks and trims its top
+    SegregatedListAllocator();
+    //all buckets grow the same heap instead of one private heap each, nothing is merged
+    explicit SegregatedListAllocator(ChunkProvider* provider);
+    //buckets grow `provider` and slab runs come from `runs`, mapped blocks stay on,
+    //nothing is merged
+    SegregatedListAllocator(ChunkProvider* provider, ChunkProvider* runs);
+
+    //requests up to SlabAllocator::MAX_SIZE come from slab runs instead of the buckets
+    //off when a provider is supplied, so that all memory comes from it
+    bool useSlabs = true;
+    //requests of at least this many bytes get a mapping of their own that free
+    //unmaps, so transient large buffers do not stay in the heap; 0 turns it off
+    //(also off when a provider is supplied)
+    size_t mmapThreshold = DEFAULT_MMAP_THRESHOLD;
+    //sized frees abort when the size does not fit the block, instead of trusting it
+    bool verifySizedFree = false;
+
+    int getBucket(size_t size);
+    int getFreeBucket(size_t blockSize);
+    size_t bucketSize(int bucket);
+    //payload alloc hands out for a request of `size` bytes that the slabs do not serve
+    size_t requestSize(size_t size);
+    //payload bytes usable behind a pointer handed out by alloc
+    size_t usableSize(word_t* data);
+    //true for pointers served from slab runs, which have no block header in front
+    bool isSlabObject(const void* data) const { return slabs.owns(data); }
+
     word_t* alloc(size_t size);
+    word_t* calloc(size_t count, size_t size);
+    //payload aligned to `alignment` (a power of two up to the page size, else nullptr)
+    //small requests take a slab class at least `alignment` wide, heap blocks reuse a free
+    //aligned block or hand the slack in front of the payload and behind it to the buckets
+    //it fits, slack too small for any of them stays on the block
+    word_t* allocAligned(size_t size, size_t alignment);
+    word_t* realloc(word_t* data, size_t size);
+    //realloc without the move: nullptr when the block cannot take `size` where it is, and
+    //the pointer stays valid; a mapping may still move through mremap, at the same page offset
+    word_t* resizeInPlace(word_t* data, size_t size);
     void free(word_t* data);
+    //`size` as passed to alloc (or to the realloc that returned the pointer): blocks of the
+    //small buckets go to the bucket of that size without looking at their header first,
+    //a wrong size is only caught with verifySizedFree
+    void free(word_t* data, size_t size);
+    //fills out[] with `count` blocks of `size` bytes, returns how many it got (fewer only
+    //when memory runs out); the bucket is resolved once, free blocks are taken from its
+    //head and the rest is cut from one large block in a single pass
+    size_t allocBatch(size_t size, size_t count, word_t** out);
+    //frees `count` blocks from any allocation call, the small buckets' blocks are
+    //chained and spliced onto their lists once per bucket
+    void freeBatch(word_t** ptrs, size_t count);
+    //unmaps a block from mapBlock, needs no lock (see mappedStats)
+    void freeMapped(Block* block);
+    //gives back the free top of the open-ended bucket's heap and purges the whole free pages
+    //inside its blocks, returns the bytes released and advised; with a shared provider it
+    //only purges, a block's physical neighbour may sit on another bucket's list
+    size_t trim();
+
+    //counters summed over the buckets, slab classes and mapped blocks; safe to call from
+    //any thread while others allocate, without the lock that serializes them
+    AllocStats getStats() const;
+    //the same without the mapped blocks
+    AllocStats heapStats() const;
+    //heap blocks of one bucket: its free list, splits and growth, and the blocks handed
+    //out whose size it serves
+    AllocStats bucketStats(int bucket) const { return segregatedList[bucket].getStats(); }
+    AllocStats slabStats(int sizeClass) const { return slabs.classStats(sizeClass); }
+    AllocStats mapStats() const { return mappedStats.read(); }
+    //members "buckets", "slabs" and "slab_pool" into an open object
+    void writeHeapStats(StatsJson& json) const;
+    //{"total", "buckets", "slabs", "slab_pool", "mapped"} as one JSON object in `buffer`,
+    //returns the length it needs (see StatsJson)
+    size_t statsJson(char* buffer, size_t capacity) const;
 };
\ No newline at end of file
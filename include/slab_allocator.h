@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "alloc_stats.h"
+#include "block_utils.h"
+#include "chunk_provider.h"
+
+//one RUN_SIZE-aligned run of equally sized objects, the header sits at the start of the run
+//objects carry no header: the run is found by masking the object address
+struct SlabRun {
+    SlabRun* prev = nullptr;      //links in the partial list of its class
+    SlabRun* next = nullptr;
+    word_t* freeList = nullptr;   //freed objects, chained through their first word
+    char* unused = nullptr;       //objects from here to the run end were never handed out
+    uint32_t sizeClass = 0;
+    uint32_t objectSize = 0;
+    uint32_t used = 0;
+    uint32_t capacity = 0;
+};
+
+//header-free small objects: each size class fills page-sized runs of its own,
+//a run with a free object is always on its class's partial list and a run that
+//empties out goes back to a shared pool for any class
+//runs come from a private mmap range, so ownership is a range check
+class SlabAllocator {
+private:
+    MmapChunkProvider defaultRegion{DEFAULT_RESERVE}; //private range unless the caller supplies one
+
+public:
+    static const size_t RUN_SIZE = 4096;
+    static const size_t RUN_HEADER_SIZE = 64; //run header padded to a cache line
+    static const int NUM_CLASSES = 4;         //8 16 32 64
+    static const size_t MAX_SIZE = sizeof(word_t) << (NUM_CLASSES - 1);
+    static const size_t DEFAULT_RESERVE = size_t(1) << 30;
+
+    SlabAllocator() = default;
+    explicit SlabAllocator(size_t reserveSize) : defaultRegion(reserveSize) {}
+    explicit SlabAllocator(ChunkProvider* region) : region(region) {}
+
+    static size_t classSize(int sizeClass);
+    static SlabRun* runOf(const void* data);
+
+    //true if the pointer was handed out by this allocator
+    bool owns(const void* data) const;
+
+    word_t* alloc(int sizeClass);
+    void free(word_t* data);
+    //fills out[] with up to `count` objects, a run at a time; returns how many it got
+    size_t allocBatch(int sizeClass, size_t count, word_t** out);
+    //objects of one run that sit next to each other in ptrs are chained on its free list at once
+    void freeBatch(word_t** ptrs, size_t count);
+
+    //objects of one class: live and free bytes are worked out from the object counts,
+    //free blocks are the unused object slots in the class's runs
+    AllocStats classStats(int sizeClass) const;
+    //runs taken from the region (osRequests/osBytes) and the fully free runs waiting
+    //in the pool for any class (freeBlocks counts runs here)
+    AllocStats poolStats() const;
+
+    //where runs come from: must be page aligned and used by nothing else,
+    //so that owns() stays a range check
+    ChunkProvider* region = &defaultRegion;
+
+    SlabRun* partialRuns[NUM_CLASSES] = {};
+    SlabRun* emptyRuns = nullptr; //fully free runs, chained through next
+    //owns() runs without the heap's lock (a thread cache frees through usableSize) while
+    //newRun moves the end under it, a run's pointers are published with the bound
+    std::atomic<char*> regionStart{nullptr};
+    std::atomic<char*> regionEnd{nullptr};
+
+private:
+    //the alloc and free paths only bump one count each, the rest changes once per run
+    StatCounter allocs[NUM_CLASSES];
+    StatCounter frees[NUM_CLASSES];
+    StatCounter slots[NUM_CLASSES]; //objects the class's runs hold in all
+    StatCounter runsTaken;
+    StatCounter pooledRuns;
+
+    SlabRun* newRun(int sizeClass);
+    void pushPartial(SlabRun* run);
+    void removePartial(SlabRun* run);
+    void objectsReturned(SlabRun* run, uint32_t count);
+};
\ No newline at end of file
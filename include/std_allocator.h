@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include "block_utils.h"
+
+class BumpAllocator;
+class ExplicitAllocator;
+class SegregatedListAllocator;
+class RegionAllocator;
+
+//`bytes` bytes aligned to `alignment` from any allocator with alloc/allocAligned
+//every block payload is word aligned, only stricter alignments go through allocAligned
+template<class Heap>
+word_t* allocFrom(Heap& heap, size_t bytes, size_t alignment) {
+    if(bytes == 0) bytes = 1; //distinct pointers for empty requests
+    if(alignment <= sizeof(word_t)) return heap.alloc(bytes);
+    return heap.allocAligned(bytes, alignment);
+}
+
+//std::allocator-compatible adapter for the STL containers, e.g.
+//  std::vector<int, HeapAllocator<int, SegregatedListAllocator>> v(HeapAllocator<int, SegregatedListAllocator>(heap));
+//it only holds a pointer to the heap, which must outlive every container using it;
+//frees pass the element count back as a sized free
+template<class T, class Heap>
+class HeapAllocator {
+public:
+    using value_type = T;
+
+    explicit HeapAllocator(Heap& heap) noexcept : heap(&heap) {}
+    template<class U>
+    HeapAllocator(const HeapAllocator<U, Heap>& other) noexcept : heap(other.heap) {}
+
+    T* allocate(size_t n) {
+        if(n > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+
+        word_t* data = allocFrom(*this->heap, n * sizeof(T), alignof(T));
+        if(!data) throw std::bad_alloc();
+        return reinterpret_cast<T*>(data);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        this->heap->free(reinterpret_cast<word_t*>(ptr), n * sizeof(T));
+    }
+
+    Heap* heap;
+};
+
+template<class T, class U, class Heap>
+bool operator==(const HeapAllocator<T, Heap>& a, const HeapAllocator<U, Heap>& b) noexcept {
+    return a.heap == b.heap;
+}
+
+template<class T, class U, class Heap>
+bool operator!=(const HeapAllocator<T, Heap>& a, const HeapAllocator<U, Heap>& b) noexcept {
+    return a.heap != b.heap;
+}
+
+//std::pmr::memory_resource over an allocator, for std::pmr containers
+//the heap is not locked, a resource is for one thread at a time like the heap itself
+template<class Heap>
+class HeapResource : public std::pmr::memory_resource {
+public:
+    explicit HeapResource(Heap& heap) noexcept : heap(heap) {}
+
+    Heap& heap;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        word_t* data = allocFrom(this->heap, bytes, alignment);
+        if(!data) throw std::bad_alloc();
+        return data;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        (void)alignment; //the block knows where it starts, aligned or not
+        this->heap.free(reinterpret_cast<word_t*>(ptr), bytes == 0 ? 1 : bytes);
+    }
+
+    //memory from one heap can only go back to that heap, through whichever resource wraps it
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        auto resource = dynamic_cast<const HeapResource*>(&other);
+        return resource && &resource->heap == &this->heap;
+    }
+};
+
+using BumpResource = HeapResource<BumpAllocator>;
+using ExplicitResource = HeapResource<ExplicitAllocator>;
+using SegregatedResource = HeapResource<SegregatedListAllocator>;
+using RegionResource = HeapResource<RegionAllocator>;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include "block_utils.h"
+#include "segregated_allocator.h"
+
+class ThreadCachedAllocator;
+
+//one thread's cached blocks for one allocator
+//cached payloads are chained through their first word, the block header is not touched
+struct ThreadCache {
+    static const int NUM_CACHED_BUCKETS = 5; //buckets 0..4 (<=128 bytes)
+
+    ThreadCachedAllocator* owner = nullptr;
+    uint64_t epoch = 0;
+    word_t* freeList[NUM_CACHED_BUCKETS] = {};
+    int count[NUM_CACHED_BUCKETS] = {};
+};
+
+//per-thread caches in front of a shared SegregatedListAllocator
+//small allocs/frees only touch the calling thread's cache (no lock, no atomic),
+//the shared buckets are locked once per batch on refill/flush
+//and everything a thread still holds is handed back when it exits
+class ThreadCachedAllocator {
+public:
+    static const int NUM_CACHED_BUCKETS = ThreadCache::NUM_CACHED_BUCKETS;
+    static const int MAX_INSTANCES = 8;              //live allocators that can own a cache slot at once
+    static const int BATCH_SIZE = 32;                //blocks moved per refill/flush
+    static const int CACHE_CAPACITY = 2 * BATCH_SIZE; //flush once a bucket holds this many blocks
+
+    ThreadCachedAllocator();
+    ~ThreadCachedAllocator();
+
+    ThreadCachedAllocator(const ThreadCachedAllocator&) = delete;
+    ThreadCachedAllocator& operator=(const ThreadCachedAllocator&) = delete;
+
+    //sized frees abort when the size does not fit the block, instead of trusting it
+    bool verifySizedFree = false;
+
+    //size of the blocks handed out for a cached bucket
+    static size_t cachedSize(int bucket);
+    //cached bucket a block of this payload size can serve, -1 if it belongs to the shared lists
+    int cachedBucket(size_t blockSize);
+
+    word_t* alloc(size_t size);
+    word_t* calloc(size_t count, size_t size);
+    void free(word_t* data);
+    //`size` as passed to alloc picks the cached bucket, the block is not looked at
+    void free(word_t* data, size_t size);
+    //payload bytes usable behind a pointer handed out by alloc
+    size_t usableSize(word_t* data);
+
+    //returns every block cached by the calling thread to the shared buckets
+    void flushThreadCache();
+    //hands a cache back to the shared buckets and resets it (used on thread exit)
+    void drain(ThreadCache& cache);
+
+    //counters of the shared buckets, read without the lock; blocks sitting in thread
+    //caches count as live there, cache hits and misses are not counted at all
+    AllocStats getStats() const { return this->shared.getStats(); }
+    //see SegregatedListAllocator::statsJson
+    size_t statsJson(char* buffer, size_t capacity) const { return this->shared.statsJson(buffer, capacity); }
+
+private:
+    SegregatedListAllocator shared;
+    std::mutex sharedLock;
+    int slot = -1;
+    uint64_t epoch = 0;
+
+    ThreadCache& localCache();
+    bool refill(ThreadCache& cache, int bucket);
+    //puts a block on the calling thread's cache for `bucket`, or back on the shared lists for -1
+    void release(word_t* data, int bucket);
+    void flush(ThreadCache& cache, int bucket, int count);
+};
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "alloc_stats.h"
+#include "block_utils.h"
+#include "chunk_provider.h"
+
+//two-level segregated fit: free blocks are binned by the power of two of their size
+//(first level) and by SL_INDEX_COUNT linear steps inside it (second level)
+//a bitmap per level finds a fitting non-empty bin with two bit scans, so alloc
+//and free never walk a list and are O(1) in the worst case
+class TlsfAllocator {
+private:
+    MmapChunkProvider defaultProvider; //private heap unless the caller supplies one
+
+public:
+    static const int SL_INDEX_COUNT_LOG2 = 4;
+    static const int SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+    static const int ALIGN_SIZE_LOG2 = 3;
+    static const int FL_INDEX_MAX = 32; //largest block is just under 4 GiB
+    static const int FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2;
+    static const int FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+    static const size_t SMALL_BLOCK_SIZE = size_t(1) << FL_INDEX_SHIFT; //below this, first level 0 is linear
+    static const size_t MAX_BLOCK_SIZE = (size_t(1) << FL_INDEX_MAX) - 1;
+
+    TlsfAllocator() = default;
+    explicit TlsfAllocator(ChunkProvider* provider) : provider(provider) {}
+
+    Block* top = nullptr;
+    Block* heapStart = nullptr;
+    ChunkProvider* provider = &defaultProvider; //where the heap grows from
+    bool verifySizedFree = false; //sized frees abort when the size does not fit the block
+
+    uint32_t flBitmap = 0;                  //bit fl set while any list of that first level is non-empty
+    uint32_t slBitmap[FL_INDEX_COUNT] = {}; //bit sl set while freeLists[fl][sl] is non-empty
+    Block* freeLists[FL_INDEX_COUNT][SL_INDEX_COUNT] = {};
+
+    //counters of this heap, bumped under whatever serializes its calls and readable
+    //from any thread; free blocks are the ones in the bins
+    AllocCounters stats;
+    AllocStats getStats() const { return this->stats.read(); }
+
+    void mappingInsert(size_t size, int& fl, int& sl);
+    void mappingSearch(size_t size, int& fl, int& sl);
+    Block* findSuitableBlock(int& fl, int& sl);
+
+    void insertBlock(Block* block);
+    void removeBlock(Block* block);
+
+    Block* getPhysicalPreviousBlock(Block* block);
+    Block* getPhysicalNextBlock(Block* block);
+    void setPhysicalNextPrevUsed(Block* block, bool prevUsed);
+
+    bool canSplit(Block* block, size_t size);
+    bool canMerge(Block* block, Block* neighbour);
+    Block* split(Block* block, size_t size);
+    Block* coalesce(Block* block);
+
+    word_t* alloc(size_t size);
+    //a block of `size` bytes (already aligned) out of the bins or the provider, not counted as an alloc
+    Block* allocBlock(size_t size);
+    //payload aligned to `alignment` (a power of two up to the page size, else nullptr),
+    //the slack in front of it and behind it goes back into the bins
+    word_t* allocAligned(size_t size, size_t alignment);
+    void free(word_t* data);
+    //bins a block, merged with its free neighbours, without counting a free:
+    //for the slack allocAligned cuts off
+    void freeBlock(Block* block);
+    //`size` as passed to alloc; merging with the neighbours needs the header anyway,
+    //so the size is only checked against it when verifySizedFree is set
+    void free(word_t* data, size_t size);
+};
\ No newline at end of file
@@ -0,0 +1,380 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include "alloc_stats.h"
+#include "explicit_allocator.h"
+#include "implicit_allocator.h"
+#include "tlsf_allocator.h"
+#include "bump_allocator.h"
+#include "region_allocator.h"
+#include "segregated_allocator.h"
+#include "arena_allocator.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+//what the counters should say, from a walk over every block of the heap
+template<class Heap>
+AllocStats walkHeap(Heap& heap) {
+    AllocStats walked;
+    if(!heap.heapStart) return walked;
+
+    for(Block* block = heap.heapStart; ; ) {
+        walked.osBytes += HEADER_SIZE + block->size();
+        if(block->isUsed()) walked.liveBytes += block->size();
+        else walked.freeBytes += block->size(), walked.freeBlocks++;
+
+        if(block == heap.top) break;
+        block = reinterpret_cast<Block*>(reinterpret_cast<char*>(block->data) + block->size());
+    }
+    return walked;
+}
+
+template<class Heap>
+bool matchesWalk(Heap& heap) {
+    AllocStats stats = heap.getStats();
+    AllocStats walked = walkHeap(heap);
+    return stats.liveBytes == walked.liveBytes && stats.freeBytes == walked.freeBytes &&
+           stats.freeBlocks == walked.freeBlocks && stats.osBytes == walked.osBytes;
+}
+
+void testExplicitCounters() {
+    printSeparator("Testing ExplicitAllocator Counters");
+
+    ExplicitAllocator heap;
+    word_t* a = heap.alloc(100);
+    word_t* b = heap.alloc(200);
+    word_t* c = heap.alloc(300);
+
+    AllocStats stats = heap.getStats();
+    if(stats.allocs == 3 && stats.osRequests == 3 && stats.liveBytes == 104 + 200 + 304 &&
+       stats.freeBlocks == 0) {
+        std::cout << "✓ Allocs, OS requests and live bytes counted\n";
+    } else {
+        std::cout << "✗ allocs " << stats.allocs << ", os requests " << stats.osRequests
+                  << ", live " << stats.liveBytes << "\n";
+    }
+
+    heap.free(a);
+    heap.free(b); //merges with a
+    stats = heap.getStats();
+    if(stats.frees == 2 && stats.coalesces == 1 && stats.freeBlocks == 1 &&
+       stats.freeBytes == 104 + HEADER_SIZE + 200 && stats.liveBytes == 304) {
+        std::cout << "✓ Frees, merges and the free list counted\n";
+    } else {
+        std::cout << "✗ frees " << stats.frees << ", coalesces " << stats.coalesces
+                  << ", free blocks " << stats.freeBlocks << ", free bytes " << stats.freeBytes << "\n";
+    }
+
+    heap.alloc(40); //splits the merged block
+    if(heap.getStats().splits == 1 && matchesWalk(heap)) {
+        std::cout << "✓ Splits counted, gauges match a heap walk\n";
+    } else {
+        std::cout << "✗ splits " << heap.getStats().splits << " or gauges off the heap walk\n";
+    }
+    heap.free(c);
+}
+
+//random calls of every kind, after each batch the gauges must match a heap walk
+void testExplicitGauges() {
+    printSeparator("Testing ExplicitAllocator Gauges");
+
+    ExplicitAllocator heap;
+    std::vector<word_t*> live;
+    unsigned seed = 11;
+    bool ok = true;
+    uint64_t calls = 0;
+
+    for(int i = 0; i < 20000; i++) {
+        seed = seed * 1103515245 + 12345;
+        size_t size = 8 + (seed >> 8) % 3000;
+        int kind = (seed >> 20) % 6;
+
+        if(kind < 2 || live.empty()) {
+            live.push_back(kind == 0 ? heap.alloc(size) : heap.calloc(1, size));
+            calls++;
+        } else if(kind == 2) {
+            live.push_back(heap.allocAligned(size, 64 << ((seed >> 4) % 4)));
+            calls++;
+        } else if(kind == 3) {
+            word_t*& victim = live[(seed >> 4) % live.size()];
+            victim = heap.realloc(victim, size);
+        } else {
+            size_t victim = (seed >> 4) % live.size();
+            heap.free(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+
+        if(i % 1000 == 0) ok = ok && matchesWalk(heap);
+    }
+
+    if(ok && matchesWalk(heap)) {
+        std::cout << "✓ Live, free and OS bytes match the heap through alloc, calloc, allocAligned, realloc and free\n";
+    } else {
+        std::cout << "✗ Gauges drifted from the heap\n";
+    }
+
+    for(word_t* data : live) heap.free(data);
+    AllocStats stats = heap.getStats();
+    if(stats.liveBytes == 0 && stats.allocs == stats.frees && stats.allocs >= calls) {
+        std::cout << "✓ Every alloc matched by a free, nothing live at the end\n";
+    } else {
+        std::cout << "✗ " << stats.allocs << " allocs, " << stats.frees << " frees, " << stats.liveBytes << " bytes live\n";
+    }
+
+    heap.trim();
+    if(matchesWalk(heap)) {
+        std::cout << "✓ Bytes given back by trim leave the OS byte count\n";
+    } else {
+        std::cout << "✗ OS bytes wrong after trim\n";
+    }
+}
+
+//alloc, allocAligned and free in random order on a heap without a free list of its own
+template<class Heap>
+bool churnMatchesWalk(Heap& heap) {
+    std::vector<word_t*> live;
+    unsigned seed = 5;
+    bool ok = true;
+
+    for(int i = 0; i < 5000; i++) {
+        seed = seed * 1103515245 + 12345;
+        size_t size = 8 + (seed >> 8) % 2000;
+        int kind = (seed >> 20) % 4;
+
+        if(kind == 0 || live.empty()) {
+            live.push_back(heap.alloc(size));
+        } else if(kind == 1) {
+            live.push_back(heap.allocAligned(size, 64 << ((seed >> 4) % 4)));
+        } else {
+            size_t victim = (seed >> 4) % live.size();
+            heap.free(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+
+        if(i % 500 == 0) ok = ok && matchesWalk(heap);
+    }
+
+    for(word_t* data : live) heap.free(data);
+    AllocStats stats = heap.getStats();
+    return ok && matchesWalk(heap) && stats.liveBytes == 0 && stats.allocs == stats.frees;
+}
+
+void testOtherHeaps() {
+    printSeparator("Testing Implicit, TLSF, Bump and Region Counters");
+
+    ImplicitAllocator implicit;
+    ImplicitAllocator indexed;
+    indexed.indexFreeBlocks = true;
+    indexed.searchMode = ImplicitAllocator::SearchMode::BestFit;
+    TlsfAllocator tlsf;
+    BumpAllocator bump;
+    if(churnMatchesWalk(implicit) && churnMatchesWalk(indexed) && churnMatchesWalk(tlsf) && churnMatchesWalk(bump)) {
+        std::cout << "✓ Implicit, TLSF and bump gauges match a heap walk, every alloc matched by a free\n";
+    } else {
+        std::cout << "✗ Implicit, TLSF or bump gauges drifted from the heap\n";
+    }
+
+    //in place and moving reallocs on the implicit heap
+    word_t* a = implicit.alloc(100);
+    word_t* fence = implicit.alloc(16);
+    a = implicit.realloc(a, 40);
+    a = implicit.realloc(a, 4000);
+    implicit.free(fence);
+    AllocStats stats = implicit.getStats();
+    implicit.free(a);
+    if(stats.liveBytes == 4000 && matchesWalk(implicit) && implicit.getStats().liveBytes == 0) {
+        std::cout << "✓ Implicit reallocs keep the live bytes\n";
+    } else {
+        std::cout << "✗ " << stats.liveBytes << " bytes live after the reallocs\n";
+    }
+
+    RegionAllocator region;
+    for(int i = 0; i < 500; i++) region.alloc(100); //well inside the first chunk
+    RegionAllocator::Checkpoint mark = region.checkpoint();
+    for(int i = 0; i < 1000; i++) region.alloc(200);
+    AllocStats grown = region.getStats();
+    region.rewind(mark);
+    AllocStats rewound = region.getStats();
+    region.reset();
+    AllocStats empty = region.getStats();
+    if(grown.liveBytes >= 500 * 104 + 1000 * 200 && grown.osRequests == 3 &&
+       rewound.liveBytes == 500 * 104 && rewound.freeBlocks == 2 &&
+       empty.liveBytes == 0 && empty.freeBlocks == 3 && empty.freeBytes + 3 * 16 == empty.osBytes) {
+        std::cout << "✓ Region chunks counted, rewind and reset move their bytes to the spares\n";
+    } else {
+        std::cout << "✗ region live " << grown.liveBytes << "/" << rewound.liveBytes << "/" << empty.liveBytes
+                  << ", spares " << rewound.freeBlocks << "/" << empty.freeBlocks << "\n";
+    }
+}
+
+void testSegregatedBuckets() {
+    printSeparator("Testing Segregated Buckets");
+
+    SegregatedListAllocator heap;
+    std::vector<word_t*> live;
+    for(int i = 0; i < 100; i++) live.push_back(heap.alloc(24));  //slab class 2
+    for(int i = 0; i < 50; i++) live.push_back(heap.alloc(100));  //bucket 4
+    for(int i = 0; i < 20; i++) live.push_back(heap.alloc(1000)); //bucket 5
+    live.push_back(heap.alloc(256 * 1024));                       //mapped
+
+    AllocStats slab = heap.slabStats(2);
+    AllocStats small = heap.bucketStats(4);
+    AllocStats large = heap.bucketStats(5);
+    AllocStats mapped = heap.mapStats();
+    if(slab.allocs == 100 && slab.liveBytes == 100 * 32 && small.allocs == 50 && small.liveBytes == 50 * 128 &&
+       large.allocs == 20 && large.liveBytes == 20 * 1000 && mapped.allocs == 1 && mapped.osRequests == 1) {
+        std::cout << "✓ Requests counted in their slab class, bucket or as mapped\n";
+    } else {
+        std::cout << "✗ slab " << slab.allocs << "/" << slab.liveBytes << ", bucket 4 " << small.allocs << "/"
+                  << small.liveBytes << ", bucket 5 " << large.allocs << "/" << large.liveBytes
+                  << ", mapped " << mapped.allocs << "\n";
+    }
+
+    //sized frees, batch frees and plain frees all land in the same counters
+    for(int i = 0; i < 50; i++) heap.free(live[100 + i], 100);
+    heap.freeBatch(live.data(), 100);
+    heap.free(live[150]);
+    for(int i = 151; i < 171; i++) heap.free(live[i]);
+
+    small = heap.bucketStats(4);
+    AllocStats total = heap.getStats();
+    if(small.frees == 50 && small.freeBlocks == 50 && small.freeBytes == 50 * 128 &&
+       total.liveBytes == 0 && total.allocs == total.frees && heap.mapStats().osBytes == 0) {
+        std::cout << "✓ Sized, batched and plain frees counted, nothing live at the end\n";
+    } else {
+        std::cout << "✗ bucket 4 frees " << small.frees << ", free blocks " << small.freeBlocks
+                  << ", live " << total.liveBytes << "\n";
+    }
+
+    //a batch from the free list and one fresh block, then aligned and resized blocks
+    word_t* batch[64];
+    size_t got = heap.allocBatch(100, 64, batch);
+    word_t* aligned = heap.allocAligned(200, 256);
+    word_t* grown = heap.realloc(heap.alloc(300), 5000);
+    word_t* shrunk = heap.realloc(heap.alloc(4000), 500);
+    AllocStats before = heap.getStats();
+    heap.freeBatch(batch, got);
+    heap.free(aligned);
+    heap.free(grown);
+    heap.free(shrunk);
+    total = heap.getStats();
+    if(got == 64 && before.liveBytes >= 64 * 128 + 200 + 5000 + 500 && total.liveBytes == 0 &&
+       total.allocs == total.frees) {
+        std::cout << "✓ Batches, aligned blocks and reallocs balance out\n";
+    } else {
+        std::cout << "✗ " << total.liveBytes << " bytes still live after freeing everything\n";
+    }
+}
+
+void testArenaScrape() {
+    printSeparator("Testing Scraping While Allocating");
+
+    ArenaAllocator arenas(4);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> workers;
+
+    for(int t = 0; t < 4; t++) {
+        workers.emplace_back([&arenas, t] {
+            std::vector<word_t*> live;
+            unsigned seed = t + 1;
+            for(int i = 0; i < 50000; i++) {
+                seed = seed * 1103515245 + 12345;
+                if(live.size() < 256 || (seed >> 16) % 2) {
+                    live.push_back(arenas.alloc(8 + (seed >> 8) % 2000));
+                } else {
+                    size_t victim = (seed >> 4) % live.size();
+                    arenas.free(live[victim]);
+                    live[victim] = live.back();
+                    live.pop_back();
+                }
+            }
+            for(word_t* data : live) arenas.free(data);
+        });
+    }
+
+    //the scraper never takes an arena lock
+    uint64_t scrapes = 0;
+    std::vector<char> buffer(64 * 1024);
+    std::thread scraper([&] {
+        while(!done.load()) {
+            arenas.getStats();
+            arenas.statsJson(buffer.data(), buffer.size());
+            scrapes++;
+        }
+    });
+
+    for(std::thread& worker : workers) worker.join();
+    done = true;
+    scraper.join();
+
+    arenas.trim(); //collects the remote frees still pending
+    AllocStats total = arenas.getStats();
+    if(scrapes > 0 && total.liveBytes == 0 && total.allocs > 0 && total.allocs == total.frees) {
+        std::cout << "✓ " << scrapes << " scrapes during the run, counts balance once the threads are done\n";
+    } else {
+        std::cout << "✗ " << total.allocs << " allocs, " << total.frees << " frees, "
+                  << total.liveBytes << " bytes live after the run\n";
+    }
+}
+
+void testJson() {
+    printSeparator("Testing JSON Dump");
+
+    SegregatedListAllocator heap;
+    word_t* small = heap.alloc(16);
+    word_t* medium = heap.alloc(500);
+
+    char buffer[8192];
+    size_t length = heap.statsJson(buffer, sizeof(buffer));
+    std::string json(buffer);
+
+    int depth = 0;
+    bool balanced = true;
+    for(char c : json) {
+        if(c == '{' || c == '[') depth++;
+        if(c == '}' || c == ']') depth--;
+        balanced = balanced && depth >= 0;
+    }
+    bool hasKeys = json.find("\"total\":{\"allocs\":2,") == 1 && json.find("\"buckets\":[") != std::string::npos &&
+                   json.find("\"slabs\":[") != std::string::npos && json.find("\"mapped\":{") != std::string::npos &&
+                   json.find("\"fragmentation\":0.") != std::string::npos;
+    if(length == json.size() && balanced && depth == 0 && hasKeys) {
+        std::cout << "✓ One balanced object with totals, buckets, slab classes and mapped blocks\n";
+    } else {
+        std::cout << "✗ Malformed stats: " << json << "\n";
+    }
+
+    char tiny[32];
+    memset(tiny, 'x', sizeof(tiny));
+    size_t needed = heap.statsJson(tiny, sizeof(tiny));
+    if(needed == length && strlen(tiny) == sizeof(tiny) - 1 && json.compare(0, sizeof(tiny) - 1, tiny) == 0) {
+        std::cout << "✓ A short buffer gets a terminated prefix and the length it needed\n";
+    } else {
+        std::cout << "✗ Short buffer: needed " << needed << " of " << length << "\n";
+    }
+
+    heap.free(small);
+    heap.free(medium);
+}
+
+int main() {
+    std::cout << "Starting Allocator Statistics Tests\n";
+    std::cout << "===================================\n";
+
+    testExplicitCounters();
+    testExplicitGauges();
+    testOtherHeaps();
+    testSegregatedBuckets();
+    testArenaScrape();
+    testJson();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
+#include "alloc_trace.h"
+#include "explicit_allocator.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+std::string tracePath(const char* name) {
+    return "/tmp/alloc_trace_" + std::to_string(getpid()) + "_" + name;
+}
+
+//fake addresses are fine, the recorder never touches the memory
+const void* at(uintptr_t address) {
+    return reinterpret_cast<const void*>(address);
+}
+
+std::vector<TraceEvent> readAll(const std::string& path, bool* truncated = nullptr) {
+    std::vector<TraceEvent> events;
+    TraceReader reader;
+    if(!reader.open(path.c_str())) return events;
+
+    TraceEvent event;
+    while(reader.next(event)) events.push_back(event);
+    if(truncated) *truncated = reader.truncated();
+    return events;
+}
+
+void testRoundTrip() {
+    printSeparator("Testing Record & Read Back");
+
+    std::string path = tracePath("round_trip");
+    TraceRecorder recorder;
+    if(!recorder.open(path.c_str())) {
+        std::cout << "✗ Could not create " << path << "\n";
+        return;
+    }
+
+    recorder.recordAlloc(at(0x1000), 100, 0, 0);
+    recorder.recordAlloc(at(0x2000), 2000, 64, 0);
+    recorder.recordFree(at(0x1000), 1);
+    recorder.recordAlloc(at(0x3000), 24, 0, 1);          //takes the id 0x1000 had
+    recorder.recordRealloc(at(0x2000), at(0x9000), 5000, 1);
+    recorder.recordFree(at(0x3000), 0);
+    recorder.recordFree(at(0x9000), 0);
+    recorder.close();
+
+    std::vector<TraceEvent> events = readAll(path);
+    bool ok = events.size() == 7
+        && events[0].op == TraceOp::Alloc && events[0].object == 0 && events[0].size == 100 && events[0].alignment == 0
+        && events[1].op == TraceOp::Alloc && events[1].object == 1 && events[1].size == 2000 && events[1].alignment == 64
+        && events[2].op == TraceOp::Free && events[2].object == 0 && events[2].thread == 1
+        && events[3].op == TraceOp::Alloc && events[3].object == 0 && events[3].size == 24 && events[3].thread == 1
+        && events[4].op == TraceOp::Realloc && events[4].object == 1 && events[4].size == 5000
+        && events[5].op == TraceOp::Free && events[5].object == 0 && events[5].thread == 0
+        && events[6].op == TraceOp::Free && events[6].object == 1;
+    if(ok) {
+        std::cout << "✓ Ops, sizes, alignment, threads and object ids read back\n";
+    } else {
+        std::cout << "✗ Trace read back wrong (" << events.size() << " events)\n";
+    }
+
+    bool ordered = !events.empty();
+    for(size_t i = 1; i < events.size(); i++) ordered = ordered && events[i].time >= events[i - 1].time;
+    if(ordered) {
+        std::cout << "✓ Timestamps never go backwards\n";
+    } else {
+        std::cout << "✗ Timestamps out of order\n";
+    }
+
+    std::remove(path.c_str());
+}
+
+void testUnknownPointers() {
+    printSeparator("Testing Unknown Pointers");
+
+    std::string path = tracePath("unknown");
+    TraceRecorder recorder;
+    recorder.open(path.c_str());
+
+    recorder.recordFree(at(0x5000), 0);                    //never allocated
+    recorder.recordRealloc(at(0x6000), at(0x7000), 64, 0); //resized without a recorded alloc
+    recorder.recordAlloc(at(0x7000), 32, 0, 0);            //handed out again without a free
+    recorder.close();
+
+    std::vector<TraceEvent> events = readAll(path);
+    if(events.size() == 3 && events[0].op == TraceOp::Alloc && events[0].size == 64
+       && events[1].op == TraceOp::Free && events[1].object == 0
+       && events[2].op == TraceOp::Alloc && events[2].object == 0) {
+        std::cout << "✓ Unknown frees skipped, unknown reallocs become allocs, reused addresses end the old object\n";
+    } else {
+        std::cout << "✗ Unknown pointers recorded wrong (" << events.size() << " events)\n";
+    }
+
+    std::remove(path.c_str());
+}
+
+void testCompactness() {
+    printSeparator("Testing Compactness");
+
+    std::string path = tracePath("compact");
+    TraceRecorder recorder;
+    recorder.open(path.c_str());
+
+    //a window of 1000 live objects churned by 4 threads, addresses spread like a heap's
+    const int EVENTS = 200000;
+    std::vector<uintptr_t> live(1000, 0);
+    unsigned seed = 7;
+    uintptr_t next = 0x10000;
+    for(int i = 0; i < EVENTS / 2; i++) {
+        seed = seed * 1103515245 + 12345;
+        uintptr_t& slot = live[(seed >> 8) % live.size()];
+        uint32_t thread = (seed >> 20) % 4;
+        if(slot) recorder.recordFree(at(slot), thread);
+        slot = next;
+        next += 16 + ((seed >> 12) % 64) * 16;
+        recorder.recordAlloc(at(slot), 16 + (seed >> 4) % 1000, 0, thread);
+    }
+    uint64_t records = recorder.records();
+    recorder.close();
+
+    bool truncated = true;
+    std::vector<TraceEvent> events = readAll(path, &truncated);
+    FILE* file = std::fopen(path.c_str(), "rb");
+    std::fseek(file, 0, SEEK_END);
+    double bytesPerEvent = (double)std::ftell(file) / records;
+    std::fclose(file);
+
+    if(events.size() == records && !truncated && bytesPerEvent < 8) {
+        std::cout << "✓ " << records << " records at " << bytesPerEvent << " bytes each, all read back\n";
+    } else {
+        std::cout << "✗ " << events.size() << "/" << records << " records read back, " << bytesPerEvent << " bytes each\n";
+    }
+
+    uint64_t highest = 0;
+    for(const TraceEvent& event : events) highest = std::max(highest, event.object);
+    if(highest < live.size()) {
+        std::cout << "✓ Object ids stay within the live set\n";
+    } else {
+        std::cout << "✗ Object ids grew to " << highest << "\n";
+    }
+
+    std::remove(path.c_str());
+}
+
+void testTruncated() {
+    printSeparator("Testing Truncated Trace");
+
+    std::string path = tracePath("truncated");
+    TraceRecorder recorder;
+    recorder.open(path.c_str());
+    for(int i = 0; i < 100; i++) recorder.recordAlloc(at(0x1000 + i * 64), 1000000 + i, 0, 0);
+    recorder.close();
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fclose(file);
+    if(truncate(path.c_str(), size - 2) != 0) {
+        std::cout << "✗ Could not cut the trace\n";
+        return;
+    }
+
+    bool truncated = false;
+    std::vector<TraceEvent> events = readAll(path, &truncated);
+    if(events.size() == 99 && truncated && events[98].size == 1000098) {
+        std::cout << "✓ Reading stops at the cut record, the ones before it intact\n";
+    } else {
+        std::cout << "✗ Truncated trace read as " << events.size() << " events\n";
+    }
+
+    TraceReader reader;
+    std::FILE* garbage = std::fopen(path.c_str(), "wb");
+    std::fputs("not a trace", garbage);
+    std::fclose(garbage);
+    if(!reader.open(path.c_str()) && !reader.open("/nonexistent/trace")) {
+        std::cout << "✓ Files without the trace header rejected\n";
+    } else {
+        std::cout << "✗ Garbage accepted as a trace\n";
+    }
+
+    std::remove(path.c_str());
+}
+
+void testReplay() {
+    printSeparator("Testing Deterministic Replay");
+
+    std::string path = tracePath("replay");
+    TraceRecorder recorder;
+    recorder.open(path.c_str());
+
+    //recorded from two threads, the replay runs them in recorded order
+    std::vector<uintptr_t> live;
+    unsigned seed = 3;
+    for(int i = 0; i < 5000; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t thread = i % 2;
+        if(!live.empty() && (seed >> 16) % 3 == 0) {
+            size_t victim = (seed >> 4) % live.size();
+            recorder.recordFree(at(live[victim]), thread);
+            live[victim] = live.back();
+            live.pop_back();
+        } else if(!live.empty() && (seed >> 16) % 3 == 1) {
+            size_t victim = (seed >> 4) % live.size();
+            uintptr_t moved = 0x100000 + i * 4096;
+            recorder.recordRealloc(at(live[victim]), at(moved), 32 + (seed >> 8) % 2000, thread);
+            live[victim] = moved;
+        } else {
+            live.push_back(0x100000 + i * 4096);
+            recorder.recordAlloc(at(live.back()), 16 + (seed >> 8) % 500, 0, thread);
+        }
+    }
+    recorder.close();
+
+    //replays the trace on a fresh ExplicitAllocator, returns the address of every call
+    auto replay = [&path](bool& consistent) {
+        std::vector<uintptr_t> addresses;
+        ExplicitAllocator heap;
+        TraceReader reader;
+        reader.open(path.c_str());
+
+        std::vector<word_t*> objects;
+        TraceEvent event;
+        consistent = true;
+        while(reader.next(event)) {
+            if(event.object >= objects.size()) objects.resize(event.object + 1, nullptr);
+            word_t*& object = objects[event.object];
+
+            if(event.op == TraceOp::Alloc) {
+                consistent = consistent && object == nullptr;
+                object = heap.alloc(event.size);
+            } else if(event.op == TraceOp::Free) {
+                consistent = consistent && object != nullptr;
+                heap.free(object);
+                object = nullptr;
+            } else {
+                consistent = consistent && object != nullptr;
+                object = heap.realloc(object, event.size);
+            }
+            addresses.push_back((uintptr_t)object);
+        }
+        return addresses;
+    };
+
+    bool firstConsistent, secondConsistent;
+    std::vector<uintptr_t> first = replay(firstConsistent);
+    std::vector<uintptr_t> second = replay(secondConsistent);
+    if(firstConsistent && secondConsistent) {
+        std::cout << "✓ Every free and realloc names a live object, every alloc a free id\n";
+    } else {
+        std::cout << "✗ Replay referenced dead or live objects wrongly\n";
+    }
+
+    std::vector<uintptr_t> firstOffsets, secondOffsets;
+    for(uintptr_t address : first) firstOffsets.push_back(address ? address - first[0] : 0);
+    for(uintptr_t address : second) secondOffsets.push_back(address ? address - second[0] : 0);
+    if(!first.empty() && firstOffsets == secondOffsets) {
+        std::cout << "✓ Two replays lay out the heap identically\n";
+    } else {
+        std::cout << "✗ Replays diverged\n";
+    }
+
+    std::remove(path.c_str());
+}
+
+int main() {
+    std::cout << "Starting Allocation Trace Tests\n";
+    std::cout << "===============================\n";
+
+    testRoundTrip();
+    testUnknownPointers();
+    testCompactness();
+    testTruncated();
+    testReplay();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
@@ -0,0 +1,362 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include "arena_allocator.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+void testBasicAllocation() {
+    printSeparator("Testing Basic Allocation");
+
+    ArenaAllocator allocator(4);
+
+    word_t* ptr8 = allocator.alloc(8);       //slab run
+    word_t* ptr128 = allocator.alloc(128);   //bucket
+    word_t* ptr1k = allocator.alloc(1024);   //large bucket
+    word_t* ptrBig = allocator.alloc(256 * 1024); //own mapping
+
+    if(ptr8 && ptr128 && ptr1k && ptrBig) {
+        std::cout << "✓ Slab, bucket and mapped allocations successful\n";
+    } else {
+        std::cout << "✗ Some allocations failed\n";
+    }
+
+    *ptr8 = 1; *ptr128 = 2; *ptr1k = 3; *ptrBig = 4;
+    if(*ptr8 == 1 && *ptr128 == 2 && *ptr1k == 3 && *ptrBig == 4) {
+        std::cout << "✓ Memory write/read successful\n";
+    } else {
+        std::cout << "✗ Memory write/read failed\n";
+    }
+
+    int arena = allocator.currentArena();
+    if(allocator.arenaOf(ptr8) == arena && allocator.arenaOf(ptr1k) == arena) {
+        std::cout << "✓ Blocks come from the calling thread's arena\n";
+    } else {
+        std::cout << "✗ Blocks landed in another arena\n";
+    }
+
+    if(allocator.arenaOf(ptrBig) == -1) {
+        std::cout << "✓ Mapped block belongs to no arena\n";
+    } else {
+        std::cout << "✗ Mapped block was attributed to an arena\n";
+    }
+
+    allocator.free(ptr8);
+    allocator.free(ptr128);
+    allocator.free(ptr1k);
+    allocator.free(ptrBig);
+    std::cout << "✓ All deallocations completed\n";
+}
+
+void testArenaCount() {
+    printSeparator("Testing Arena Count");
+
+    ArenaAllocator perCpu;
+    if(perCpu.arenaCount() >= 1 && perCpu.arenaCount() <= ArenaAllocator::MAX_ARENAS) {
+        std::cout << "✓ One arena per CPU (" << perCpu.arenaCount() << ")\n";
+    } else {
+        std::cout << "✗ Unexpected arena count " << perCpu.arenaCount() << "\n";
+    }
+
+    ArenaAllocator capped(1000);
+    if(capped.arenaCount() == ArenaAllocator::MAX_ARENAS) {
+        std::cout << "✓ Arena count capped at " << ArenaAllocator::MAX_ARENAS << "\n";
+    } else {
+        std::cout << "✗ Arena count not capped\n";
+    }
+}
+
+void testRoundRobin() {
+    printSeparator("Testing Round Robin Selection");
+
+    const int NUM_THREADS = 4;
+    ArenaAllocator allocator(NUM_THREADS, ArenaAllocator::Selection::RoundRobin);
+    std::vector<int> used(NUM_THREADS, 0);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&allocator, &used]() {
+            word_t* ptr = allocator.alloc(32);
+            used[allocator.arenaOf(ptr)]++;
+            allocator.free(ptr);
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    int distinct = 0;
+    for(int count : used) distinct += (count > 0);
+
+    if(distinct == NUM_THREADS) {
+        std::cout << "✓ " << NUM_THREADS << " threads spread over " << distinct << " arenas\n";
+    } else {
+        std::cout << "✗ " << NUM_THREADS << " threads shared " << distinct << " arenas\n";
+    }
+}
+
+void testCrossThreadFree() {
+    printSeparator("Testing Cross-Thread Free");
+
+    ArenaAllocator allocator(2, ArenaAllocator::Selection::RoundRobin);
+    word_t* small = nullptr;
+    word_t* large = nullptr;
+    int owner = -1;
+
+    std::thread producer([&]() {
+        small = allocator.alloc(48);
+        large = allocator.alloc(2048);
+        owner = allocator.arenaOf(small);
+    });
+    producer.join();
+
+    //freed from another thread, the blocks must return to the producer's arena
+    std::thread consumer([&]() {
+        allocator.free(small);
+        allocator.free(large);
+    });
+    consumer.join();
+
+    bool reused = false;
+
+    //new threads draw consecutive tickets, one of them lands on the owning arena
+    for(int t = 0; t < 4 && !reused; t++) {
+        std::thread probe([&]() {
+            if(allocator.currentArena() != owner) return;
+            word_t* ptr = allocator.alloc(2048);
+            reused = (ptr == large);
+            allocator.free(ptr);
+        });
+        probe.join();
+    }
+
+    if(reused) {
+        std::cout << "✓ Block freed by another thread reused by its own arena\n";
+    } else {
+        std::cout << "✗ Block freed by another thread was not returned to its arena\n";
+    }
+}
+
+void testRemoteFree() {
+    printSeparator("Testing Remote Free List");
+
+    ArenaAllocator allocator(2, ArenaAllocator::Selection::RoundRobin);
+    std::atomic<int> stage{0};
+    word_t* first = nullptr;
+    bool reused = false;
+
+    //two threads draw consecutive tickets, so they own different arenas
+    std::thread owner([&]() {
+        first = allocator.alloc(2048);
+        stage = 1;
+        while(stage != 2) std::this_thread::yield();
+
+        //the block waits on the remote list until this allocation collects it
+        word_t* second = allocator.alloc(2048);
+        reused = (second == first);
+        allocator.free(second);
+    });
+    std::thread foreign([&]() {
+        while(stage != 1) std::this_thread::yield();
+        allocator.free(first);
+        stage = 2;
+    });
+    owner.join();
+    foreign.join();
+
+    if(reused) {
+        std::cout << "✓ Remotely freed block collected by the owner's next allocation\n";
+    } else {
+        std::cout << "✗ Remotely freed block was not collected\n";
+    }
+}
+
+void testProducerConsumer() {
+    printSeparator("Testing Producer/Consumer Frees");
+
+    ArenaAllocator allocator(4, ArenaAllocator::Selection::RoundRobin);
+    const int NUM_PAIRS = 2;
+    const int MESSAGES = 50000;
+    std::atomic<int> corrupted{0};
+    std::atomic<int> failed{0};
+
+    struct Channel {
+        std::mutex lock;
+        std::deque<word_t*> queue;
+    };
+    Channel channels[NUM_PAIRS];
+
+    std::vector<std::thread> threads;
+    for(int p = 0; p < NUM_PAIRS; p++) {
+        threads.emplace_back([&, p]() {
+            for(int i = 0; i < MESSAGES; i++) {
+                word_t* msg = allocator.alloc(16 + (i % 12) * 40);
+                if(!msg) { failed++; continue; }
+                msg[0] = p;
+                msg[1] = i;
+                std::lock_guard<std::mutex> guard(channels[p].lock);
+                channels[p].queue.push_back(msg);
+            }
+            std::lock_guard<std::mutex> guard(channels[p].lock);
+            channels[p].queue.push_back(nullptr); //end of stream
+        });
+        threads.emplace_back([&, p]() {
+            for(int expected = 0;;) {
+                word_t* msg = nullptr;
+                bool received = false;
+                {
+                    std::lock_guard<std::mutex> guard(channels[p].lock);
+                    if(!channels[p].queue.empty()) {
+                        msg = channels[p].queue.front();
+                        channels[p].queue.pop_front();
+                        received = true;
+                    }
+                }
+                if(!received) { std::this_thread::yield(); continue; }
+                if(!msg) break;
+                if(msg[0] != p || msg[1] < expected) corrupted++;
+                expected = msg[1];
+                allocator.free(msg);
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    if(failed == 0 && corrupted == 0) {
+        std::cout << "✓ " << NUM_PAIRS * MESSAGES << " messages freed by their consumers intact\n";
+    } else {
+        std::cout << "✗ " << failed << " allocations failed, " << corrupted << " messages corrupted\n";
+    }
+}
+
+void testCalloc() {
+    printSeparator("Testing Calloc");
+
+    ArenaAllocator allocator(2);
+
+    word_t* dirty = allocator.alloc(512);
+    for(int i = 0; i < 64; i++) dirty[i] = ~word_t(0);
+    allocator.free(dirty);
+
+    word_t* ptr = allocator.calloc(64, sizeof(word_t));
+    bool zero = ptr != nullptr;
+    for(int i = 0; zero && i < 64; i++) zero = (ptr[i] == 0);
+
+    if(zero) {
+        std::cout << "✓ Recycled block cleared\n";
+    } else {
+        std::cout << "✗ Calloc returned dirty memory\n";
+    }
+
+    allocator.free(ptr);
+}
+
+void testAlignedAllocation() {
+    printSeparator("Testing Aligned Allocation");
+
+    ArenaAllocator allocator(2);
+
+    word_t* small = allocator.allocAligned(24, 32);
+    word_t* large = allocator.allocAligned(300, 256);
+    if(small && large && (uintptr_t)small % 32 == 0 && (uintptr_t)large % 256 == 0 &&
+       allocator.arenaOf(large) >= 0) {
+        std::cout << "✓ Aligned blocks come from an arena\n";
+    } else {
+        std::cout << "✗ Aligned allocation failed\n";
+    }
+
+    allocator.free(small);
+    allocator.free(large);
+}
+
+void testRealloc() {
+    printSeparator("Testing Realloc");
+
+    ArenaAllocator allocator(2);
+
+    word_t* ptr = allocator.alloc(64);
+    for(int i = 0; i < 8; i++) ptr[i] = i;
+
+    ptr = allocator.realloc(ptr, 4096);
+    bool kept = ptr != nullptr;
+    for(int i = 0; kept && i < 8; i++) kept = (ptr[i] == (word_t)i);
+
+    ptr = allocator.realloc(ptr, 512 * 1024); //moves into a mapping
+    for(int i = 0; kept && i < 8; i++) kept = (ptr[i] == (word_t)i);
+
+    if(kept && allocator.usableSize(ptr) >= 512 * 1024) {
+        std::cout << "✓ Contents kept across arena and mapped growth\n";
+    } else {
+        std::cout << "✗ Realloc lost data\n";
+    }
+
+    allocator.free(ptr);
+}
+
+void testMultipleThreads() {
+    printSeparator("Testing Multiple Threads");
+
+    ArenaAllocator allocator(4, ArenaAllocator::Selection::RoundRobin);
+    std::atomic<int> corrupted{0};
+    std::atomic<int> failed{0};
+    const int NUM_THREADS = 8;
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&allocator, &corrupted, &failed, t]() {
+            std::vector<word_t*> live;
+            for(int i = 0; i < 20000; i++) {
+                size_t size = 8 + (i * 7 + t) % 600;
+                word_t* ptr = allocator.alloc(size);
+                if(!ptr) { failed++; continue; }
+                *ptr = t * 1000000 + i;
+                live.push_back(ptr);
+                if(live.size() > 64) {
+                    word_t* victim = live[i % live.size()];
+                    live[i % live.size()] = live.back();
+                    live.pop_back();
+                    allocator.free(victim);
+                }
+            }
+            for(word_t* ptr : live) {
+                if(*ptr / 1000000 != (word_t)t) corrupted++;
+                allocator.free(ptr);
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    if(failed == 0) {
+        std::cout << "✓ All allocations from " << NUM_THREADS << " threads successful\n";
+    } else {
+        std::cout << "✗ " << failed << " allocations failed\n";
+    }
+
+    if(corrupted == 0) {
+        std::cout << "✓ No block shared between threads\n";
+    } else {
+        std::cout << "✗ " << corrupted << " blocks were overwritten by another thread\n";
+    }
+}
+
+int main() {
+    std::cout << "Starting Arena Allocator Tests\n";
+    std::cout << "==============================\n";
+
+    testBasicAllocation();
+    testArenaCount();
+    testRoundRobin();
+    testCrossThreadFree();
+    testRemoteFree();
+    testProducerConsumer();
+    testCalloc();
+    testAlignedAllocation();
+    testRealloc();
+    testMultipleThreads();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
\ No newline at end of file
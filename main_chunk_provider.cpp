@@ -0,0 +1,190 @@
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include "chunk_provider.h"
+#include "bump_allocator.h"
+#include "explicit_allocator.h"
+#include "implicit_allocator.h"
+#include "segregated_allocator.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+void testMmapContiguity() {
+    printSeparator("Testing Mmap Reserve/Commit");
+
+    MmapChunkProvider provider(64 * 1024 * 1024);
+
+    char* first = (char*)provider.extend(40);
+    char* second = (char*)provider.extend(100000); //crosses the first commit chunk
+    char* third = (char*)provider.extend(8);
+
+    if(first && second && third) {
+        std::cout << "✓ Extensions successful\n";
+    } else {
+        std::cout << "✗ Extension failed\n";
+        return;
+    }
+
+    if(second == first + 40 && third == second + 100000) {
+        std::cout << "✓ Extensions are contiguous\n";
+    } else {
+        std::cout << "✗ Extensions are not contiguous\n";
+    }
+
+    second[99999] = 'x';
+    std::cout << "✓ Committed memory is writable\n";
+
+    if(provider.extend(64 * 1024 * 1024) == nullptr) {
+        std::cout << "✓ Extension past the reservation refused\n";
+    } else {
+        std::cout << "✗ Extension past the reservation succeeded\n";
+    }
+}
+
+void testMmapRelease() {
+    printSeparator("Testing Mmap Release");
+
+    MmapChunkProvider provider(64 * 1024 * 1024);
+
+    char* first = (char*)provider.extend(100);
+    char* second = (char*)provider.extend(1024 * 1024);
+    memset(second, 0xAB, 1024 * 1024);
+
+    if(second == first + 100 && provider.release(1024 * 1024) && provider.extend(0) == second) {
+        std::cout << "✓ Released bytes come off the end\n";
+    } else {
+        std::cout << "✗ Release did not move the end back\n";
+    }
+
+    //regrown memory must read as zero again, including the rest of the kept page
+    char* again = (char*)provider.extend(1024 * 1024);
+    bool zero = (again == second);
+    for(size_t i = 0; zero && i < 1024 * 1024; i += 512) zero = (again[i] == 0);
+
+    if(zero) {
+        std::cout << "✓ Memory handed out again reads as zero\n";
+    } else {
+        std::cout << "✗ Released memory came back dirty\n";
+    }
+
+    if(!provider.release(2 * 1024 * 1024) && provider.extend(0) == again + 1024 * 1024) {
+        std::cout << "✓ Release past the start refused\n";
+    } else {
+        std::cout << "✗ Released more than was handed out\n";
+    }
+}
+
+void testBufferProvider() {
+    printSeparator("Testing Buffer Provider");
+
+    alignas(16) static char buffer[4096];
+    BufferChunkProvider provider(buffer, sizeof(buffer));
+    ExplicitAllocator allocator(&provider);
+
+    std::vector<word_t*> ptrs;
+    while(word_t* ptr = allocator.alloc(64)) {
+        ptrs.push_back(ptr);
+    }
+
+    bool inside = true;
+    for(word_t* ptr : ptrs) {
+        if((char*)ptr < buffer || (char*)ptr + 64 > buffer + sizeof(buffer)) inside = false;
+    }
+
+    if(!ptrs.empty() && inside) {
+        std::cout << "✓ " << ptrs.size() << " blocks carved from the user buffer\n";
+    } else {
+        std::cout << "✗ Blocks escaped the user buffer\n";
+    }
+
+    allocator.free(ptrs[0]);
+    if(allocator.alloc(64) == ptrs[0]) {
+        std::cout << "✓ Freed block reused once the buffer is full\n";
+    } else {
+        std::cout << "✗ Freed block not reused\n";
+    }
+}
+
+void testSbrkProvider() {
+    printSeparator("Testing Sbrk Provider");
+
+    SbrkChunkProvider provider;
+    char* first = (char*)provider.extend(32);
+    char* second = (char*)provider.extend(32);
+
+    if(first && second == first + 32) {
+        std::cout << "✓ Extensions inside one chunk are contiguous\n";
+    } else {
+        std::cout << "✗ Sbrk extension failed\n";
+    }
+}
+
+void testAllAllocatorsUseProvider() {
+    printSeparator("Testing Allocators On A Shared Provider");
+
+    MmapChunkProvider provider;
+    BumpAllocator bump(&provider);
+    ImplicitAllocator implicitAllocator(&provider);
+    ExplicitAllocator explicitAllocator(&provider);
+    SegregatedListAllocator segregated(&provider);
+
+    char* start = (char*)provider.extend(0);
+    word_t* ptrs[] = {
+        bump.alloc(16), implicitAllocator.alloc(16),
+        explicitAllocator.alloc(16), segregated.alloc(16), segregated.alloc(1000)
+    };
+
+    bool inside = true;
+    for(word_t* ptr : ptrs) {
+        if(!ptr || (char*)ptr < start || (char*)ptr > start + 4096) inside = false;
+    }
+
+    if(inside) {
+        std::cout << "✓ Every allocator grew the supplied provider\n";
+    } else {
+        std::cout << "✗ Some allocator bypassed the provider\n";
+    }
+}
+
+void testPrivateHeaps() {
+    printSeparator("Testing Private Heaps");
+
+    //default allocators get their own range, so heavy churn in one
+    //can never coalesce into blocks owned by another
+    ExplicitAllocator first;
+    ExplicitAllocator second;
+    std::vector<std::pair<ExplicitAllocator*, word_t*>> live;
+
+    for(int i = 0; i < 20000; i++) {
+        ExplicitAllocator* allocator = (i % 2) ? &first : &second;
+        word_t* ptr = allocator->alloc(8 + (i * 7) % 200);
+        *ptr = i;
+        live.push_back({allocator, ptr});
+
+        if(live.size() > 64) {
+            size_t victim = (i * 31) % live.size();
+            live[victim].first->free(live[victim].second);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+
+    std::cout << "✓ Interleaved churn across two allocators completed\n";
+}
+
+int main() {
+    std::cout << "Starting Chunk Provider Tests\n";
+    std::cout << "=============================\n";
+
+    testMmapContiguity();
+    testMmapRelease();
+    testBufferProvider();
+    testSbrkProvider();
+    testAllAllocatorsUseProvider();
+    testPrivateHeaps();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
\ No newline at end of file
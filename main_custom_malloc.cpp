@@ -0,0 +1,473 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <fstream>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "alloc_trace.h"
+
+//linked together with src/custom_malloc.cpp, so every allocation in this program,
+//including the ones made inside libc and libstdc++, goes through the replacement
+
+extern "C" size_t customalloc_stats(char* buffer, size_t capacity) noexcept;
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+bool aligned(const void* ptr, size_t alignment) {
+    return (uintptr_t)ptr % alignment == 0;
+}
+
+void testMallocFree() {
+    printSeparator("Testing malloc/free");
+
+    //a 20-byte request lands in the 32-byte slab class, glibc would report 24
+    void* small = malloc(20);
+    if(small && malloc_usable_size(small) == 32) {
+        std::cout << "✓ malloc served by the custom heap\n";
+    } else {
+        std::cout << "✗ malloc not replaced (usable size " << malloc_usable_size(small) << ")\n";
+    }
+    free(small);
+
+    bool ok = true;
+    std::vector<void*> ptrs;
+    for(size_t size = 0; size < 4096; size += 7) {
+        void* ptr = malloc(size);
+        if(!ptr || !aligned(ptr, size > 8 ? 16 : 8) || malloc_usable_size(ptr) < size) ok = false;
+        memset(ptr, 0x5A, size);
+        ptrs.push_back(ptr);
+    }
+    for(void* ptr : ptrs) free(ptr);
+
+    void* big = malloc(1 << 20);
+    if(!big || !aligned(big, 16)) ok = false;
+    free(big);
+    free(nullptr);
+
+    if(ok) {
+        std::cout << "✓ Sizes 0..4 KB and 1 MB 16-byte aligned with enough usable space\n";
+    } else {
+        std::cout << "✗ Bad pointer, alignment or usable size\n";
+    }
+}
+
+void testCalloc() {
+    printSeparator("Testing calloc");
+
+    //dirty some memory first so that recycled blocks are really reused
+    for(size_t size : {48, 200, 5000}) {
+        void* dirty = malloc(size);
+        memset(dirty, 0xFF, size);
+        free(dirty);
+    }
+
+    bool zero = true;
+    for(size_t size : {48, 200, 5000, 300000}) {
+        unsigned char* ptr = (unsigned char*)calloc(1, size);
+        if(!ptr || !aligned(ptr, 16)) zero = false;
+        for(size_t i = 0; ptr && i < size; i++) if(ptr[i]) zero = false;
+        free(ptr);
+    }
+
+    if(zero) {
+        std::cout << "✓ calloc memory reads as zero\n";
+    } else {
+        std::cout << "✗ calloc returned dirty or misaligned memory\n";
+    }
+
+    errno = 0;
+    volatile size_t count = SIZE_MAX / 2; //kept opaque so the compiler does not reject the call
+    if(calloc(count, 4) == nullptr && errno == ENOMEM) {
+        std::cout << "✓ Overflowing calloc fails with ENOMEM\n";
+    } else {
+        std::cout << "✗ Overflowing calloc did not fail\n";
+    }
+}
+
+void testRealloc() {
+    printSeparator("Testing realloc");
+
+    //grow from a slab object through heap blocks into a mapping and back down
+    char* ptr = (char*)malloc(10);
+    memcpy(ptr, "0123456789", 10);
+
+    bool kept = true;
+    size_t sizes[] = {60, 100, 1000, 70000, 500000, 2000000, 3000, 40};
+    for(size_t size : sizes) {
+        ptr = (char*)realloc(ptr, size);
+        if(!ptr || !aligned(ptr, 16) || memcmp(ptr, "0123456789", 10) != 0) kept = false;
+        if(ptr && malloc_usable_size(ptr) < size) kept = false;
+    }
+
+    if(kept) {
+        std::cout << "✓ Contents and alignment kept from 10 bytes to 2 MB and back\n";
+    } else {
+        std::cout << "✗ realloc lost contents or alignment\n";
+    }
+
+    //a failed realloc leaves the old block where it was
+    volatile size_t huge = SIZE_MAX - 100; //hidden from the compiler's size checks
+    errno = 0;
+    char* failed = (char*)realloc(ptr, huge);
+    if(failed) ptr = failed;
+    if(!failed && errno == ENOMEM && memcmp(ptr, "0123456789", 10) == 0) {
+        std::cout << "✓ Failed realloc reports ENOMEM and keeps the old block\n";
+    } else {
+        std::cout << "✗ Failed realloc lost the old block\n";
+    }
+
+    if(realloc(ptr, 0) == nullptr) {
+        std::cout << "✓ realloc to 0 frees\n";
+    }
+
+    char* fresh = (char*)realloc(nullptr, 100);
+    fresh[99] = 1;
+    free(fresh);
+}
+
+void testAlignedEntryPoints() {
+    printSeparator("Testing Aligned Allocation");
+
+    bool ok = true;
+    for(size_t alignment = 8; alignment <= 8192; alignment *= 2) {
+        for(size_t size : {1, 24, 64, 100, 5000, 200000}) {
+            void* a = nullptr;
+            if(posix_memalign(&a, alignment, size) != 0) ok = false;
+            void* b = aligned_alloc(alignment, size);
+            void* c = memalign(alignment, size);
+
+            for(void* ptr : {a, b, c}) {
+                if(!ptr || !aligned(ptr, alignment) || malloc_usable_size(ptr) < size) ok = false;
+                else memset(ptr, 0x33, size);
+            }
+            free(a);
+            free(b);
+            free(c);
+        }
+    }
+
+    if(ok) {
+        std::cout << "✓ posix_memalign/aligned_alloc/memalign for alignments 8..8192\n";
+    } else {
+        std::cout << "✗ Aligned allocation failed\n";
+    }
+
+    //page alignment is carved out of a free block, not padded by a page
+    void* carved = aligned_alloc(4096, 100);
+    if(aligned(carved, 4096) && malloc_usable_size(carved) < 256) {
+        std::cout << "✓ Page-aligned block holds no padding\n";
+    } else {
+        std::cout << "✗ Page-aligned block padded to " << malloc_usable_size(carved) << " bytes\n";
+    }
+    free(carved);
+
+    void* out = nullptr;
+    if(posix_memalign(&out, 24, 100) == EINVAL && posix_memalign(&out, 4, 100) == EINVAL) {
+        std::cout << "✓ Invalid alignments rejected with EINVAL\n";
+    } else {
+        std::cout << "✗ Invalid alignment accepted\n";
+    }
+
+    void* page = valloc(100);
+    void* rounded = pvalloc(100);
+    if(aligned(page, sysconf(_SC_PAGESIZE)) && aligned(rounded, sysconf(_SC_PAGESIZE)) &&
+       malloc_usable_size(rounded) >= (size_t)sysconf(_SC_PAGESIZE)) {
+        std::cout << "✓ valloc/pvalloc page aligned\n";
+    } else {
+        std::cout << "✗ valloc/pvalloc not page aligned\n";
+    }
+    free(page);
+    free(rounded);
+
+    //aligned memory grows through realloc with its contents
+    char* grown = (char*)aligned_alloc(256, 300);
+    memset(grown, 7, 300);
+    grown = (char*)realloc(grown, 100000);
+    if(grown && grown[299] == 7 && aligned(grown, 16)) {
+        std::cout << "✓ realloc of an aligned block keeps its contents\n";
+    } else {
+        std::cout << "✗ realloc of an aligned block failed\n";
+    }
+    free(grown);
+}
+
+struct alignas(64) CacheLine {
+    char bytes[64];
+};
+
+void testOperatorNew() {
+    printSeparator("Testing operator new/delete");
+
+    int* value = new int(42);
+    std::string text(1000, 'x');
+    std::vector<double> numbers(10000, 1.5);
+    CacheLine* line = new CacheLine();
+    CacheLine* lines = new CacheLine[7];
+    long double* wide = new long double[3];
+
+    bool ok = *value == 42 && text.size() == 1000 && numbers[9999] == 1.5 &&
+              aligned(line, 64) && aligned(lines, 64) && aligned(wide, 16);
+
+    delete value;
+    delete line;
+    delete[] lines;
+    delete[] wide;
+
+    int* failed = new (std::nothrow) int[SIZE_MAX / 64];
+    if(failed != nullptr) ok = false;
+
+    bool threw = false;
+    try {
+        volatile size_t huge = SIZE_MAX / 2;
+        char* never = new char[huge];
+        never[0] = 0;
+    } catch(const std::bad_alloc&) {
+        threw = true;
+    }
+
+    if(ok && threw) {
+        std::cout << "✓ Plain, array, over-aligned and nothrow forms work, failure throws bad_alloc\n";
+    } else {
+        std::cout << "✗ operator new misbehaved\n";
+    }
+}
+
+void testLibcInternalAllocations() {
+    printSeparator("Testing libc Internal Allocations");
+
+    //libc calls the replacement malloc itself, so its results must be freeable here
+    char* copy = strdup("replaced allocator");
+    char* joined = nullptr;
+    int length = asprintf(&joined, "%s %d", copy, 42);
+
+    if(copy && length > 0 && strcmp(joined, "replaced allocator 42") == 0) {
+        std::cout << "✓ strdup/asprintf memory freed through the replacement\n";
+    } else {
+        std::cout << "✗ libc allocations failed\n";
+    }
+    free(copy);
+    free(joined);
+}
+
+void testThreads() {
+    printSeparator("Testing Multiple Threads");
+
+    std::atomic<int> corrupted{0};
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; t++) {
+        threads.emplace_back([&corrupted, t]() {
+            std::vector<std::string> live;
+            for(int i = 0; i < 20000; i++) {
+                live.emplace_back(16 + (i * 13 + t) % 300, (char)('a' + t));
+                if(live.size() > 100) live.erase(live.begin() + (i % live.size()));
+            }
+            for(const std::string& s : live) {
+                if(s[0] != 'a' + t || s.back() != 'a' + t) corrupted++;
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    if(corrupted == 0) {
+        std::cout << "✓ 8 threads churned strings without corruption\n";
+    } else {
+        std::cout << "✗ " << corrupted << " strings corrupted\n";
+    }
+}
+
+void testFork() {
+    printSeparator("Testing Fork");
+
+    //another thread keeps allocating while we fork, the child must still find a usable heap
+    std::atomic<bool> stop{false};
+    std::thread churn([&stop]() {
+        while(!stop) {
+            void* ptr = malloc(128);
+            free(ptr);
+        }
+    });
+
+    bool ok = true;
+    for(int i = 0; i < 20; i++) {
+        pid_t pid = fork();
+        if(pid == 0) {
+            std::vector<void*> ptrs;
+            for(int j = 0; j < 1000; j++) ptrs.push_back(malloc(16 + j));
+            for(void* ptr : ptrs) free(ptr);
+            _exit(0);
+        }
+
+        int status = 0;
+        if(pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+        }
+    }
+
+    stop = true;
+    churn.join();
+
+    if(ok) {
+        std::cout << "✓ 20 children allocated after forking during concurrent allocation\n";
+    } else {
+        std::cout << "✗ A child failed after fork\n";
+    }
+}
+
+//first value of `key` in the dump, which is the one in "total"
+uint64_t statsValue(const char* json, const char* key) {
+    const char* at = strstr(json, key);
+    return at ? strtoull(at + strlen(key) + 1, nullptr, 10) : 0; //past the colon
+}
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+//mixed sizes up to 100 KB replaced at random in a fixed number of slots: the freed
+//large blocks merge again, so RSS levels off instead of growing every round
+void testLargeChurn() {
+    printSeparator("Testing RSS Under Large Churn");
+
+    const int SLOTS = 1000, ROUNDS = 10;
+    std::vector<void*> slots(SLOTS, nullptr);
+    unsigned seed = 1;
+    size_t settled = 0, last = 0;
+
+    for(int round = 0; round < ROUNDS; round++) {
+        for(int i = 0; i < 20000; i++) {
+            seed = seed * 1103515245 + 12345;
+            void*& slot = slots[(seed >> 8) % SLOTS];
+            free(slot);
+            seed = seed * 1103515245 + 12345;
+            size_t size = 100 + (seed >> 4) % 100000;
+            slot = malloc(size);
+            memset(slot, 0x6B, size);
+        }
+        last = residentBytes();
+        if(round == 1) settled = last;
+    }
+    for(void* slot : slots) free(slot);
+
+    if(last < settled + settled / 8) {
+        std::cout << "✓ RSS " << settled / (1024 * 1024) << " MB after 2 rounds, " << last / (1024 * 1024)
+                  << " MB after " << ROUNDS << "\n";
+    } else {
+        std::cout << "✗ RSS grew from " << settled / (1024 * 1024) << " MB to " << last / (1024 * 1024)
+                  << " MB over " << ROUNDS << " rounds\n";
+    }
+}
+
+void testStats() {
+    printSeparator("Testing Stats Dump");
+
+    static char json[16 * 1024]; //not on the heap being measured
+    customalloc_stats(json, sizeof(json));
+    uint64_t allocs = statsValue(json, "\"allocs\"");
+    uint64_t live = statsValue(json, "\"live_bytes\"");
+
+    std::vector<void*> blocks(1000); //sized before the first dump is compared
+    for(void*& block : blocks) block = malloc(200);
+    size_t length = customalloc_stats(json, sizeof(json));
+    uint64_t allocsAfter = statsValue(json, "\"allocs\"");
+    uint64_t liveAfter = statsValue(json, "\"live_bytes\"");
+
+    for(void* block : blocks) free(block);
+    customalloc_stats(json, sizeof(json));
+    uint64_t liveFreed = statsValue(json, "\"live_bytes\"");
+
+    if(length < sizeof(json) && allocsAfter >= allocs + 1000 && liveAfter >= live + 1000 * 200 &&
+       liveFreed + 1000 * 200 <= liveAfter) {
+        std::cout << "✓ customalloc_stats counts the mallocs and frees (" << length << " bytes of JSON)\n";
+    } else {
+        std::cout << "✗ Stats did not follow the calls: allocs " << allocs << " -> " << allocsAfter
+                  << ", live " << live << " -> " << liveAfter << " -> " << liveFreed << "\n";
+    }
+}
+
+//what the traced copy of this program allocates, see testTrace
+void tracedCalls() {
+    void* grown = malloc(12345);
+    grown = realloc(grown, 23456);
+    void* aligned = aligned_alloc(256, 1000);
+    free(grown);
+    free(aligned);
+}
+
+void testTrace(const char* self) {
+    printSeparator("Testing Trace Recording");
+
+    //the trace starts with the heap, so the variable has to be set before the program starts
+    std::string path = "/tmp/custom_malloc_trace_" + std::to_string(getpid());
+    pid_t pid = fork();
+    if(pid == 0) {
+        setenv("CUSTOMALLOC_TRACE", path.c_str(), 1);
+        execl(self, self, "--traced", (char*)nullptr);
+        _exit(127);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    //find tracedCalls among whatever libc and libstdc++ allocated at startup
+    TraceReader reader;
+    std::vector<TraceEvent> events;
+    TraceEvent event;
+    if(reader.open(path.c_str())) {
+        while(reader.next(event)) events.push_back(event);
+    }
+
+    bool found = false;
+    for(size_t i = 0; i + 4 < events.size(); i++) {
+        const TraceEvent* e = &events[i];
+        if(e[0].op == TraceOp::Alloc && e[0].size == 12345
+           && e[1].op == TraceOp::Realloc && e[1].object == e[0].object && e[1].size == 23456
+           && e[2].op == TraceOp::Alloc && e[2].size == 1000 && e[2].alignment == 256
+           && e[3].op == TraceOp::Free && e[3].object == e[0].object
+           && e[4].op == TraceOp::Free && e[4].object == e[2].object) {
+            found = true;
+        }
+    }
+
+    if(WIFEXITED(status) && WEXITSTATUS(status) == 0 && found && !reader.truncated()) {
+        std::cout << "✓ CUSTOMALLOC_TRACE records malloc, realloc, aligned_alloc and free (" << events.size() << " events)\n";
+    } else {
+        std::cout << "✗ Traced calls missing from the trace (" << events.size() << " events)\n";
+    }
+    unlink(path.c_str());
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && strcmp(argv[1], "--traced") == 0) {
+        tracedCalls();
+        return 0;
+    }
+
+    std::cout << "Starting Custom Malloc Tests\n";
+    std::cout << "============================\n";
+
+    testMallocFree();
+    testCalloc();
+    testRealloc();
+    testAlignedEntryPoints();
+    testOperatorNew();
+    testLibcInternalAllocations();
+    testThreads();
+    testFork();
+    testLargeChurn();
+    testStats();
+    testTrace(argv[0]);
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include <vector>
 #include <cassert>
 #include <cstring>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
 #include "explicit_allocator.h"
 #include "block_utils.h"
 
@@ -15,7 +19,7 @@ void printHeapState() {
     Block* current = allocator.freeListHead;
     int count = 0;
     while(current && count < 20) {  // Limit iterations!
-        std::cout << "[" << current << ": size=" << current->size << "] -> ";
+        std::cout << "[" << current << ": size=" << current->size() << "] -> ";
         current = current->next;
         count++;
     }
@@ -96,6 +100,272 @@ void testCoalescing() {
     printHeapState();
 }
 
+// Test merging with the physical predecessor through its footer
+void testBackwardCoalescing() {
+    std::cout << "\n=== Testing Backward Coalescing ===\n";
+    resetHeap();
+    
+    word_t* ptr1 = allocator.alloc(64);
+    word_t* ptr2 = allocator.alloc(64);
+    word_t* ptr3 = allocator.alloc(64);
+    word_t* guard = allocator.alloc(64);
+    
+    // Free in address order so every free has to merge backwards
+    allocator.free(ptr1);
+    assert(allocator.getPhysicalPreviousBlock(getHeader(ptr2)) == getHeader(ptr1));
+    std::cout << "✓ Previous free block found through its footer\n";
+    
+    allocator.free(ptr2);
+    allocator.free(ptr3);
+    printHeapState();
+    
+    Block* merged = allocator.freeListHead;
+    assert(merged == getHeader(ptr1) && merged->next == nullptr);
+    assert(merged->size() == 3 * 64 + 2 * HEADER_SIZE);
+    std::cout << "✓ Three blocks merged backwards into one free block\n";
+    
+    assert(allocator.getPhysicalPreviousBlock(getHeader(guard)) == merged);
+    assert(!getHeader(guard)->isPrevUsed());
+    std::cout << "✓ Following block sees the merged block as its free predecessor\n";
+    
+    // The whole run is reusable by a single allocation
+    word_t* big = allocator.alloc(3 * 64);
+    assert(big == ptr1);
+    assert(allocator.getPhysicalNextBlock(getHeader(big))->isPrevUsed());
+    std::cout << "✓ Merged block reused for a large allocation\n";
+}
+
+// Test realloc in place and by moving
+void testRealloc() {
+    std::cout << "\n=== Testing Realloc ===\n";
+    resetHeap();
+    
+    word_t* ptr1 = allocator.alloc(64);
+    word_t* ptr2 = allocator.alloc(64);
+    word_t* guard = allocator.alloc(64);
+    memset(ptr1, 0xAB, 64);
+    
+    // Shrinking gives the tail back as a free block
+    word_t* shrunk = allocator.realloc(ptr1, 24);
+    assert(shrunk == ptr1 && getHeader(ptr1)->size() == 24);
+    assert(allocator.freeListHead == allocator.getPhysicalNextBlock(getHeader(ptr1)));
+    std::cout << "✓ Shrink split the block in place\n";
+    
+    // Growing takes the free successor (tail plus the freed ptr2)
+    allocator.free(ptr2);
+    word_t* grown = allocator.realloc(ptr1, 128);
+    assert(grown == ptr1 && getHeader(ptr1)->size() >= 128);
+    assert(((unsigned char*)grown)[23] == 0xAB);
+    assert(allocator.getPhysicalNextBlock(getHeader(grown)) == getHeader(guard));
+    assert(getHeader(guard)->isPrevUsed());
+    std::cout << "✓ Grow absorbed the free neighbour in place\n";
+    
+    // The top block grows by extending the heap
+    word_t* last = allocator.alloc(64);
+    assert(getHeader(last) == allocator.top);
+    word_t* extended = allocator.realloc(last, 4096);
+    assert(extended == last && getHeader(last)->size() == 4096 && getHeader(last) == allocator.top);
+    std::cout << "✓ Top block grew by extending the heap\n";
+    
+    // A used successor forces a move that keeps the contents
+    memset(guard, 0x5C, 64);
+    word_t* moved = allocator.realloc(guard, 256);
+    assert(moved != guard && ((unsigned char*)moved)[63] == 0x5C);
+    assert(!getHeader(guard)->isUsed());
+    std::cout << "✓ Blocked grow moved the payload\n";
+    
+    assert(allocator.realloc(nullptr, 32) != nullptr);
+    assert(allocator.realloc(moved, 0) == nullptr);
+    std::cout << "✓ realloc(nullptr) allocates, realloc(p, 0) frees\n";
+
+    // A size that would wrap once aligned fails and leaves the block alone
+    word_t* kept = allocator.alloc(64);
+    memset(kept, 0x3D, 64);
+    assert(allocator.realloc(kept, SIZE_MAX - 3) == nullptr);
+    assert(getHeader(kept)->isUsed() && getHeader(kept)->size() == 64 && ((unsigned char*)kept)[63] == 0x3D);
+    std::cout << "✓ Oversized realloc fails with the block intact\n";
+}
+
+// Test calloc on fresh and recycled memory
+void testCalloc() {
+    std::cout << "\n=== Testing Calloc ===\n";
+    resetHeap();
+    
+    auto allZero = [](word_t* data, size_t bytes) {
+        unsigned char* p = (unsigned char*)data;
+        for(size_t i = 0; i < bytes; i++) if(p[i]) return false;
+        return true;
+    };
+    
+    word_t* fresh = allocator.calloc(100, sizeof(int));
+    assert(fresh != nullptr && allZero(fresh, 100 * sizeof(int)));
+    std::cout << "✓ Fresh block reads as zero\n";
+    
+    // Dirty the block, free it and get it back through calloc
+    memset(fresh, 0xEE, 100 * sizeof(int));
+    allocator.free(fresh);
+    word_t* recycled = allocator.calloc(50, 2 * sizeof(int));
+    assert(recycled == fresh && allZero(recycled, 100 * sizeof(int)));
+    std::cout << "✓ Recycled block cleared\n";
+    
+    assert(allocator.calloc((size_t)1 << 40, (size_t)1 << 40) == nullptr);
+    std::cout << "✓ Overflowing count * size rejected\n";
+
+    // A product that fits but would wrap once aligned and given a header
+    assert(allocator.calloc(1, SIZE_MAX - 3) == nullptr && allocator.calloc(2, SIZE_MAX / 2) == nullptr);
+    assert(allocator.alloc(SIZE_MAX - 3) == nullptr);
+    std::cout << "✓ Sizes near SIZE_MAX rejected before aligning\n";
+    
+    // A caller-supplied buffer is not known to be zero, so fresh blocks are cleared too
+    static unsigned char buffer[4096];
+    memset(buffer, 0xFF, sizeof(buffer));
+    BufferChunkProvider provider(buffer, sizeof(buffer));
+    ExplicitAllocator bufferAllocator(&provider);
+    word_t* fromBuffer = bufferAllocator.calloc(64, 8);
+    assert(fromBuffer != nullptr && allZero(fromBuffer, 512));
+    std::cout << "✓ Blocks from a dirty buffer cleared\n";
+}
+
+// Test aligned allocation
+void testAlignedAllocation() {
+    std::cout << "\n=== Testing Aligned Allocation ===\n";
+
+    ExplicitAllocator aligned;
+    word_t* spacer = aligned.alloc(8); // the heap starts on a page, move it off
+
+    std::vector<word_t*> blocks;
+    for(size_t alignment = 16; alignment <= 4096; alignment *= 2) {
+        word_t* data = aligned.allocAligned(100, alignment);
+        assert(data != nullptr && (uintptr_t)data % alignment == 0);
+        assert(getHeader(data)->size() < 104 + HEADER_SIZE + aligned.minPayload());
+        memset(data, 0x5A, 100);
+        blocks.push_back(data);
+    }
+    std::cout << "✓ Payloads aligned from 16 bytes to a page, no slack left inside\n";
+
+    // The slack in front of the page-aligned block is on the free list
+    word_t* page = blocks.back();
+    bool slackFree = false;
+    for(Block* block = aligned.freeListHead; block; block = block->next) {
+        if((char*)block->data + block->size() == (char*)getHeader(page)) slackFree = true;
+    }
+    assert(slackFree && !getHeader(page)->isPrevUsed());
+    std::cout << "✓ Leading slack is a free block of its own\n";
+
+    // Freeing through the header merges everything back into one free block
+    for(word_t* data : blocks) aligned.free(data);
+    aligned.free(spacer);
+    assert(aligned.freeListHead == aligned.heapStart && aligned.freeListHead->next == nullptr);
+    std::cout << "✓ Aligned blocks free through their header and merge back\n";
+
+    assert(aligned.allocAligned(64, 24) == nullptr && aligned.allocAligned(64, 8192) == nullptr);
+    std::cout << "✓ Alignments that are not a power of two up to a page rejected\n";
+
+    assert(aligned.allocAligned(SIZE_MAX - 3, 64) == nullptr && aligned.allocAligned(SIZE_MAX - 4200, 4096) == nullptr);
+    std::cout << "✓ Sizes that would wrap once aligned or padded rejected\n";
+}
+
+// Test free with the size the caller allocated
+void testSizedFree() {
+    std::cout << "\n=== Testing Sized Free ===\n";
+
+    ExplicitAllocator sized;
+    sized.verifySizedFree = true;
+
+    word_t* first = sized.alloc(100);
+    word_t* second = sized.alloc(200);
+    sized.free(first, 100);
+    sized.free(second, 200);
+    assert(sized.freeListHead == sized.heapStart && sized.freeListHead->next == nullptr);
+    std::cout << "✓ Matching sizes pass the check, blocks still merge\n";
+}
+
+// Resident set size in bytes, from /proc/self/statm
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Test giving memory back to the OS
+void testTrim() {
+    std::cout << "\n=== Testing Trim And Purge ===\n";
+    
+    const size_t BIG = 16 * 1024 * 1024;
+    
+    // A large free top block shrinks on free and the heap regrows in place
+    ExplicitAllocator heap;
+    heap.alloc(64);
+    word_t* top = heap.alloc(BIG);
+    memset(top, 0xAA, BIG);
+    heap.free(top);
+    assert(heap.top == getHeader(top) && heap.top->size() == ExplicitAllocator::TOP_PAD);
+    assert(heap.provider->extend(0) == (char*)top + ExplicitAllocator::TOP_PAD);
+    std::cout << "✓ Free top block trimmed to TOP_PAD\n";
+    
+    word_t* regrown = heap.alloc(BIG);
+    assert(regrown != nullptr && regrown[BIG / sizeof(word_t) - 1] == 0);
+    std::cout << "✓ Heap regrows over released memory, which reads as zero\n";
+    
+    // Pages inside a free block that is not the top are purged, the block stays usable
+    ExplicitAllocator purging;
+    purging.decayMillis = -1;
+    word_t* big = purging.alloc(BIG);
+    word_t* guard = purging.alloc(64);
+    memset(big, 0xAA, BIG);
+    size_t before = residentBytes();
+    purging.free(big);
+    size_t purged = purging.purge();
+    size_t after = residentBytes();
+    assert(purged >= BIG - 2 * sysconf(_SC_PAGESIZE) && after + BIG / 2 < before);
+    assert(purging.purge() == 0);
+    std::cout << "✓ Purged " << purged / 1024 << " KB of a free block, RSS down "
+              << (before - after) / 1024 << " KB\n";
+    
+    word_t* reused = purging.alloc(BIG);
+    assert(reused == big);
+    reused[0] = 1;
+    reused[BIG / sizeof(word_t) - 1] = 2;
+    std::cout << "✓ Purged block reused intact\n";
+    
+    // trim() releases a free top the automatic threshold left alone
+    purging.trimThreshold = 0;
+    purging.free(reused);
+    purging.free(guard);
+    assert(purging.top->size() > BIG);
+    size_t released = purging.trim();
+    assert(released >= BIG && purging.top->size() == purging.minPayload());
+    std::cout << "✓ trim() released " << released / 1024 << " KB\n";
+    
+    // Decay purges blocks that stayed free longer than the delay
+    ExplicitAllocator decaying;
+    decaying.decayMillis = 20;
+    word_t* first = decaying.alloc(BIG / 4);
+    decaying.alloc(64);
+    word_t* second = decaying.alloc(BIG / 4);
+    decaying.alloc(64);
+    memset(first, 0xCD, BIG / 4);
+    memset(second, 0xCD, BIG / 4);
+    decaying.free(first);
+    assert(*decaying.purgeStamp(getHeader(first)) != 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    decaying.free(second); // freeing a large block runs the due decay pass
+    assert(*decaying.purgeStamp(getHeader(first)) == 0);
+    assert(*decaying.purgeStamp(getHeader(second)) != 0);
+    std::cout << "✓ Decay purged the block idle past the delay, kept the fresh one\n";
+    
+    // MADV_FREE pages may keep their contents, so calloc still clears purged blocks
+    decaying.purgeAdvice = ExplicitAllocator::PurgeAdvice::Free;
+    decaying.purge();
+    for(int i = 0; i < 2; i++) {
+        word_t* zeroed = decaying.calloc(1, BIG / 4);
+        assert(zeroed == first || zeroed == second);
+        for(size_t j = 0; j < BIG / 4 / sizeof(word_t); j += 512) assert(zeroed[j] == 0);
+    }
+    std::cout << "✓ Calloc clears purged blocks\n";
+}
+
 // Test different fit strategies
 void testFitStrategies() {
     std::cout << "\n=== Testing Fit Strategies ===\n";
@@ -117,15 +387,106 @@ void testFitStrategies() {
     
     // Test first fit
     Block* block = allocator.firstFit(80);
-    std::cout << "First fit for 80 bytes: " << (block ? "found block of size " + std::to_string(block->size) : "not found") << "\n";
+    std::cout << "First fit for 80 bytes: " << (block ? "found block of size " + std::to_string(block->size()) : "not found") << "\n";
     
     // Test best fit
     block = allocator.bestFit(80);
-    std::cout << "Best fit for 80 bytes: " << (block ? "found block of size " + std::to_string(block->size) : "not found") << "\n";
+    std::cout << "Best fit for 80 bytes: " << (block ? "found block of size " + std::to_string(block->size()) : "not found") << "\n";
     
     // Test worst fit
     block = allocator.worstFit(80);
-    std::cout << "Worst fit for 80 bytes: " << (block ? "found block of size " + std::to_string(block->size) : "not found") << "\n";
+    std::cout << "Worst fit for 80 bytes: " << (block ? "found block of size " + std::to_string(block->size()) : "not found") << "\n";
+}
+
+// Test fit policies chosen at compile time
+void testFitPolicies() {
+    std::cout << "\n=== Testing Compile-Time Fit Policies ===\n";
+
+    ExplicitAllocator policy;
+    word_t* large = policy.alloc(200);
+    policy.alloc(32);
+    word_t* small = policy.alloc(64);
+    policy.alloc(32);
+    policy.free(large);
+    policy.free(small); //list: small, large
+
+    assert(policy.findBlock<FirstFit>(48) == getHeader(small));
+    assert(policy.findBlock<BestFit>(48) == getHeader(small));
+    assert(policy.findBlock<WorstFit>(48) == getHeader(large));
+    std::cout << "✓ findBlock<Fit> searches with the policy\n";
+
+    word_t* worst = policy.alloc<WorstFit>(48);
+    assert(worst == large && policy.searchMode == ExplicitAllocator::SearchMode::FirstFit);
+    std::cout << "✓ alloc<WorstFit> ignores the first-fit searchMode\n";
+    policy.free(worst);
+
+    //any type with a static find works as a policy
+    struct ExactFit {
+        static Block* find(ExplicitAllocator& heap, size_t size) {
+            for(Block* block = heap.freeListHead; block; block = block->next) {
+                if(block->size() == size) return block;
+            }
+            return nullptr;
+        }
+    };
+    assert(policy.alloc<ExactFit>(64) == small);
+    std::cout << "✓ User-defined policy used by alloc<Fit>\n";
+}
+
+// Test the tree index behind bestFit/worstFit
+void testIndexedFit() {
+    std::cout << "\n=== Testing Indexed Best/Worst Fit ===\n";
+    
+    ExplicitAllocator indexed;
+    indexed.indexFreeBlocks = true;
+    indexed.searchMode = ExplicitAllocator::SearchMode::BestFit;
+    
+    word_t* ptr1 = indexed.alloc(70);
+    indexed.alloc(16);
+    word_t* ptr2 = indexed.alloc(110);
+    indexed.alloc(16);
+    word_t* ptr3 = indexed.alloc(150);
+    indexed.alloc(16);
+    indexed.free(ptr1);
+    indexed.free(ptr2);
+    indexed.free(ptr3);
+    
+    assert(indexed.freeTree.count == 3 && indexed.freeTree.isValid());
+    assert(indexed.bestFit(80) == getHeader(ptr2));
+    assert(indexed.worstFit(80) == getHeader(ptr3));
+    assert(indexed.bestFit(200) == nullptr && indexed.worstFit(200) == nullptr);
+    std::cout << "✓ Tree answers best and worst fit\n";
+    
+    // Random churn: the tree must always mirror the free list and agree with a scan
+    std::vector<word_t*> live;
+    unsigned seed = 3;
+    bool consistent = true;
+    for(int i = 0; i < 20000; i++) {
+        seed = seed * 1103515245 + 12345;
+        if(live.size() < 50 || (seed >> 16) % 3) {
+            live.push_back(indexed.alloc(8 + (seed >> 8) % 600));
+        } else {
+            size_t victim = (seed >> 4) % live.size();
+            indexed.free(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+        
+        if(i % 500 == 0) {
+            size_t listed = 0;
+            size_t request = (seed >> 12) % 700;
+            size_t scanned = 0;
+            for(Block* block = indexed.freeListHead; block; block = block->next) {
+                listed++;
+                if(block->size() >= request && (scanned == 0 || block->size() < scanned)) scanned = block->size();
+            }
+            Block* best = indexed.bestFit(request);
+            if(listed != indexed.freeTree.count || !indexed.freeTree.isValid()) consistent = false;
+            if((best ? best->size() : 0) != scanned) consistent = false;
+        }
+    }
+    assert(consistent);
+    std::cout << "✓ Tree stays valid and matches a linear best-fit scan under churn\n";
 }
 
 // Test splitting
@@ -263,7 +624,15 @@ int main() {
     try {
         testBasicAllocation();
         testCoalescing();
+        testBackwardCoalescing();
+        testRealloc();
+        testCalloc();
+        testAlignedAllocation();
+        testSizedFree();
+        testTrim();
+        testIndexedFit();
         testFitStrategies();
+        testFitPolicies();
         testSplitting();
         testEdgeCases();
         testNextFit();
@@ -60,7 +60,7 @@ public:
         // Free middle block
         allocator.free(ptr2);
         Block* block2 = getHeader(ptr2);
-        assertEqual(!block2->used, "Freed block is marked as unused");
+        assertEqual(!block2->isUsed(), "Freed block is marked as unused");
 
         // Allocate something that should fit in the freed space
         word_t* ptr4 = allocator.alloc(16);
@@ -68,7 +68,7 @@ public:
         
         // Check if we reused the freed space (should be same or within the freed block)
         Block* block4 = getHeader(ptr4);
-        assertEqual(!block4->used == false, "Reallocated block is marked as used");
+        assertEqual(!block4->isUsed() == false, "Reallocated block is marked as used");
     }
 
     void testFirstFitStrategy() {
@@ -116,6 +116,40 @@ public:
         assertEqual(foundBlock == expectedBlock, "BestFit returns the best fitting block");
     }
 
+    void testFitPolicies() {
+        std::cout << "\n=== Testing Compile-Time Fit Policies ===" << std::endl;
+
+        ImplicitAllocator policy;
+        word_t* ptr1 = policy.alloc(128);
+        policy.alloc(16);
+        word_t* ptr2 = policy.alloc(48);
+        policy.alloc(16);
+        policy.free(ptr1);
+        policy.free(ptr2);
+
+        assertEqual(policy.findBlock<FirstFit>(40) == getHeader(ptr1) &&
+                    policy.findBlock<BestFit>(40) == getHeader(ptr2) &&
+                    policy.findBlock<WorstFit>(40) == getHeader(ptr1),
+                    "findBlock<Fit> searches with the policy, not searchMode");
+
+        word_t* best = policy.alloc<BestFit>(40);
+        assertEqual(best == ptr2 && policy.searchMode == ImplicitAllocator::SearchMode::FirstFit,
+                    "alloc<BestFit> takes the best fit under a first-fit searchMode");
+        policy.free(best);
+
+        //any type with a static find works as a policy
+        struct LastFit {
+            static Block* find(ImplicitAllocator& heap, size_t size) {
+                Block* found = nullptr;
+                for(Block* block = heap.heapStart; block; block = heap.getPhysicalNextBlock(block)) {
+                    if(!block->isUsed() && block->size() >= size) found = block;
+                }
+                return found;
+            }
+        };
+        assertEqual(policy.alloc<LastFit>(40) == ptr2, "User-defined policy used by alloc<Fit>");
+    }
+
     void testWorstFitStrategy() {
         std::cout << "\n=== Testing Worst Fit Strategy ===" << std::endl;
         resetAllocator();
@@ -165,7 +199,7 @@ public:
         allocator.free(ptr1);
         
         Block* largeBlock = getHeader(ptr1);
-        size_t originalSize = largeBlock->size;
+        size_t originalSize = largeBlock->size();
         
         // Test if we can split the block
         bool canSplit = allocator.canSplit(largeBlock, 64);
@@ -174,9 +208,10 @@ public:
         if (canSplit) {
             Block* splitBlock = allocator.split(largeBlock, 64);
             assertEqual(splitBlock != nullptr, "Split operation returns valid block");
-            assertEqual(splitBlock->size == 64, "Split block has correct size");
-            assertEqual(splitBlock->next != nullptr, "Split creates next block");
-            assertEqual(splitBlock->next->size == originalSize - 64 - sizeof(Block) + sizeof(word_t), 
+            assertEqual(splitBlock->size() == 64, "Split block has correct size");
+            Block* remainder = allocator.getPhysicalNextBlock(splitBlock);
+            assertEqual(remainder != nullptr, "Split creates next block");
+            assertEqual(remainder->size() == originalSize - 64 - HEADER_SIZE, 
                        "Remaining block has correct size");
         }
     }
@@ -203,12 +238,12 @@ public:
         if (canCoalesce) {
             assertEqual(true, "Adjacent free blocks can be coalesced");
             
-            size_t originalSize1 = block1->size;
-            size_t originalSize2 = block2->size;
+            size_t originalSize1 = block1->size();
+            size_t originalSize2 = block2->size();
             
             Block* coalescedBlock = allocator.coalesce(block1);
             assertEqual(coalescedBlock == block1, "Coalesce returns first block");
-            assertEqual(coalescedBlock->size > originalSize1, "Coalesced block is larger");
+            assertEqual(coalescedBlock->size() > originalSize1, "Coalesced block is larger");
         }
     }
 
@@ -292,6 +327,111 @@ public:
         assertEqual(ptr4 != nullptr, "Allocation after many frees succeeds");
     }
 
+    void testRealloc() {
+        std::cout << "\n=== Testing Realloc ===" << std::endl;
+        resetAllocator();
+
+        word_t* ptr1 = allocator.alloc(64);
+        word_t* ptr2 = allocator.alloc(64);
+        word_t* ptr3 = allocator.alloc(64);
+        memset(ptr1, 0x42, 64);
+
+        word_t* shrunk = allocator.realloc(ptr1, 32);
+        assertEqual(shrunk == ptr1, "Shrink keeps the block in place");
+        assertEqual(getHeader(ptr1)->size() == 32, "Shrink splits off the tail");
+        assertEqual(!allocator.getPhysicalNextBlock(getHeader(ptr1))->isUsed(), "Split tail is free");
+
+        allocator.free(ptr2);
+        word_t* grown = allocator.realloc(ptr1, 120);
+        assertEqual(grown == ptr1, "Grow absorbs the free neighbour in place");
+        assertEqual(((unsigned char*)grown)[31] == 0x42, "Contents kept after in-place grow");
+
+        word_t* extended = allocator.realloc(ptr3, 1024);
+        assertEqual(extended == ptr3 && getHeader(ptr3)->size() == 1024, "Top block grows by extending the heap");
+
+        word_t* moved = allocator.realloc(ptr1, 512);
+        assertEqual(moved != ptr1 && ((unsigned char*)moved)[31] == 0x42, "Blocked grow moves and copies");
+        assertEqual(!getHeader(ptr1)->isUsed(), "Old block freed after move");
+
+        // With everything behind it free, a free run ending at top is taken whole
+        allocator.free(moved);
+        allocator.free(ptr3);
+        word_t* first = allocator.alloc(8);
+        word_t* regrown = allocator.realloc(first, 4096);
+        assertEqual(regrown == first && getHeader(first) == allocator.top, "Free run up to top absorbed and extended");
+
+        size_t before = getHeader(regrown)->size();
+        assertEqual(allocator.realloc(regrown, SIZE_MAX - 3) == nullptr && getHeader(regrown)->isUsed() &&
+                    getHeader(regrown)->size() == before, "Oversized realloc fails with the block intact");
+        assertEqual(allocator.alloc(SIZE_MAX - 3) == nullptr, "Oversized alloc fails");
+    }
+
+    void testIndexedFit() {
+        std::cout << "\n=== Testing Indexed Best/Worst Fit ===" << std::endl;
+
+        ImplicitAllocator indexed;
+        indexed.indexFreeBlocks = true;
+        indexed.searchMode = ImplicitAllocator::SearchMode::BestFit;
+
+        word_t* ptr1 = indexed.alloc(64);
+        indexed.alloc(16);
+        word_t* ptr2 = indexed.alloc(128);
+        indexed.alloc(16);
+        word_t* ptr3 = indexed.alloc(256);
+        indexed.alloc(16);
+        indexed.free(ptr1);
+        indexed.free(ptr2);
+        indexed.free(ptr3);
+
+        assertEqual(indexed.freeTree.count == 3 && indexed.freeTree.isValid(), "Free blocks indexed in a valid tree");
+        assertEqual(indexed.bestFit(100) == getHeader(ptr2), "Indexed BestFit returns the best fitting block");
+        assertEqual(indexed.worstFit(100) == getHeader(ptr3), "Indexed WorstFit returns the largest block");
+
+        word_t* reused = indexed.alloc(96); // leaves a 24 byte tail, just room for a node
+        assertEqual(reused == ptr2, "BestFit alloc uses the tree");
+        assertEqual(indexed.freeTree.isValid() && indexed.freeTree.count == 3, "Split remainder indexed");
+
+        indexed.free(reused);
+        size_t freeBlocks = 0;
+        for(Block* block = indexed.heapStart; block; block = indexed.getPhysicalNextBlock(block)) {
+            if(!block->isUsed()) freeBlocks++;
+        }
+        assertEqual(freeBlocks == indexed.freeTree.count, "Tree holds exactly the free blocks");
+    }
+
+    void testAlignedAllocation() {
+        std::cout << "\n=== Testing Aligned Allocation ===" << std::endl;
+
+        ImplicitAllocator aligned;
+        aligned.alloc(8); // the heap starts on a page, move it off
+
+        bool allAligned = true, tight = true;
+        std::vector<word_t*> blocks;
+        for(size_t alignment = 16; alignment <= 4096; alignment *= 2) {
+            word_t* data = aligned.allocAligned(100, alignment);
+            if(!data || (uintptr_t)data % alignment) allAligned = false;
+            else if(getHeader(data)->size() >= 104 + HEADER_SIZE + aligned.minPayload()) tight = false;
+            blocks.push_back(data);
+        }
+        assertEqual(allAligned, "Payloads aligned from 16 bytes to a page");
+        assertEqual(tight, "Aligned blocks hold no slack a free block would fit in");
+
+        // the slack around the blocks went back to the heap as free blocks
+        word_t* page = blocks.back();
+        assertEqual(aligned.alloc(16) < page, "Slack reused by a later allocation");
+
+        for(word_t* data : blocks) aligned.free(data);
+        void* heapEnd = aligned.provider->extend(0);
+        word_t* again = aligned.allocAligned(100, 64);
+        assertEqual(again && (uintptr_t)again % 64 == 0 && aligned.provider->extend(0) == heapEnd,
+                    "Aligned blocks free through their header and are carved again");
+
+        assertEqual(aligned.allocAligned(64, 24) == nullptr && aligned.allocAligned(64, 8192) == nullptr,
+                    "Alignments that are not a power of two up to a page rejected");
+        assertEqual(aligned.allocAligned(SIZE_MAX - 3, 64) == nullptr && aligned.allocAligned(SIZE_MAX - 4200, 4096) == nullptr,
+                    "Sizes that would wrap once aligned or padded rejected");
+    }
+
     void runAllTests() {
         std::cout << "Starting ImplicitAllocator Test Suite..." << std::endl;
         
@@ -301,9 +441,13 @@ public:
         testBestFitStrategy();
         testWorstFitStrategy();
         testNextFitStrategy();
+        testFitPolicies();
         testBlockSplitting();
         testBlockCoalescing();
         testMemoryIntegrity();
+        testRealloc();
+        testIndexedFit();
+        testAlignedAllocation();
         testEdgeCases();
 
         std::cout << "\n=== Test Results ===" << std::endl;
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include "pool.h"
+#include "segregated_allocator.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+struct Order {
+    uint64_t id;
+    double price;
+    int quantity;
+    Order* next = nullptr;
+
+    Order(uint64_t id, double price, int quantity) : id(id), price(price), quantity(quantity) {}
+};
+
+struct alignas(64) Connection {
+    int fd;
+    char buffer[100];
+
+    explicit Connection(int fd) : fd(fd) {}
+};
+
+//counts live instances and throws on demand
+struct Tracked {
+    static int live;
+    std::unique_ptr<int> owned;
+
+    explicit Tracked(std::unique_ptr<int> value, bool fail = false) : owned(std::move(value)) {
+        if(fail) throw std::runtime_error("constructor failed");
+        live++;
+    }
+    ~Tracked() { live--; }
+};
+int Tracked::live = 0;
+
+void testCreateDestroy() {
+    printSeparator("Testing Create & Destroy");
+
+    Pool<Order> pool;
+
+    Order* order = pool.create(42, 99.5, 10);
+    if(order && order->id == 42 && order->price == 99.5 && order->quantity == 10) {
+        std::cout << "✓ create forwards constructor arguments\n";
+    } else {
+        std::cout << "✗ Object constructed wrong\n";
+    }
+
+    pool.destroy(order);
+    if(pool.create(7, 1.0, 1) == order) {
+        std::cout << "✓ Destroyed slot reused first\n";
+    } else {
+        std::cout << "✗ Freed slot not reused\n";
+    }
+
+    Pool<Tracked> trackedPool;
+    Tracked* kept = trackedPool.create(std::make_unique<int>(3)); //move-only argument
+    if(kept && *kept->owned == 3 && Tracked::live == 1) {
+        std::cout << "✓ Move-only arguments perfectly forwarded\n";
+    } else {
+        std::cout << "✗ Move-only argument lost\n";
+    }
+
+    try {
+        trackedPool.create(std::make_unique<int>(1), true);
+        std::cout << "✗ Constructor exception swallowed\n";
+    } catch(const std::runtime_error&) {
+        if(trackedPool.create(std::make_unique<int>(2)) == kept + 1 && Tracked::live == 2) {
+            std::cout << "✓ Throwing constructor propagates, its slot is not lost\n";
+        } else {
+            std::cout << "✗ Slot leaked by throwing constructor\n";
+        }
+    }
+}
+
+void testChunks() {
+    printSeparator("Testing Chunks");
+
+    MmapChunkProvider provider(64 * 1024 * 1024);
+    Pool<Order, 64> pool(&provider);
+
+    std::vector<Order*> orders;
+    for(int i = 0; i < 1000; i++) orders.push_back(pool.create(i, i * 0.5, i));
+
+    bool intact = true;
+    for(int i = 0; i < 1000; i++) intact = intact && orders[i]->id == (uint64_t)i && orders[i]->quantity == i;
+    if(intact && (char*)orders[1] == (char*)orders[0] + sizeof(Order)) {
+        std::cout << "✓ Objects packed back to back across chunks, all intact\n";
+    } else {
+        std::cout << "✗ Objects overlap or are spread out\n";
+    }
+
+    for(Order* order : orders) pool.destroy(order);
+    char* end = (char*)provider.extend(0);
+    for(int i = 0; i < 1000; i++) orders[i] = pool.create(i, 0.0, 0);
+
+    if((char*)provider.extend(0) == end) {
+        std::cout << "✓ Freed slots reused without new chunks\n";
+    } else {
+        std::cout << "✗ Pool grew although slots were free\n";
+    }
+
+    Pool<Connection, 16> connections;
+    bool aligned = true;
+    for(int i = 0; i < 100; i++) {
+        aligned = aligned && (uintptr_t)connections.create(i) % alignof(Connection) == 0;
+    }
+    if(aligned) {
+        std::cout << "✓ Over-aligned type placed on its boundary\n";
+    } else {
+        std::cout << "✗ Over-aligned type misplaced\n";
+    }
+}
+
+void testBackingAllocator() {
+    printSeparator("Testing Backing Allocator");
+
+    SegregatedListAllocator heap;
+    word_t* firstChunk;
+    {
+        Pool<Order, 128> pool(heap);
+        Order* order = pool.create(1, 2.0, 3);
+        firstChunk = reinterpret_cast<word_t*>((char*)order - sizeof(void*)); //chunk link in front of the slots
+        for(int i = 0; i < 500; i++) pool.create(i, 0.0, 0);
+
+        if(heap.usableSize(firstChunk) >= 128 * sizeof(Order)) {
+            std::cout << "✓ Chunks come from the backing allocator\n";
+        } else {
+            std::cout << "✗ Chunk not allocated by the backing allocator\n";
+        }
+    }
+
+    //the pool handed its chunks back, the same block serves the next one
+    Pool<Order, 128> again(heap);
+    if((char*)again.create(1, 2.0, 3) - sizeof(void*) == (char*)firstChunk) {
+        std::cout << "✓ Chunks returned to the backing allocator on destruction\n";
+    } else {
+        std::cout << "✗ Chunks leaked\n";
+    }
+}
+
+int main() {
+    std::cout << "Starting Pool Tests\n";
+    std::cout << "===================\n";
+
+    testCreateDestroy();
+    testChunks();
+    testBackingAllocator();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
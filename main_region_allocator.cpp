@@ -0,0 +1,177 @@
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <memory_resource>
+#include "region_allocator.h"
+#include "std_allocator.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+void testBumping() {
+    printSeparator("Testing Bumping");
+
+    RegionAllocator region;
+
+    word_t* first = region.alloc(24);
+    word_t* second = region.alloc(5);
+    word_t* third = region.alloc(0);
+    word_t* fourth = region.alloc(8);
+
+    if(first && (char*)second == (char*)first + 24 && (char*)third == (char*)second + 8 && fourth == third) {
+        std::cout << "✓ Objects packed back to back with no header, word aligned\n";
+    } else {
+        std::cout << "✗ Unexpected object placement\n";
+    }
+
+    bool aligned = true;
+    for(size_t alignment : {16, 64, 256, 4096}) {
+        region.alloc(8);
+        word_t* data = region.allocAligned(40, alignment);
+        aligned = aligned && data && (uintptr_t)data % alignment == 0;
+    }
+    if(aligned && region.allocAligned(8, 24) == nullptr) {
+        std::cout << "✓ Aligned objects on their boundary, invalid alignments rejected\n";
+    } else {
+        std::cout << "✗ Aligned allocation wrong\n";
+    }
+}
+
+void testChunkGrowth() {
+    printSeparator("Testing Chunk Growth");
+
+    MmapChunkProvider provider(256 * 1024 * 1024);
+    RegionAllocator region(&provider);
+
+    //fill several chunks with 1 KiB objects, every one must stay intact
+    std::vector<char*> objects;
+    for(int i = 0; i < 1000; i++) {
+        char* data = (char*)region.alloc(1024);
+        memset(data, i & 0xFF, 1024);
+        objects.push_back(data);
+    }
+
+    bool intact = true;
+    for(int i = 0; i < 1000; i++) {
+        intact = intact && objects[i][0] == (char)(i & 0xFF) && objects[i][1023] == (char)(i & 0xFF);
+    }
+    size_t heap = (char*)provider.extend(0) - objects[0];
+    if(intact && heap < 2 * 1000 * 1024) {
+        std::cout << "✓ 1000 objects across doubling chunks, " << heap / 1024 << " KiB of heap\n";
+    } else {
+        std::cout << "✗ Objects overlap or the heap overgrew\n";
+    }
+
+    char* huge = (char*)region.alloc(2 * RegionAllocator::MAX_CHUNK);
+    if(huge) {
+        memset(huge, 1, 2 * RegionAllocator::MAX_CHUNK);
+        std::cout << "✓ Request larger than a chunk gets a chunk of its own\n";
+    } else {
+        std::cout << "✗ Oversized request failed\n";
+    }
+}
+
+void testCheckpoints() {
+    printSeparator("Testing Checkpoints");
+
+    MmapChunkProvider provider(256 * 1024 * 1024);
+    RegionAllocator region(&provider);
+
+    region.alloc(100);
+    RegionAllocator::Checkpoint mark = region.checkpoint();
+    word_t* afterMark = region.alloc(64);
+
+    region.rewind(mark);
+    if(region.alloc(64) == afterMark) {
+        std::cout << "✓ Rewind within a chunk hands the same memory out again\n";
+    } else {
+        std::cout << "✗ Rewind did not restore the cursor\n";
+    }
+
+    //rewinding across chunks keeps them as spares
+    region.rewind(mark);
+    for(int i = 0; i < 512; i++) region.alloc(1024);
+    char* end = (char*)provider.extend(0);
+
+    region.rewind(mark);
+    if(region.alloc(64) == afterMark) {
+        std::cout << "✓ Rewind across chunks returns to the checkpoint\n";
+    } else {
+        std::cout << "✗ Rewind across chunks lost the checkpoint\n";
+    }
+
+    for(int i = 0; i < 512; i++) region.alloc(1024);
+    if((char*)provider.extend(0) == end) {
+        std::cout << "✓ Chunks dropped by rewind reused without growing the heap\n";
+    } else {
+        std::cout << "✗ Heap grew instead of reusing chunks\n";
+    }
+}
+
+void testReset() {
+    printSeparator("Testing Reset");
+
+    MmapChunkProvider provider(256 * 1024 * 1024);
+    RegionAllocator region(&provider);
+
+    //request-scoped pattern: the same work each round, everything dropped at the end
+    char* end = nullptr;
+    bool stable = true;
+    for(int request = 0; request < 10; request++) {
+        for(int i = 0; i < 2000; i++) region.alloc(16 + (i % 7) * 24);
+        if(request == 0) end = (char*)provider.extend(0);
+        else stable = stable && (char*)provider.extend(0) == end;
+        region.reset();
+    }
+
+    if(stable) {
+        std::cout << "✓ Repeated requests reuse the chunks of the first one\n";
+    } else {
+        std::cout << "✗ Heap kept growing across resets\n";
+    }
+
+    region.reset(); //reset of an empty region
+    if(region.alloc(8) != nullptr) {
+        std::cout << "✓ Region usable after reset\n";
+    } else {
+        std::cout << "✗ Allocation after reset failed\n";
+    }
+}
+
+void testResource() {
+    printSeparator("Testing memory_resource");
+
+    RegionAllocator region;
+    RegionResource resource(region);
+
+    {
+        std::pmr::vector<std::pmr::string> words(&resource);
+        for(int i = 0; i < 1000; i++) {
+            words.emplace_back("request-scoped string that needs a buffer #" + std::to_string(i));
+        }
+        if(words[999].back() == '9') {
+            std::cout << "✓ pmr containers allocate from the region\n";
+        } else {
+            std::cout << "✗ pmr container contents wrong\n";
+        }
+    }
+
+    region.reset();
+    std::cout << "✓ Containers released by resetting the region\n";
+}
+
+int main() {
+    std::cout << "Starting Region Allocator Tests\n";
+    std::cout << "===============================\n";
+
+    testBumping();
+    testChunkGrowth();
+    testCheckpoints();
+    testReset();
+    testResource();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
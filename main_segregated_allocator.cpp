@@ -1,7 +1,13 @@
 #include <iostream>
 #include <vector>
 #include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <csignal>
 #include "segregated_allocator.h"
+#include "chunk_provider.h"
 
 void printSeparator(const std::string& title) {
     std::cout << "\n=== " << title << " ===\n";
@@ -222,6 +228,598 @@ void testFragmentationReduction() {
     }
 }
 
+// Counts how often the heap has to grow
+class CountingProvider : public ChunkProvider {
+public:
+    MmapChunkProvider backing;
+    int extendCalls = 0;
+
+    void* extend(size_t size) override {
+        extendCalls++;
+        return backing.extend(size);
+    }
+};
+
+void testBorrowFromLargerBuckets() {
+    printSeparator("Testing Borrowing From Larger Buckets");
+    
+    CountingProvider provider;
+    SegregatedListAllocator allocator(&provider);
+    
+    word_t* ptr128 = allocator.alloc(128);
+    word_t* ptr1k = allocator.alloc(1024);
+    allocator.free(ptr128);
+    allocator.free(ptr1k);
+    int callsBefore = provider.extendCalls;
+    
+    // Bucket 1 is empty: the smallest non-empty larger bucket (4) is used
+    word_t* ptr16 = allocator.alloc(16);
+    if(ptr16 == ptr128) {
+        std::cout << "✓ Empty bucket served from the smallest non-empty larger bucket\n";
+    } else {
+        std::cout << "✗ Request was not served from bucket 4\n";
+    }
+    
+    // The rest of the 128 and 1024 byte blocks cover these without growing the heap
+    std::vector<word_t*> ptrs;
+    for(int i = 0; i < 20; i++) {
+        word_t* ptr = allocator.alloc(32);
+        *ptr = i;
+        ptrs.push_back(ptr);
+    }
+    
+    if(provider.extendCalls == callsBefore) {
+        std::cout << "✓ Split larger blocks instead of growing the heap\n";
+    } else {
+        std::cout << "✗ Heap grew " << provider.extendCalls - callsBefore << " times\n";
+    }
+    
+    bool dataIntact = true;
+    for(size_t i = 0; i < ptrs.size(); i++) {
+        if(*ptrs[i] != (word_t)i) dataIntact = false;
+    }
+    if(dataIntact) {
+        std::cout << "✓ Split blocks do not overlap\n";
+    } else {
+        std::cout << "✗ Split blocks overlap\n";
+    }
+    
+    for(word_t* ptr : ptrs) allocator.free(ptr);
+    allocator.free(ptr16);
+}
+
+void testSlabRuns() {
+    printSeparator("Testing Slab Runs");
+    
+    SegregatedListAllocator allocator;
+    
+    // Small objects are packed back to back with no header in between
+    std::vector<word_t*> ptrs;
+    for(int i = 0; i < 1000; i++) {
+        word_t* ptr = allocator.alloc(16);
+        *ptr = i;
+        ptrs.push_back(ptr);
+    }
+    
+    if((char*)ptrs[1] - (char*)ptrs[0] == 16 && allocator.usableSize(ptrs[0]) == 16) {
+        std::cout << "✓ 16 byte objects are 16 bytes apart\n";
+    } else {
+        std::cout << "✗ Small objects carry per-object overhead\n";
+    }
+    
+    // Every object maps back to a run of its own size class
+    bool runsMatch = true;
+    std::vector<SlabRun*> runs;
+    for(word_t* ptr : ptrs) {
+        SlabRun* run = SlabAllocator::runOf(ptr);
+        if(run->objectSize != 16) runsMatch = false;
+        if(runs.empty() || runs.back() != run) runs.push_back(run);
+    }
+    size_t perRun = (SlabAllocator::RUN_SIZE - SlabAllocator::RUN_HEADER_SIZE) / 16;
+    if(runsMatch && runs.size() == (1000 + perRun - 1) / perRun) {
+        std::cout << "✓ 1000 objects packed into " << runs.size() << " runs\n";
+    } else {
+        std::cout << "✗ Unexpected run layout (" << runs.size() << " runs)\n";
+    }
+    
+    // Freed objects are reused before new ones are carved
+    word_t* freed = ptrs[500];
+    allocator.free(freed);
+    word_t* again = allocator.alloc(12);
+    if(again == freed) {
+        std::cout << "✓ Freed slot reused by the same size class\n";
+    } else {
+        std::cout << "✗ Freed slot was not reused\n";
+    }
+    ptrs[500] = again;
+    *again = 500;
+    
+    bool dataIntact = true;
+    for(size_t i = 0; i < ptrs.size(); i++) {
+        if(*ptrs[i] != (word_t)i) dataIntact = false;
+    }
+    if(dataIntact) {
+        std::cout << "✓ Slab objects do not overlap\n";
+    } else {
+        std::cout << "✗ Slab objects overlap\n";
+    }
+    
+    // An emptied run is handed to another size class
+    for(word_t* ptr : ptrs) allocator.free(ptr);
+    word_t* small64 = allocator.alloc(64);
+    bool recycled = false;
+    for(SlabRun* run : runs) {
+        if(SlabAllocator::runOf(small64) == run) recycled = true;
+    }
+    if(recycled && allocator.usableSize(small64) == 64) {
+        std::cout << "✓ Empty runs recycled across size classes\n";
+    } else {
+        std::cout << "✗ Empty run was not reused\n";
+    }
+    allocator.free(small64);
+    
+    // Larger requests still go through the bucket lists
+    word_t* ptr100 = allocator.alloc(100);
+    if(allocator.usableSize(ptr100) == 128 && getHeader(ptr100)->isUsed()) {
+        std::cout << "✓ Requests above 64 bytes keep using block headers\n";
+    } else {
+        std::cout << "✗ Bucket allocation changed\n";
+    }
+    allocator.free(ptr100);
+}
+
+// Resident set size in bytes, from /proc/self/statm
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+void testDirectMapping() {
+    printSeparator("Testing Direct Mapping");
+    
+    SegregatedListAllocator allocator;
+    
+    word_t* below = allocator.alloc(SegregatedListAllocator::DEFAULT_MMAP_THRESHOLD - 8);
+    word_t* above = allocator.alloc(SegregatedListAllocator::DEFAULT_MMAP_THRESHOLD);
+    if(!getHeader(below)->isMapped() && getHeader(above)->isMapped()) {
+        std::cout << "✓ Threshold routes requests to the heap or to mmap\n";
+    } else {
+        std::cout << "✗ Wrong path around the threshold\n";
+    }
+    
+    if(allocator.usableSize(above) % sysconf(_SC_PAGESIZE) == (size_t)sysconf(_SC_PAGESIZE) - HEADER_SIZE) {
+        std::cout << "✓ Mapped block rounded up to whole pages\n";
+    } else {
+        std::cout << "✗ Mapped block size not page rounded\n";
+    }
+    allocator.free(below);
+    allocator.free(above);
+    
+    // A transient 64 MB buffer must not raise RSS for good
+    const size_t BIG = 64 * 1024 * 1024;
+    size_t before = residentBytes();
+    word_t* big = allocator.alloc(BIG);
+    memset(big, 1, BIG);
+    size_t peak = residentBytes();
+    allocator.free(big);
+    size_t after = residentBytes();
+    
+    if(peak - before >= BIG && after < before + BIG / 16) {
+        std::cout << "✓ RSS returns after freeing a 64 MB buffer (peak +"
+                  << (peak - before) / (1024 * 1024) << " MB)\n";
+    } else {
+        std::cout << "✗ RSS stayed high: before " << before / 1024 << " KB, after " << after / 1024 << " KB\n";
+    }
+    
+    // The threshold is configurable, 0 keeps everything in the heap
+    allocator.mmapThreshold = 0;
+    word_t* inHeap = allocator.alloc(1024 * 1024);
+    if(!getHeader(inHeap)->isMapped()) {
+        std::cout << "✓ Direct mapping can be turned off\n";
+    } else {
+        std::cout << "✗ Threshold 0 still mapped the block\n";
+    }
+    allocator.free(inHeap);
+}
+
+void testAlignedAllocation() {
+    printSeparator("Testing Aligned Allocation");
+    
+    SegregatedListAllocator allocator;
+    
+    word_t* small = allocator.allocAligned(8, 64);
+    if(allocator.isSlabObject(small) && (uintptr_t)small % 64 == 0) {
+        std::cout << "✓ Small aligned request served by a wide enough slab class\n";
+    } else {
+        std::cout << "✗ Small aligned request misplaced\n";
+    }
+    
+    bool aligned = true, tight = true;
+    std::vector<word_t*> blocks;
+    for(size_t alignment = 16; alignment <= 4096; alignment *= 2) {
+        word_t* data = allocator.allocAligned(200, alignment);
+        if(!data || (uintptr_t)data % alignment) aligned = false;
+        else if(allocator.usableSize(data) >= 200 + HEADER_SIZE + 128) tight = false; //smaller slack stays on
+
+        blocks.push_back(data);
+    }
+    if(aligned && tight) {
+        std::cout << "✓ Heap blocks aligned from 16 bytes to a page, slack returned to the buckets\n";
+    } else {
+        std::cout << "✗ Heap blocks misaligned or holding their slack\n";
+    }
+    
+    // The slack in front of the page-aligned block serves later requests
+    word_t* reused = allocator.alloc(1024);
+    if(reused < blocks.back()) {
+        std::cout << "✓ Leading slack reused by a later allocation\n";
+    } else {
+        std::cout << "✗ Leading slack not reused\n";
+    }
+    allocator.free(reused);
+    for(word_t* data : blocks) allocator.free(data);
+    allocator.free(small);
+    
+    // Aligned blocks given back are found again, the heap stops growing
+    SegregatedListAllocator churn;
+    std::vector<word_t*> held;
+    for(int i = 0; i < 1000; i++) {
+        churn.free(churn.allocAligned(100, 64));
+        held.push_back(churn.allocAligned(100 + i % 300, 16 << (i % 5)));
+    }
+    for(word_t* data : held) churn.free(data);
+    uint64_t settled = churn.heapStats().osBytes;
+    for(int i = 0; i < 300000; i++) {
+        churn.free(churn.allocAligned(100, 64));
+    }
+    uint64_t growth = churn.heapStats().osBytes - settled;
+    if(growth == 0) {
+        std::cout << "✓ 300k aligned alloc/free pairs reuse their blocks, no heap growth\n";
+    } else {
+        std::cout << "✗ Heap grew " << growth << " bytes under aligned churn\n";
+    }
+
+    // Mapped blocks keep their alignment through mremap
+    word_t* mapped = allocator.allocAligned(SegregatedListAllocator::DEFAULT_MMAP_THRESHOLD, 4096);
+    bool mappedAligned = getHeader(mapped)->isMapped() && (uintptr_t)mapped % 4096 == 0;
+    memset(mapped, 0x3C, 100);
+    word_t* grown = allocator.realloc(mapped, 16 * SegregatedListAllocator::DEFAULT_MMAP_THRESHOLD);
+    if(mappedAligned && (uintptr_t)grown % 4096 == 0 && ((unsigned char*)grown)[99] == 0x3C) {
+        std::cout << "✓ Mapped block page aligned, alignment kept by mremap\n";
+    } else {
+        std::cout << "✗ Mapped block lost its alignment\n";
+    }
+    allocator.free(grown);
+    
+    if(!allocator.allocAligned(64, 24) && !allocator.allocAligned(64, 8192)) {
+        std::cout << "✓ Alignments that are not a power of two up to a page rejected\n";
+    } else {
+        std::cout << "✗ Invalid alignment accepted\n";
+    }
+
+    // Without mappings a huge size reaches the heap path, which must not wrap it
+    SegregatedListAllocator unmapped;
+    unmapped.mmapThreshold = 0;
+    if(!unmapped.allocAligned(SIZE_MAX - 3, 64) && !allocator.allocAligned(SIZE_MAX - 3, 64)) {
+        std::cout << "✓ Sizes that would wrap once aligned or padded rejected\n";
+    } else {
+        std::cout << "✗ Oversized aligned request got a block\n";
+    }
+}
+
+void testBatch() {
+    printSeparator("Testing Batch Alloc And Free");
+    
+    SegregatedListAllocator allocator;
+    const size_t COUNT = 600;
+    std::vector<word_t*> out(COUNT);
+    
+    for(size_t size : {24, 100, 300}) {
+        size_t got = allocator.allocBatch(size, COUNT, out.data());
+        bool ok = got == COUNT;
+        for(size_t i = 0; ok && i < COUNT; i++) {
+            if(allocator.usableSize(out[i]) < size) ok = false;
+            else memset(out[i], (unsigned char)i, size);
+        }
+        for(size_t i = 0; ok && i < COUNT; i++) {
+            unsigned char* bytes = (unsigned char*)out[i];
+            if(bytes[0] != (unsigned char)i || bytes[size - 1] != (unsigned char)i) ok = false;
+        }
+        
+        std::vector<word_t*> sorted(out);
+        std::sort(sorted.begin(), sorted.end());
+        bool distinct = std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+        
+        allocator.freeBatch(out.data(), COUNT);
+        std::vector<word_t*> again(COUNT);
+        allocator.allocBatch(size, COUNT, again.data());
+        std::sort(again.begin(), again.end());
+        std::vector<word_t*> common;
+        std::set_intersection(sorted.begin(), sorted.end(), again.begin(), again.end(), std::back_inserter(common));
+        // a slab batch fills the run the last one left partly used first
+        bool reused = size <= SlabAllocator::MAX_SIZE ? common.size() * 4 >= COUNT * 3 : common.size() == COUNT;
+        
+        if(ok && distinct && reused) {
+            std::cout << "✓ " << COUNT << " blocks of " << size << " bytes allocated, freed and reused as a batch\n";
+        } else {
+            std::cout << "✗ Batch of " << size << " bytes broken (ok " << ok << ", distinct " << distinct
+                      << ", reused " << reused << ")\n";
+        }
+        allocator.freeBatch(again.data(), COUNT);
+    }
+    
+    // Blocks carved in one pass sit back to back
+    size_t got = allocator.allocBatch(2000, 64, out.data());
+    bool packed = got == 64;
+    for(size_t i = 1; packed && i < 64; i++) {
+        if((char*)out[i] - (char*)out[i - 1] != (long)(2000 + HEADER_SIZE)) packed = false;
+    }
+    if(packed) {
+        std::cout << "✓ Fresh batch cut from one block in a single pass\n";
+    } else {
+        std::cout << "✗ Fresh batch not contiguous\n";
+    }
+    allocator.freeBatch(out.data(), 64);
+    
+    // One freeBatch takes slab objects, bucket blocks and mappings alike
+    word_t* mixed[] = {allocator.alloc(8), allocator.alloc(16), allocator.alloc(90), allocator.alloc(5000),
+                       allocator.alloc(SegregatedListAllocator::DEFAULT_MMAP_THRESHOLD), allocator.alloc(40)};
+    allocator.freeBatch(mixed, 6);
+    if(allocator.alloc(90) == mixed[2] && allocator.alloc(8) == mixed[0]) {
+        std::cout << "✓ Mixed batch freed to slabs, buckets and the OS\n";
+    } else {
+        std::cout << "✗ Mixed batch not freed\n";
+    }
+}
+
+void testSizedFree() {
+    printSeparator("Testing Sized Free");
+    
+    SegregatedListAllocator allocator;
+    
+    // Every path takes the size instead of the header
+    word_t* slab = allocator.alloc(40);
+    word_t* bucket = allocator.alloc(100);
+    word_t* large = allocator.alloc(1000);
+    word_t* mapped = allocator.alloc(SegregatedListAllocator::DEFAULT_MMAP_THRESHOLD);
+    allocator.free(slab, 40);
+    allocator.free(bucket, 100);
+    allocator.free(large, 1000);
+    allocator.free(mapped, SegregatedListAllocator::DEFAULT_MMAP_THRESHOLD);
+    
+    if(allocator.alloc(40) == slab && allocator.alloc(120) == bucket && allocator.alloc(1000) == large) {
+        std::cout << "✓ Slab, bucket and large blocks freed by size and reused\n";
+    } else {
+        std::cout << "✗ Sized free lost a block\n";
+    }
+    
+    // A block shrunk in place is still at least as big as the bucket of its new size
+    word_t* shrunk = allocator.realloc(allocator.alloc(120), 70);
+    allocator.free(shrunk, 70);
+    if(allocator.alloc(128) == shrunk) {
+        std::cout << "✓ Shrunk block freed to the bucket of its new size\n";
+    } else {
+        std::cout << "✗ Shrunk block not reused\n";
+    }
+    
+    // The short last piece of a batch, resized and freed by size, never serves a larger class
+    SegregatedListAllocator heap;
+    heap.useSlabs = false;
+    word_t* pieces[2];
+    heap.allocBatch(16, 2, pieces);
+    word_t* resized = heap.realloc(pieces[1], 34);
+    heap.free(resized, 34);
+    word_t* wide[4];
+    size_t got = heap.allocBatch(64, 4, wide);
+    bool fits = got == 4;
+    for(size_t i = 0; i < got; i++) {
+        fits = fits && heap.usableSize(wide[i]) >= 64;
+        memset(wide[i], 0x3C, 64);
+    }
+    if(fits && heap.usableSize(resized) >= 64) {
+        std::cout << "✓ Batch, shrink and sized free keep every block within its class\n";
+    } else {
+        std::cout << "✗ A batch got a block smaller than its class\n";
+    }
+
+    // With the check on, a size the block cannot hold aborts
+    pid_t child = fork();
+    if(child == 0) {
+        allocator.verifySizedFree = true;
+        word_t* ok = allocator.alloc(100);
+        allocator.free(ok, 100);
+        word_t* wrong = allocator.alloc(100);
+        freopen("/dev/null", "w", stderr);
+        allocator.free(wrong, 300);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    if(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT) {
+        std::cout << "✓ verifySizedFree aborts on a size the block cannot hold\n";
+    } else {
+        std::cout << "✗ Wrong size went unnoticed\n";
+    }
+}
+
+void testTrim() {
+    printSeparator("Testing Trim");
+    
+    // Heap blocks below the mapping threshold are purged in place, a used block behind
+    // them keeps the merged free block from being given back as the heap's top
+    SegregatedListAllocator allocator;
+    const size_t SIZE = 100 * 1024;
+    std::vector<word_t*> blocks;
+    for(int i = 0; i < 32; i++) {
+        blocks.push_back(allocator.alloc(SIZE));
+        memset(blocks.back(), 0x5A, SIZE);
+    }
+    word_t* fence = allocator.alloc(1000);
+    
+    size_t before = residentBytes();
+    for(word_t* ptr : blocks) allocator.free(ptr);
+    size_t purged = allocator.trim();
+    size_t after = residentBytes();
+    
+    if(purged >= 32 * (SIZE - 2 * sysconf(_SC_PAGESIZE)) && after + 16 * SIZE < before) {
+        std::cout << "✓ Trim purged " << purged / 1024 << " KB of free bucket blocks\n";
+    } else {
+        std::cout << "✗ Trim purged " << purged / 1024 << " KB, RSS " << before / 1024
+                  << " KB -> " << after / 1024 << " KB\n";
+    }
+    
+    word_t* reused = allocator.alloc(SIZE);
+    memset(reused, 1, SIZE);
+    if(std::find(blocks.begin(), blocks.end(), reused) != blocks.end()) {
+        std::cout << "✓ Purged blocks stay on their bucket and are reused\n";
+    } else {
+        std::cout << "✗ Purged block was not reused\n";
+    }
+    allocator.free(reused);
+    allocator.free(fence);
+}
+
+void testRealloc() {
+    printSeparator("Testing Realloc");
+    
+    SegregatedListAllocator allocator;
+    
+    // Slack inside the size class is used in place
+    word_t* small = allocator.alloc(40);
+    memset(small, 0x11, 40);
+    if(allocator.realloc(small, 64) == small) {
+        std::cout << "✓ Grow within the size class stays in place\n";
+    } else {
+        std::cout << "✗ Grow within the size class moved\n";
+    }
+    
+    // Crossing classes moves and keeps the contents
+    word_t* bigger = allocator.realloc(small, 500);
+    if(bigger != small && ((unsigned char*)bigger)[39] == 0x11) {
+        std::cout << "✓ Grow across classes copied the contents\n";
+    } else {
+        std::cout << "✗ Contents lost when moving between classes\n";
+    }
+    
+    // A large block hands its tail back to the buckets
+    word_t* large = allocator.alloc(4000);
+    word_t* trimmed = allocator.realloc(large, 1000);
+    if(trimmed == large && allocator.usableSize(trimmed) == 1000) {
+        std::cout << "✓ Shrink split the large block in place\n";
+    } else {
+        std::cout << "✗ Large block not trimmed\n";
+    }
+
+    // Shrinking into a small class cuts the block down to that class
+    word_t* huge = allocator.alloc(100 * 1024);
+    word_t* tiny = allocator.realloc(huge, 16);
+    word_t* reuse = allocator.alloc(90 * 1024);
+    size_t kept = allocator.usableSize(tiny);
+    if(tiny == huge && kept < 64 && (char*)reuse == (char*)tiny + kept + HEADER_SIZE) {
+        std::cout << "✓ Shrink to a small class gave the tail back\n";
+    } else {
+        std::cout << "✗ Shrink to a small class pinned " << allocator.usableSize(tiny) << " bytes\n";
+    }
+    allocator.free(reuse);
+    allocator.free(tiny, 16);
+
+    // Blocks of the merging heap grow at its top and into a free successor
+    word_t* first = allocator.alloc(1000);
+    word_t* second = allocator.alloc(1000);
+    memset(second, 0x22, 1000);
+    word_t* grownTop = allocator.realloc(second, 4000);
+    word_t* fence = allocator.alloc(1000);
+    allocator.free(grownTop);
+    word_t* grownNext = allocator.realloc(first, 1900);
+    if(grownTop == second && ((unsigned char*)grownTop)[999] == 0x22 && grownNext == first &&
+       allocator.usableSize(grownNext) >= 1900) {
+        std::cout << "✓ Large blocks grew in place at the top and into a free neighbour\n";
+    } else {
+        std::cout << "✗ Large block growth moved the block\n";
+    }
+    allocator.free(grownNext);
+    allocator.free(fence);
+
+    word_t* untouched = allocator.alloc(1000);
+    if(allocator.realloc(untouched, SIZE_MAX - 3) == nullptr && allocator.usableSize(untouched) == 1000) {
+        std::cout << "✓ Oversized realloc fails with the block intact\n";
+    } else {
+        std::cout << "✗ Oversized realloc changed the block\n";
+    }
+    allocator.free(untouched);
+
+    // Mapped blocks grow through mremap with their contents
+    const size_t MB = 1024 * 1024;
+    word_t* mapped = allocator.realloc(trimmed, 1 * MB);
+    memset(mapped, 0x77, MB);
+    word_t* remapped = allocator.realloc(mapped, 16 * MB);
+    if(getHeader(remapped)->isMapped() && allocator.usableSize(remapped) >= 16 * MB &&
+       ((unsigned char*)remapped)[MB - 1] == 0x77) {
+        std::cout << "✓ Mapped block resized with mremap\n";
+    } else {
+        std::cout << "✗ Mapped block resize failed\n";
+    }
+    
+    // Dropping under the threshold moves back into the heap
+    word_t* back = allocator.realloc(remapped, 100);
+    if(!getHeader(back)->isMapped() && ((unsigned char*)back)[99] == 0x77) {
+        std::cout << "✓ Shrunk mapped block moved back into the heap\n";
+    } else {
+        std::cout << "✗ Shrunk mapped block stayed mapped\n";
+    }
+    
+    allocator.free(bigger);
+    allocator.free(back);
+}
+
+bool allZero(word_t* data, size_t bytes) {
+    unsigned char* p = (unsigned char*)data;
+    for(size_t i = 0; i < bytes; i++) if(p[i]) return false;
+    return true;
+}
+
+void testCalloc() {
+    printSeparator("Testing Calloc");
+    
+    SegregatedListAllocator allocator;
+    
+    // Every path returns zeroed memory, also after the memory was dirtied and recycled
+    size_t sizes[] = {24, 100, 1000, 64 * 1024, 1024 * 1024};
+    bool zeroed = true;
+    for(size_t size : sizes) {
+        for(int round = 0; round < 2; round++) {
+            word_t* ptr = allocator.calloc(1, size);
+            if(!ptr || !allZero(ptr, size)) zeroed = false;
+            memset(ptr, 0xCD, size);
+            allocator.free(ptr);
+        }
+    }
+    if(zeroed) {
+        std::cout << "✓ Slab, bucket and mapped calloc return zeroed memory, fresh and recycled\n";
+    } else {
+        std::cout << "✗ calloc returned dirty memory\n";
+    }
+    
+    // Large fresh buffers are not touched: RSS grows only as they are written
+    size_t before = residentBytes();
+    word_t* big = allocator.calloc(32, 1024 * 1024);
+    size_t after = residentBytes();
+    if(big && after - before < 1024 * 1024) {
+        std::cout << "✓ 32 MB calloc faulted in no pages\n";
+    } else {
+        std::cout << "✗ calloc touched the fresh pages\n";
+    }
+    allocator.free(big);
+    
+    if(allocator.calloc(SIZE_MAX / 2, 4) == nullptr) {
+        std::cout << "✓ Overflowing count * size rejected\n";
+    } else {
+        std::cout << "✗ Overflow not detected\n";
+    }
+}
+
 void testZeroAndLargeAllocations() {
     printSeparator("Testing Edge Cases");
     
@@ -265,6 +863,15 @@ int main() {
     testBucketDistribution();
     testMultipleAllocationsPerBucket();
     testFragmentationReduction();
+    testBorrowFromLargerBuckets();
+    testSlabRuns();
+    testDirectMapping();
+    testAlignedAllocation();
+    testBatch();
+    testSizedFree();
+    testTrim();
+    testRealloc();
+    testCalloc();
     testZeroAndLargeAllocations();
     
     std::cout << "\n=== All Tests Completed ===\n";
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <memory_resource>
+#include "std_allocator.h"
+#include "bump_allocator.h"
+#include "explicit_allocator.h"
+#include "segregated_allocator.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+struct alignas(64) CacheLine {
+    char bytes[64];
+};
+
+template<class Heap>
+void testContainers(const std::string& name) {
+    printSeparator("Testing Containers on " + name);
+
+    Heap heap;
+
+    std::vector<int, HeapAllocator<int, Heap>> numbers{HeapAllocator<int, Heap>(heap)};
+    for(int i = 0; i < 10000; i++) numbers.push_back(i);
+
+    bool intact = true;
+    for(int i = 0; i < 10000; i++) intact = intact && numbers[i] == i;
+    if(intact) {
+        std::cout << "✓ vector grew through the adapter\n";
+    } else {
+        std::cout << "✗ vector lost its contents\n";
+    }
+
+    using Pair = std::pair<const int, int>;
+    std::map<int, int, std::less<int>, HeapAllocator<Pair, Heap>> squares{HeapAllocator<Pair, Heap>(heap)};
+    for(int i = 0; i < 1000; i++) squares[i] = i * i;
+    for(int i = 0; i < 1000; i += 2) squares.erase(i);
+
+    if(squares.size() == 500 && squares[999] == 999 * 999) {
+        std::cout << "✓ map nodes allocated and freed through the rebound adapter\n";
+    } else {
+        std::cout << "✗ map contents wrong\n";
+    }
+
+    std::vector<CacheLine, HeapAllocator<CacheLine, Heap>> lines{HeapAllocator<CacheLine, Heap>(heap)};
+    lines.resize(10);
+    lines.resize(100);
+    if((uintptr_t)lines.data() % alignof(CacheLine) == 0) {
+        std::cout << "✓ Over-aligned element type placed on a 64-byte boundary\n";
+    } else {
+        std::cout << "✗ Over-aligned elements misplaced\n";
+    }
+}
+
+template<class Heap>
+void testResource(const std::string& name) {
+    printSeparator("Testing memory_resource on " + name);
+
+    Heap heap;
+    HeapResource<Heap> resource(heap);
+
+    std::pmr::vector<std::pmr::string> words(&resource);
+    for(int i = 0; i < 1000; i++) {
+        words.emplace_back("a string long enough to need its own buffer #" + std::to_string(i));
+    }
+
+    if(words.size() == 1000 && words[999].get_allocator().resource() == &resource) {
+        std::cout << "✓ Nested pmr containers share the resource\n";
+    } else {
+        std::cout << "✗ Resource not propagated\n";
+    }
+
+    bool aligned = true;
+    for(size_t alignment : {16, 64, 256, 4096}) {
+        void* ptr = resource.allocate(100, alignment);
+        aligned = aligned && (uintptr_t)ptr % alignment == 0;
+        resource.deallocate(ptr, 100, alignment);
+    }
+    if(aligned) {
+        std::cout << "✓ allocate honours alignments up to a page\n";
+    } else {
+        std::cout << "✗ Alignment not honoured\n";
+    }
+
+    HeapResource<Heap> sameHeap(heap);
+    Heap otherHeap;
+    HeapResource<Heap> other(otherHeap);
+    if(resource == sameHeap && resource != other && resource != *std::pmr::new_delete_resource()) {
+        std::cout << "✓ Resources compare equal only over the same heap\n";
+    } else {
+        std::cout << "✗ Resource equality wrong\n";
+    }
+}
+
+void testAllocatorFailure() {
+    printSeparator("Testing Allocation Failure");
+
+    static char buffer[64 * 1024];
+    BufferChunkProvider provider(buffer, sizeof(buffer));
+    ExplicitAllocator heap(&provider);
+    HeapAllocator<int, ExplicitAllocator> allocator(heap);
+
+    try {
+        allocator.allocate(1024 * 1024);
+        std::cout << "✗ Exhausted heap returned memory\n";
+    } catch(const std::bad_alloc&) {
+        std::cout << "✓ Exhausted heap throws std::bad_alloc\n";
+    }
+
+    try {
+        allocator.allocate(SIZE_MAX / 2);
+        std::cout << "✗ Overflowing count returned memory\n";
+    } catch(const std::bad_array_new_length&) {
+        std::cout << "✓ Overflowing count throws std::bad_array_new_length\n";
+    }
+}
+
+int main() {
+    std::cout << "Starting Standard Adapter Tests\n";
+    std::cout << "===============================\n";
+
+    testContainers<BumpAllocator>("BumpAllocator");
+    testContainers<ExplicitAllocator>("ExplicitAllocator");
+    testContainers<SegregatedListAllocator>("SegregatedListAllocator");
+    testResource<BumpAllocator>("BumpAllocator");
+    testResource<ExplicitAllocator>("ExplicitAllocator");
+    testResource<SegregatedListAllocator>("SegregatedListAllocator");
+    testAllocatorFailure();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "thread_cache.h"
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+void testBasicAllocation() {
+    printSeparator("Testing Basic Allocation");
+
+    ThreadCachedAllocator allocator;
+
+    word_t* ptr8 = allocator.alloc(8);
+    word_t* ptr64 = allocator.alloc(64);
+    word_t* ptr128 = allocator.alloc(128);
+    word_t* ptr1k = allocator.alloc(1024); //shared path
+
+    if(ptr8 && ptr64 && ptr128 && ptr1k) {
+        std::cout << "✓ Cached and shared allocations successful\n";
+    } else {
+        std::cout << "✗ Some allocations failed\n";
+    }
+
+    *ptr8 = 1; *ptr64 = 2; *ptr128 = 3; *ptr1k = 4;
+    if(*ptr8 == 1 && *ptr64 == 2 && *ptr128 == 3 && *ptr1k == 4) {
+        std::cout << "✓ Memory write/read successful\n";
+    } else {
+        std::cout << "✗ Memory write/read failed\n";
+    }
+
+    allocator.free(ptr8);
+    allocator.free(ptr64);
+    allocator.free(ptr128);
+    allocator.free(ptr1k);
+    std::cout << "✓ All deallocations completed\n";
+}
+
+void testCacheReuse() {
+    printSeparator("Testing Cache Reuse");
+
+    ThreadCachedAllocator allocator;
+
+    word_t* first = allocator.alloc(24);
+    allocator.free(first);
+    word_t* second = allocator.alloc(20); //same bucket (17..32)
+
+    if(first == second) {
+        std::cout << "✓ Freed block served again from the thread cache\n";
+    } else {
+        std::cout << "✗ Freed block was not reused\n";
+    }
+
+    if(allocator.usableSize(second) >= ThreadCachedAllocator::cachedSize(2)) {
+        std::cout << "✓ Cached block covers the whole bucket\n";
+    } else {
+        std::cout << "✗ Cached block is smaller than its bucket\n";
+    }
+
+    allocator.free(second);
+}
+
+void testFlushOnCapacity() {
+    printSeparator("Testing Flush On Capacity");
+
+    ThreadCachedAllocator allocator;
+    std::vector<word_t*> ptrs;
+
+    //more than a cache can hold, so frees must flush back to the shared lists
+    for(int i = 0; i < 4 * ThreadCachedAllocator::CACHE_CAPACITY; i++) {
+        word_t* ptr = allocator.alloc(16);
+        if(!ptr) break;
+        *ptr = i;
+        ptrs.push_back(ptr);
+    }
+    std::cout << "✓ Allocated " << ptrs.size() << " blocks in bucket 1\n";
+
+    for(word_t* ptr : ptrs) {
+        allocator.free(ptr);
+    }
+    std::cout << "✓ Freed all blocks with batched flushes\n";
+
+    allocator.flushThreadCache();
+
+    size_t reused = 0;
+    for(size_t i = 0; i < ptrs.size(); i++) {
+        word_t* ptr = allocator.alloc(16);
+        for(word_t* old : ptrs) {
+            if(old == ptr) { reused++; break; }
+        }
+    }
+
+    if(reused == ptrs.size()) {
+        std::cout << "✓ Flushed blocks reused from the shared lists\n";
+    } else {
+        std::cout << "✗ Only " << reused << "/" << ptrs.size() << " blocks reused\n";
+    }
+}
+
+void testSizedFree() {
+    printSeparator("Testing Sized Free");
+
+    ThreadCachedAllocator allocator;
+
+    word_t* block = allocator.alloc(100);
+    allocator.free(block, 100);
+    if(allocator.alloc(128) == block) { //same bucket (65..128)
+        std::cout << "✓ Sized free cached the block in the bucket of its size\n";
+    } else {
+        std::cout << "✗ Sized free missed the bucket\n";
+    }
+    allocator.free(block, 128);
+
+    //flushed blocks reach the shared lists by their bucket size as well
+    std::vector<word_t*> ptrs;
+    for(int i = 0; i < 4 * ThreadCachedAllocator::CACHE_CAPACITY; i++) ptrs.push_back(allocator.alloc(100));
+    for(word_t* ptr : ptrs) allocator.free(ptr, 100);
+    allocator.flushThreadCache();
+
+    size_t reused = 0;
+    for(size_t i = 0; i < ptrs.size(); i++) {
+        word_t* ptr = allocator.alloc(100);
+        for(word_t* old : ptrs) {
+            if(old == ptr) { reused++; break; }
+        }
+    }
+
+    if(reused == ptrs.size()) {
+        std::cout << "✓ Blocks flushed by size reused from the shared lists\n";
+    } else {
+        std::cout << "✗ Only " << reused << "/" << ptrs.size() << " blocks reused\n";
+    }
+}
+
+void testMultipleThreads() {
+    printSeparator("Testing Multiple Threads");
+
+    ThreadCachedAllocator allocator;
+    std::atomic<int> corrupted{0};
+    std::atomic<int> failed{0};
+    const int NUM_THREADS = 8;
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&allocator, &corrupted, &failed, t]() {
+            std::vector<word_t*> live;
+            for(int i = 0; i < 20000; i++) {
+                size_t size = 8 + (i * 7 + t) % 200;
+                word_t* ptr = allocator.alloc(size);
+                if(!ptr) { failed++; continue; }
+                *ptr = t * 1000000 + i;
+                live.push_back(ptr);
+
+                if(live.size() > 64) {
+                    word_t* victim = live[i % live.size()];
+                    live[i % live.size()] = live.back();
+                    live.pop_back();
+                    allocator.free(victim);
+                }
+            }
+            for(word_t* ptr : live) {
+                if(*ptr / 1000000 != t) corrupted++;
+                allocator.free(ptr);
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    if(failed == 0) {
+        std::cout << "✓ All allocations from " << NUM_THREADS << " threads successful\n";
+    } else {
+        std::cout << "✗ " << failed << " allocations failed\n";
+    }
+
+    if(corrupted == 0) {
+        std::cout << "✓ No block shared between threads\n";
+    } else {
+        std::cout << "✗ " << corrupted << " blocks were overwritten by another thread\n";
+    }
+}
+
+void testThreadExitDrain() {
+    printSeparator("Testing Thread Exit Drain");
+
+    ThreadCachedAllocator allocator;
+    word_t* cached = nullptr;
+
+    std::thread worker([&allocator, &cached]() {
+        cached = allocator.alloc(64);
+        allocator.free(cached); //stays in the worker's cache until it exits
+    });
+    worker.join();
+
+    //the worker's batch went back to the shared lists, so this refill picks it up
+    bool found = false;
+    std::vector<word_t*> ptrs;
+    for(int i = 0; i < ThreadCachedAllocator::BATCH_SIZE * 2 && !found; i++) {
+        word_t* ptr = allocator.alloc(64);
+        ptrs.push_back(ptr);
+        found = (ptr == cached);
+    }
+
+    if(found) {
+        std::cout << "✓ Exiting thread's cache drained to the shared lists\n";
+    } else {
+        std::cout << "✗ Exiting thread's cache was lost\n";
+    }
+
+    for(word_t* ptr : ptrs) allocator.free(ptr);
+}
+
+//workers exit while their allocator is destroyed: each drain either finishes before the
+//destructor frees the slot or sees the slot gone, never runs into a dead allocator
+void testExitDuringDestruction() {
+    printSeparator("Testing Thread Exit During Destruction");
+
+    for(int round = 0; round < 50; round++) {
+        ThreadCachedAllocator* allocator = new ThreadCachedAllocator();
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+
+        std::vector<std::thread> workers;
+        for(int t = 0; t < 4; t++) {
+            workers.emplace_back([allocator, &ready, &go]() {
+                allocator->free(allocator->alloc(32)); //leaves a batch in this thread's cache
+                ready.fetch_add(1);
+                while(!go.load()) std::this_thread::yield();
+            });
+        }
+
+        while(ready.load() < 4) std::this_thread::yield();
+        go.store(true);
+        delete allocator;
+        for(auto& worker : workers) worker.join();
+    }
+
+    std::cout << "✓ 50 rounds of threads exiting while their allocator is destroyed\n";
+}
+
+int main() {
+    std::cout << "Starting Thread Cache Tests\n";
+    std::cout << "===========================\n";
+
+    testBasicAllocation();
+    testCacheReuse();
+    testFlushOnCapacity();
+    testSizedFree();
+    testMultipleThreads();
+    testThreadExitDrain();
+    testExitDuringDestruction();
+
+    std::cout << "\n=== All Tests Completed ===\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include <cstring>
+#include "tlsf_allocator.h"
+#include "block_utils.h"
+
+// Global allocator instance
+TlsfAllocator allocator;
+
+// Test helper functions
+void printHeapState() {
+    std::cout << "\n--- Heap State ---\n";
+    std::cout << "First-level bitmap: 0x" << std::hex << allocator.flBitmap << std::dec << "\n";
+    for(int fl = 0; fl < TlsfAllocator::FL_INDEX_COUNT; fl++) {
+        if(!allocator.slBitmap[fl]) continue;
+        for(int sl = 0; sl < TlsfAllocator::SL_INDEX_COUNT; sl++) {
+            Block* current = allocator.freeLists[fl][sl];
+            if(!current) continue;
+            std::cout << "[" << fl << "][" << sl << "]: ";
+            int count = 0;
+            while(current && count < 20) {  // Limit iterations!
+                std::cout << "[" << current << ": size=" << current->size() << "] -> ";
+                current = current->next;
+                count++;
+            }
+            if(count >= 20) std::cout << "... (INFINITE LOOP DETECTED!)";
+            std::cout << "NULL\n";
+        }
+    }
+}
+
+void resetHeap() {
+    // Simple reset - in practice you'd need proper cleanup
+    allocator.flBitmap = 0;
+    for(int fl = 0; fl < TlsfAllocator::FL_INDEX_COUNT; fl++) {
+        allocator.slBitmap[fl] = 0;
+        for(int sl = 0; sl < TlsfAllocator::SL_INDEX_COUNT; sl++) {
+            allocator.freeLists[fl][sl] = nullptr;
+        }
+    }
+    allocator.heapStart = nullptr;
+    allocator.top = nullptr;
+}
+
+// Every free block must sit in the list its size maps to and both bitmaps must agree
+bool checkIndex() {
+    for(int fl = 0; fl < TlsfAllocator::FL_INDEX_COUNT; fl++) {
+        bool flSet = allocator.flBitmap & (1u << fl);
+        if(flSet != (allocator.slBitmap[fl] != 0)) return false;
+
+        for(int sl = 0; sl < TlsfAllocator::SL_INDEX_COUNT; sl++) {
+            Block* current = allocator.freeLists[fl][sl];
+            bool slSet = allocator.slBitmap[fl] & (1u << sl);
+            if(slSet != (current != nullptr)) return false;
+
+            while(current) {
+                int blockFl, blockSl;
+                allocator.mappingInsert(current->size(), blockFl, blockSl);
+                if(blockFl != fl || blockSl != sl || current->isUsed()) return false;
+                current = current->next;
+            }
+        }
+    }
+    return true;
+}
+
+// Walks the physical heap: no two free neighbours, prevUsed bits match
+bool checkHeap(int* freeBlocks = nullptr) {
+    Block* block = allocator.heapStart;
+    bool prevUsed = true;
+    int free = 0;
+
+    while(block) {
+        if(block->isPrevUsed() != prevUsed) return false;
+        if(!block->isUsed()) {
+            if(!prevUsed) return false;
+            free++;
+        }
+        prevUsed = block->isUsed();
+        block = allocator.getPhysicalNextBlock(block);
+    }
+
+    if(freeBlocks) *freeBlocks = free;
+    return true;
+}
+
+// Test the two-level size mapping
+void testMapping() {
+    std::cout << "\n=== Testing Size Mapping ===\n";
+
+    int fl, sl;
+    allocator.mappingInsert(24, fl, sl);
+    assert(fl == 0 && sl == 3);
+    allocator.mappingInsert(120, fl, sl);
+    assert(fl == 0 && sl == 15);
+    std::cout << "✓ Small sizes map linearly into first level 0\n";
+
+    allocator.mappingInsert(128, fl, sl);
+    assert(fl == 1 && sl == 0);
+    allocator.mappingInsert(256, fl, sl);
+    assert(fl == 2 && sl == 0);
+    allocator.mappingInsert(256 + 3 * 16, fl, sl);
+    assert(fl == 2 && sl == 3);
+    std::cout << "✓ Large sizes map to power of two and linear subdivision\n";
+
+    allocator.mappingSearch(256 + 1, fl, sl);
+    assert(fl == 2 && sl == 1);
+    allocator.mappingSearch(256 + 16, fl, sl);
+    assert(fl == 2 && sl == 1);
+    std::cout << "✓ Search rounds up to the next list boundary\n";
+}
+
+// Test basic allocation and deallocation
+void testBasicAllocation() {
+    std::cout << "\n=== Testing Basic Allocation ===\n";
+    resetHeap();
+
+    word_t* ptr1 = allocator.alloc(64);
+    assert(ptr1 != nullptr);
+    std::cout << "✓ Basic allocation successful\n";
+
+    *ptr1 = 0xDEADBEEF;
+    assert(*ptr1 == 0xDEADBEEF);
+    std::cout << "✓ Memory write/read successful\n";
+
+    word_t* ptr2 = allocator.alloc(128);
+    word_t* ptr3 = allocator.alloc(256);
+    assert(ptr2 != nullptr && ptr3 != nullptr);
+    assert(ptr1 != ptr2 && ptr2 != ptr3 && ptr1 != ptr3);
+    std::cout << "✓ Multiple allocations successful\n";
+
+    allocator.free(ptr2);
+    assert(allocator.flBitmap != 0);
+    assert(checkIndex() && checkHeap());
+    std::cout << "✓ Deallocation successful\n";
+
+    word_t* ptr4 = allocator.alloc(128);
+    assert(ptr4 == ptr2);
+    assert(allocator.flBitmap == 0);
+    std::cout << "✓ Freed block reused, bitmaps cleared\n";
+    printHeapState();
+}
+
+// Test splitting of larger free blocks
+void testSplitting() {
+    std::cout << "\n=== Testing Block Splitting ===\n";
+    resetHeap();
+
+    word_t* large = allocator.alloc(1024);
+    word_t* guard = allocator.alloc(16);
+    allocator.free(large);
+
+    word_t* small = allocator.alloc(64);
+    assert(small == large);
+    assert(getHeader(small)->size() == 64);
+
+    Block* remainder = allocator.getPhysicalNextBlock(getHeader(small));
+    assert(!remainder->isUsed() && remainder->isPrevUsed());
+    assert(remainder->size() == 1024 - 64 - HEADER_SIZE);
+    assert(checkIndex() && checkHeap());
+    std::cout << "✓ Split leaves an indexed remainder\n";
+
+    allocator.free(small);
+    allocator.free(guard);
+    int freeBlocks = 0;
+    assert(checkIndex() && checkHeap(&freeBlocks));
+    assert(freeBlocks == 1);
+    std::cout << "✓ Freeing everything merges back into one block\n";
+}
+
+// Test immediate coalescing with both neighbours
+void testCoalescing() {
+    std::cout << "\n=== Testing Coalescing ===\n";
+    resetHeap();
+
+    word_t* ptr1 = allocator.alloc(100);
+    word_t* ptr2 = allocator.alloc(100);
+    word_t* ptr3 = allocator.alloc(100);
+    word_t* ptr4 = allocator.alloc(100);
+
+    allocator.free(ptr1);
+    allocator.free(ptr3);
+    int freeBlocks = 0;
+    assert(checkIndex() && checkHeap(&freeBlocks));
+    assert(freeBlocks == 2);
+    std::cout << "✓ Non-adjacent frees stay separate\n";
+
+    // ptr2 sits between two free blocks
+    allocator.free(ptr2);
+    assert(checkIndex() && checkHeap(&freeBlocks));
+    assert(freeBlocks == 1);
+
+    Block* merged = getHeader(ptr1);
+    assert(merged->size() == 3 * 104 + 2 * HEADER_SIZE);
+    assert(getHeader(ptr4)->isUsed() && !getHeader(ptr4)->isPrevUsed());
+    std::cout << "✓ Block merged with both neighbours\n";
+
+    word_t* big = allocator.alloc(300);
+    assert(big == ptr1);
+    std::cout << "✓ Merged block satisfies a larger request\n";
+    printHeapState();
+}
+
+// Test edge cases
+void testEdgeCases() {
+    std::cout << "\n=== Testing Edge Cases ===\n";
+    resetHeap();
+
+    word_t* zero = allocator.alloc(0);
+    assert(zero != nullptr);
+    assert(getHeader(zero)->size() == MIN_FREE_PAYLOAD);
+    std::cout << "✓ Zero-size allocation gets the minimum block\n";
+
+    word_t* odd = allocator.alloc(13);
+    assert(reinterpret_cast<uintptr_t>(odd) % sizeof(word_t) == 0);
+    std::cout << "✓ Allocations are word aligned\n";
+
+    assert(allocator.alloc(TlsfAllocator::MAX_BLOCK_SIZE + 1) == nullptr);
+    assert(allocator.alloc(SIZE_MAX - 3) == nullptr && allocator.allocAligned(SIZE_MAX - 3, 64) == nullptr);
+    std::cout << "✓ Oversized request rejected, also where aligning it would wrap\n";
+}
+
+// Test aligned allocation
+void testAlignedAllocation() {
+    std::cout << "\n=== Testing Aligned Allocation ===\n";
+    resetHeap();
+
+    word_t* spacer = allocator.alloc(8); // the heap starts on a page, move it off
+
+    std::vector<word_t*> blocks;
+    for(size_t alignment = 16; alignment <= 4096; alignment *= 2) {
+        word_t* data = allocator.allocAligned(100, alignment);
+        assert(data != nullptr && (uintptr_t)data % alignment == 0);
+        assert(getHeader(data)->size() < 104 + HEADER_SIZE + MIN_FREE_PAYLOAD);
+        blocks.push_back(data);
+    }
+    assert(checkIndex() && checkHeap());
+    std::cout << "✓ Payloads aligned from 16 bytes to a page, slack binned\n";
+
+    // The page-aligned block leaves a large free block in front of it
+    word_t* reused = allocator.alloc(1024);
+    assert(reused < blocks.back());
+    std::cout << "✓ Leading slack reused by a later allocation\n";
+
+    allocator.free(reused);
+    for(word_t* data : blocks) allocator.free(data);
+    allocator.free(spacer);
+    int freeBlocks = 0;
+    assert(checkIndex() && checkHeap(&freeBlocks) && freeBlocks == 1);
+    std::cout << "✓ Aligned blocks free through their header and merge back\n";
+
+    assert(allocator.allocAligned(64, 24) == nullptr && allocator.allocAligned(64, 8192) == nullptr);
+    std::cout << "✓ Alignments that are not a power of two up to a page rejected\n";
+}
+
+// Merges stop at MAX_BLOCK_SIZE; the heap is reserved address space, only headers get touched
+void testLargeBlocks() {
+    std::cout << "\n=== Testing Blocks Near The Size Limit ===\n";
+
+    MmapChunkProvider provider(size_t(16) << 30);
+    TlsfAllocator heap(&provider);
+    const size_t GIB = size_t(1) << 30;
+
+    word_t* a = heap.alloc(3 * GIB);
+    word_t* b = heap.alloc(3 * GIB);
+    word_t* fence = heap.alloc(16);
+    assert(a && b && fence);
+
+    heap.free(a);
+    heap.free(b); // both together would be past the largest bin
+    assert(getHeader(a)->size() == 3 * GIB && getHeader(b)->size() == 3 * GIB);
+    assert(heap.flBitmap < (1ull << TlsfAllocator::FL_INDEX_COUNT));
+    int fl, sl;
+    heap.mappingInsert(3 * GIB, fl, sl);
+    assert(heap.freeLists[fl][sl] == getHeader(b) && getHeader(b)->next == getHeader(a));
+    std::cout << "✓ Free neighbours too large to merge stay apart in their bin\n";
+
+    word_t* again = heap.alloc(3 * GIB);
+    assert(again == b);
+    heap.free(again);
+    std::cout << "✓ Either of them serves the next large request\n";
+
+    word_t* c = heap.alloc(GIB);
+    word_t* d = heap.alloc(GIB);
+    word_t* e = heap.alloc(16);
+    assert(c && d && e);
+    heap.free(c);
+    heap.free(d);
+    assert(getHeader(c)->size() == 2 * GIB + HEADER_SIZE);
+    std::cout << "✓ Neighbours that fit one block still merge\n";
+}
+
+// Random churn keeps the index and the heap consistent
+void testStress() {
+    std::cout << "\n=== Testing Random Churn ===\n";
+    resetHeap();
+
+    const int SLOTS = 512;
+    std::vector<word_t*> live(SLOTS, nullptr);
+    std::vector<size_t> sizes(SLOTS, 0);
+    unsigned seed = 7;
+    bool intact = true;
+
+    for(int i = 0; i < 50000; i++) {
+        seed = seed * 1103515245 + 12345;
+        int slot = (seed >> 8) % SLOTS;
+
+        if(live[slot]) {
+            unsigned char tag = (unsigned char)slot;
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(live[slot]);
+            for(size_t j = 0; j < sizes[slot]; j++) {
+                if(bytes[j] != tag) intact = false;
+            }
+            allocator.free(live[slot]);
+            live[slot] = nullptr;
+        } else {
+            size_t size = 1 + (seed >> 16) % ((seed & 1) ? 4096 : 128);
+            live[slot] = allocator.alloc(size);
+            sizes[slot] = size;
+            memset(live[slot], (unsigned char)slot, size);
+        }
+
+        if(i % 5000 == 0 && !(checkIndex() && checkHeap())) intact = false;
+    }
+
+    if(intact && checkIndex() && checkHeap()) {
+        std::cout << "✓ Contents, bitmaps and heap stayed consistent\n";
+    } else {
+        std::cout << "✗ Corruption detected during churn\n";
+    }
+
+    for(int slot = 0; slot < SLOTS; slot++) {
+        if(live[slot]) allocator.free(live[slot]);
+    }
+
+    int freeBlocks = 0;
+    if(checkHeap(&freeBlocks) && freeBlocks == 1) {
+        std::cout << "✓ Heap collapses to one free block after freeing all\n";
+    } else {
+        std::cout << "✗ Heap left with " << freeBlocks << " free blocks\n";
+    }
+}
+
+int main() {
+    std::cout << "Starting TLSF Allocator Tests\n";
+    std::cout << "===================================\n";
+
+    try {
+        testMapping();
+        testBasicAllocation();
+        testSplitting();
+        testCoalescing();
+        testEdgeCases();
+        testAlignedAllocation();
+        testLargeBlocks();
+        testStress();
+
+        std::cout << "\n===================================\n";
+        std::cout << "All tests completed!\n";
+
+    } catch(const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "alloc_stats.h"
+
+AllocStats& AllocStats::operator+=(const AllocStats& other) {
+    this->allocs += other.allocs;
+    this->frees += other.frees;
+    this->splits += other.splits;
+    this->coalesces += other.coalesces;
+    this->osRequests += other.osRequests;
+    this->osBytes += other.osBytes;
+    this->liveBytes += other.liveBytes;
+    this->freeBytes += other.freeBytes;
+    this->freeBlocks += other.freeBlocks;
+    return *this;
+}
+
+AllocStats AllocCounters::read() const {
+    AllocStats stats;
+    stats.allocs = this->allocs.get();
+    stats.frees = this->frees.get();
+    stats.splits = this->splits.get();
+    stats.coalesces = this->coalesces.get();
+    stats.osRequests = this->osRequests.get();
+    stats.osBytes = this->osBytes.get();
+    stats.liveBytes = this->liveBytes.get();
+    stats.freeBytes = this->freeBytes.get();
+    stats.freeBlocks = this->freeBlocks.get();
+    return stats;
+}
+
+StatsJson::StatsJson(char* buffer, size_t capacity) : buffer(buffer), capacity(capacity) {
+    if(capacity) buffer[0] = '\0';
+}
+
+void StatsJson::put(const char* text) {
+    for(; *text; text++, this->used++) {
+        if(this->used + 1 < this->capacity) {
+            this->buffer[this->used] = *text;
+            this->buffer[this->used + 1] = '\0';
+        }
+    }
+}
+
+void StatsJson::key(const char* name) {
+    if(this->needComma) this->put(",");
+    this->needComma = true;
+    if(!name) return;
+
+    this->put("\"");
+    this->put(name);
+    this->put("\":");
+}
+
+void StatsJson::beginObject(const char* name) {
+    this->key(name);
+    this->put("{");
+    this->needComma = false;
+}
+
+void StatsJson::endObject() {
+    this->put("}");
+    this->needComma = true;
+}
+
+void StatsJson::beginArray(const char* name) {
+    this->key(name);
+    this->put("[");
+    this->needComma = false;
+}
+
+void StatsJson::endArray() {
+    this->put("]");
+    this->needComma = true;
+}
+
+//digits by hand, printf may allocate and this runs inside libcustomalloc
+void StatsJson::add(const char* name, uint64_t value) {
+    char digits[21];
+    char* end = digits + sizeof(digits) - 1;
+    char* start = end;
+    *end = '\0';
+    do {
+        *--start = (char)('0' + value % 10);
+        value /= 10;
+    } while(value);
+
+    this->key(name);
+    this->put(start);
+}
+
+void StatsJson::add(const char* name, const AllocStats& stats) {
+    this->beginObject(name);
+    this->add("allocs", stats.allocs);
+    this->add("frees", stats.frees);
+    this->add("splits", stats.splits);
+    this->add("coalesces", stats.coalesces);
+    this->add("os_requests", stats.osRequests);
+    this->add("os_bytes", stats.osBytes);
+    this->add("live_bytes", stats.liveBytes);
+    this->add("free_bytes", stats.freeBytes);
+    this->add("free_blocks", stats.freeBlocks);
+
+    //four decimals in fixed point
+    uint64_t scaled = (uint64_t)(stats.fragmentation() * 10000 + 0.5);
+    char fraction[] = "0.0000";
+    fraction[0] = (char)('0' + scaled / 10000);
+    for(int i = 5; i >= 2; i--, scaled /= 10) fraction[i] = (char)('0' + scaled % 10);
+    this->key("fragmentation");
+    this->put(fraction);
+
+    this->endObject();
+}
@@ -0,0 +1,376 @@
+#include "alloc_trace.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t HEADER_SIZE = sizeof(TRACE_MAGIC) + 1;
+const size_t MAX_RECORD = 64;            //tag byte and five varints fit with room to spare
+const size_t INITIAL_OBJECTS = 1 << 16;  //table slots and free ids mapped at first
+
+std::atomic<uint32_t> threadCount{0};
+thread_local uint32_t threadId __attribute__((tls_model("initial-exec"))) = UINT32_MAX;
+
+uint64_t nowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+//fresh zeroed pages, the recorder must not call malloc
+void* mapPages(size_t bytes) {
+    void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return pages == MAP_FAILED ? nullptr : pages;
+}
+
+//fibonacci hashing, blocks are at least 8-byte aligned so the low bits carry nothing
+size_t homeSlot(uintptr_t address, size_t capacity) {
+    return (size_t)(((address >> 3) * 0x9E3779B97F4A7C15ull) >> (64 - __builtin_ctzll(capacity)));
+}
+
+}
+
+uint32_t TraceRecorder::currentThread() {
+    if(threadId == UINT32_MAX) threadId = threadCount.fetch_add(1, std::memory_order_relaxed);
+    return threadId;
+}
+
+TraceRecorder::~TraceRecorder() {
+    this->close();
+}
+
+bool TraceRecorder::open(const char* path) {
+    this->close();
+
+    this->table = static_cast<Entry*>(mapPages(INITIAL_OBJECTS * sizeof(Entry)));
+    this->freeIds = static_cast<uint64_t*>(mapPages(INITIAL_OBJECTS * sizeof(uint64_t)));
+    this->fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(!this->table || !this->freeIds || this->fd < 0) {
+        this->close();
+        return false;
+    }
+
+    this->capacity = INITIAL_OBJECTS;
+    this->freeCapacity = INITIAL_OBJECTS;
+    this->lastTime = nowNs();
+
+    memcpy(this->buffer, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    this->buffer[sizeof(TRACE_MAGIC)] = (char)TRACE_VERSION;
+    this->used = HEADER_SIZE;
+    return true;
+}
+
+void TraceRecorder::close() {
+    if(this->fd >= 0) {
+        this->flush();
+        if(this->fd >= 0) ::close(this->fd);
+    }
+    if(this->table) munmap(this->table, this->capacity * sizeof(Entry));
+    if(this->freeIds) munmap(this->freeIds, this->freeCapacity * sizeof(uint64_t));
+
+    this->fd = -1;
+    this->used = 0;
+    this->recordCount = 0;
+    this->lastThread = 0;
+    this->table = nullptr;
+    this->capacity = this->liveCount = 0;
+    this->freeIds = nullptr;
+    this->freeCount = this->freeCapacity = 0;
+    this->nextId = 0;
+}
+
+void TraceRecorder::flush() {
+    if(this->fd < 0 || this->used == 0) return;
+    if(!this->write(this->buffer, this->used)) {
+        //the file is unusable, stop recording but keep the program running
+        ::close(this->fd);
+        this->fd = -1;
+    }
+    this->used = 0;
+}
+
+bool TraceRecorder::write(const char* bytes, size_t size) {
+    while(size > 0) {
+        ssize_t written = ::write(this->fd, bytes, size);
+        if(written < 0) {
+            if(errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+void TraceRecorder::putVarint(uint64_t value) {
+    while(value >= 0x80) {
+        this->buffer[this->used++] = (char)(value | 0x80);
+        value >>= 7;
+    }
+    this->buffer[this->used++] = (char)value;
+}
+
+//tag byte, time delta and the thread if it changed; leaves room for the rest of the record
+void TraceRecorder::beginRecord(TraceOp op, uint32_t thread, bool aligned) {
+    if(this->used + MAX_RECORD > BUFFER_SIZE) this->flush();
+
+    uint8_t tag = (uint8_t)op;
+    if(thread != this->lastThread) tag |= TRACE_THREAD_CHANGED;
+    if(aligned) tag |= TRACE_ALIGNED;
+    this->buffer[this->used++] = (char)tag;
+
+    uint64_t now = nowNs();
+    this->putVarint(now > this->lastTime ? now - this->lastTime : 0);
+    this->lastTime = now;
+
+    if(thread != this->lastThread) {
+        this->putVarint(thread);
+        this->lastThread = thread;
+    }
+    this->recordCount++;
+}
+
+void TraceRecorder::recordAlloc(const void* data, size_t size, size_t alignment, uint32_t thread) {
+    if(this->fd < 0 || data == nullptr) return;
+
+    if(!this->endStale((uintptr_t)data, thread)) return;
+
+    uint64_t object = this->takeId();
+    if(!this->insert((uintptr_t)data, object)) return;
+
+    this->beginRecord(TraceOp::Alloc, thread, alignment != 0);
+    this->putVarint(size);
+    if(alignment) this->putVarint(__builtin_ctzll(alignment));
+}
+
+void TraceRecorder::recordFree(const void* data, uint32_t thread) {
+    uint64_t object;
+    if(this->fd < 0 || !this->remove((uintptr_t)data, object)) return;
+
+    this->beginRecord(TraceOp::Free, thread, false);
+    this->putVarint(object);
+    this->releaseId(object);
+}
+
+void TraceRecorder::recordRealloc(const void* old, const void* data, size_t size, uint32_t thread) {
+    if(this->fd < 0 || data == nullptr) return;
+
+    uint64_t object;
+    if(!this->remove((uintptr_t)old, object)) {
+        this->recordAlloc(data, size, 0, thread);
+        return;
+    }
+    if(data != old && !this->endStale((uintptr_t)data, thread)) return;
+    if(!this->insert((uintptr_t)data, object)) return;
+
+    this->beginRecord(TraceOp::Realloc, thread, false);
+    this->putVarint(object);
+    this->putVarint(size);
+}
+
+//an address handed out again without a free we saw (freed behind our back): the old
+//object ends here, or it would stay live for the whole replay; false if recording stopped
+bool TraceRecorder::endStale(uintptr_t address, uint32_t thread) {
+    uint64_t stale;
+    if(!this->remove(address, stale)) return true;
+
+    this->beginRecord(TraceOp::Free, thread, false);
+    this->putVarint(stale);
+    this->releaseId(stale);
+    return this->fd >= 0;
+}
+
+uint64_t TraceRecorder::takeId() {
+    if(this->freeCount) return this->freeIds[--this->freeCount];
+    return this->nextId++;
+}
+
+void TraceRecorder::releaseId(uint64_t object) {
+    if(this->freeCount == this->freeCapacity) {
+        uint64_t* larger = static_cast<uint64_t*>(mapPages(2 * this->freeCapacity * sizeof(uint64_t)));
+        if(!larger) {
+            this->close();
+            return;
+        }
+        memcpy(larger, this->freeIds, this->freeCount * sizeof(uint64_t));
+        munmap(this->freeIds, this->freeCapacity * sizeof(uint64_t));
+        this->freeIds = larger;
+        this->freeCapacity *= 2;
+    }
+    this->freeIds[this->freeCount++] = object;
+}
+
+bool TraceRecorder::insert(uintptr_t address, uint64_t object) {
+    if(2 * (this->liveCount + 1) > this->capacity && !this->grow()) {
+        this->close();
+        return false;
+    }
+
+    size_t mask = this->capacity - 1;
+    size_t slot = homeSlot(address, this->capacity);
+    while(this->table[slot].address) slot = (slot + 1) & mask;
+
+    this->table[slot] = {address, object};
+    this->liveCount++;
+    return true;
+}
+
+bool TraceRecorder::remove(uintptr_t address, uint64_t& object) {
+    if(address == 0) return false;
+
+    size_t mask = this->capacity - 1;
+    size_t slot = homeSlot(address, this->capacity);
+    while(this->table[slot].address != address) {
+        if(this->table[slot].address == 0) return false;
+        slot = (slot + 1) & mask;
+    }
+    object = this->table[slot].object;
+
+    //backward shift: pull later entries of the run into the hole, so lookups
+    //never stop early at it and no tombstones pile up
+    size_t hole = slot;
+    for(size_t next = (hole + 1) & mask; this->table[next].address; next = (next + 1) & mask) {
+        size_t home = homeSlot(this->table[next].address, this->capacity);
+        if(((next - home) & mask) >= ((next - hole) & mask)) {
+            this->table[hole] = this->table[next];
+            hole = next;
+        }
+    }
+    this->table[hole].address = 0;
+    this->liveCount--;
+    return true;
+}
+
+bool TraceRecorder::grow() {
+    size_t oldCapacity = this->capacity;
+    Entry* old = this->table;
+    Entry* larger = static_cast<Entry*>(mapPages(2 * oldCapacity * sizeof(Entry)));
+    if(!larger) return false;
+
+    this->table = larger;
+    this->capacity = 2 * oldCapacity;
+    this->liveCount = 0;
+    for(size_t i = 0; i < oldCapacity; i++) {
+        if(!old[i].address) continue;
+
+        size_t slot = homeSlot(old[i].address, this->capacity);
+        while(larger[slot].address) slot = (slot + 1) & (this->capacity - 1);
+        larger[slot] = old[i];
+        this->liveCount++;
+    }
+
+    munmap(old, oldCapacity * sizeof(Entry));
+    return true;
+}
+
+TraceReader::~TraceReader() {
+    this->close();
+}
+
+bool TraceReader::open(const char* path) {
+    this->close();
+
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return false;
+
+    struct stat info;
+    void* mapped = MAP_FAILED;
+    if(fstat(fd, &info) == 0 && (size_t)info.st_size >= HEADER_SIZE) {
+        mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if(mapped == MAP_FAILED) return false;
+
+    this->data = static_cast<const uint8_t*>(mapped);
+    this->size = info.st_size;
+    madvise(mapped, this->size, MADV_SEQUENTIAL);
+
+    if(memcmp(this->data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || this->data[sizeof(TRACE_MAGIC)] != TRACE_VERSION) {
+        this->close();
+        return false;
+    }
+
+    this->rewind();
+    return true;
+}
+
+void TraceReader::close() {
+    if(this->data) munmap(const_cast<uint8_t*>(this->data), this->size);
+    this->data = nullptr;
+    this->size = 0;
+    this->rewind();
+}
+
+void TraceReader::rewind() {
+    this->position = this->data ? HEADER_SIZE : 0;
+    this->broken = false;
+    this->time = 0;
+    this->thread = 0;
+    this->freeIds.clear();
+    this->nextId = 0;
+}
+
+bool TraceReader::getVarint(uint64_t& value) {
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+        if(this->position >= this->size) return false;
+
+        uint8_t byte = this->data[this->position++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool TraceReader::next(TraceEvent& event) {
+    if(this->broken || this->position >= this->size) return false;
+
+    uint8_t tag = this->data[this->position++];
+    TraceOp op = (TraceOp)(tag & TRACE_OP_MASK);
+    uint64_t delta, value;
+
+    this->broken = true; //until the whole record has been read
+    if(op > TraceOp::Realloc || !this->getVarint(delta)) return false;
+    if(tag & TRACE_THREAD_CHANGED) {
+        if(!this->getVarint(value)) return false;
+        this->thread = (uint32_t)value;
+    }
+
+    event.op = op;
+    event.size = 0;
+    event.alignment = 0;
+    if(op != TraceOp::Alloc) {
+        if(!this->getVarint(event.object) || event.object >= this->nextId) return false;
+    }
+    if(op != TraceOp::Free) {
+        if(!this->getVarint(value)) return false;
+        event.size = value;
+    }
+    if(tag & TRACE_ALIGNED) {
+        if(!this->getVarint(value) || value >= 64) return false;
+        event.alignment = size_t(1) << value;
+    }
+    this->broken = false;
+
+    this->time += delta;
+    event.time = this->time;
+    event.thread = this->thread;
+
+    if(op == TraceOp::Alloc) {
+        if(this->freeIds.empty()) {
+            event.object = this->nextId++;
+        } else {
+            event.object = this->freeIds.back();
+            this->freeIds.pop_back();
+        }
+    } else if(op == TraceOp::Free) {
+        this->freeIds.push_back(event.object);
+    }
+    return true;
+}
@@ -0,0 +1,215 @@
+#include "arena_allocator.h"
+#include <atomic>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<unsigned> nextThread{0};
+
+//round-robin ticket of the calling thread, drawn on its first allocation
+unsigned threadTicket() {
+    thread_local unsigned ticket = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return ticket;
+}
+
+}
+
+ArenaAllocator::Arena::Arena(char* span)
+    : blocks(span, BLOCK_SPAN), runs(span + BLOCK_SPAN, RUN_SPAN), heap(&blocks, &runs) {}
+
+ArenaAllocator::ArenaAllocator(int arenaCount, Selection selection) : selection(selection) {
+    if(arenaCount <= 0) arenaCount = (int)sysconf(_SC_NPROCESSORS_CONF);
+    if(arenaCount <= 0) arenaCount = 1;
+    if(arenaCount > MAX_ARENAS) arenaCount = MAX_ARENAS;
+
+    //address space only: every arena commits its own pieces as it grows
+    size_t size = arenaCount * ARENA_SPAN;
+    void* range = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(range == MAP_FAILED) return; //no arenas, every alloc fails
+
+    this->base = (char*)range;
+    this->reserved = size;
+    for(int i = 0; i < arenaCount; i++) {
+        this->arenas.emplace_back(new Arena(this->base + i * ARENA_SPAN));
+    }
+}
+
+ArenaAllocator::~ArenaAllocator() {
+    this->arenas.clear();
+    if(this->base) munmap(this->base, this->reserved);
+}
+
+//sched_getcpu is a vDSO/rseq read on current glibc, cheap enough to ask on every call
+//the answer may be stale by the time the lock is taken, which only costs contention
+int ArenaAllocator::currentArena() {
+    int count = this->arenaCount();
+    if(count <= 1) return 0;
+
+    if(this->selection == Selection::CurrentCpu) {
+        int cpu = sched_getcpu();
+        if(cpu >= 0) return cpu % count;
+    }
+
+    return threadTicket() % count;
+}
+
+int ArenaAllocator::arenaOf(const void* data) const {
+    const char* ptr = (const char*)data;
+    if(ptr < this->base || ptr >= this->base + this->reserved) return -1;
+    return (int)((ptr - this->base) / ARENA_SPAN);
+}
+
+void ArenaAllocator::collectRemoteFrees(Arena& arena) {
+    word_t* data = arena.remoteFrees.takeAll();
+    while(data) {
+        word_t* next = RemoteFreeList::next(data);
+        arena.heap.free(data);
+        data = next;
+    }
+}
+
+//an exhausted arena falls back to the others before giving up
+word_t* ArenaAllocator::alloc(size_t size) {
+    int count = this->arenaCount();
+    int first = this->currentArena();
+
+    for(int i = 0; i < count; i++) {
+        Arena& arena = *this->arenas[(first + i) % count];
+        std::lock_guard<std::mutex> guard(arena.lock);
+        this->collectRemoteFrees(arena);
+        if(word_t* data = arena.heap.alloc(size)) return data;
+    }
+
+    return nullptr;
+}
+
+word_t* ArenaAllocator::calloc(size_t count, size_t size) {
+    int arenaCount = this->arenaCount();
+    int first = this->currentArena();
+
+    for(int i = 0; i < arenaCount; i++) {
+        Arena& arena = *this->arenas[(first + i) % arenaCount];
+        std::lock_guard<std::mutex> guard(arena.lock);
+        this->collectRemoteFrees(arena);
+        if(word_t* data = arena.heap.calloc(count, size)) return data;
+    }
+
+    return nullptr;
+}
+
+word_t* ArenaAllocator::allocAligned(size_t size, size_t alignment) {
+    int count = this->arenaCount();
+    int first = this->currentArena();
+
+    for(int i = 0; i < count; i++) {
+        Arena& arena = *this->arenas[(first + i) % count];
+        std::lock_guard<std::mutex> guard(arena.lock);
+        this->collectRemoteFrees(arena);
+        if(word_t* data = arena.heap.allocAligned(size, alignment)) return data;
+    }
+
+    return nullptr;
+}
+
+//blocks go back to the arena that handed them out, whichever thread frees them:
+//directly when it is the caller's own arena, through its remote free list otherwise
+//mapped blocks belong to no arena and are unmapped without taking a lock
+void ArenaAllocator::free(word_t* data) {
+    if(data == nullptr) return;
+
+    int owner = this->arenaOf(data);
+    if(owner < 0) {
+        this->arenas[this->currentArena()]->heap.freeMapped(getHeader(data));
+        return;
+    }
+
+    Arena& arena = *this->arenas[owner];
+    if(this->deferRemoteFrees && owner != this->currentArena()) {
+        arena.remoteFrees.push(data);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(arena.lock);
+    arena.heap.free(data);
+}
+
+void ArenaAllocator::free(word_t* data, size_t size) {
+    if(data == nullptr) return;
+    if(this->verifySizedFree) verifyFreeSize(data, size, this->usableSize(data));
+
+    int owner = this->arenaOf(data);
+    if(owner < 0) {
+        this->arenas[this->currentArena()]->heap.freeMapped(getHeader(data));
+        return;
+    }
+
+    Arena& arena = *this->arenas[owner];
+    if(this->deferRemoteFrees && owner != this->currentArena()) {
+        arena.remoteFrees.push(data);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(arena.lock);
+    arena.heap.free(data, size);
+}
+
+//resized under the owner's lock, so a moved block stays in the owning arena;
+//mapped blocks are resized through the caller's arena
+word_t* ArenaAllocator::realloc(word_t* data, size_t size) {
+    if(data == nullptr) return this->alloc(size);
+
+    int owner = this->arenaOf(data);
+    if(owner < 0) owner = this->currentArena();
+
+    Arena& arena = *this->arenas[owner];
+    std::lock_guard<std::mutex> guard(arena.lock);
+    return arena.heap.realloc(data, size);
+}
+
+size_t ArenaAllocator::usableSize(word_t* data) {
+    int owner = this->arenaOf(data);
+    if(owner < 0) return getHeader(data)->size();
+
+    //slab ownership is a range check, the run header is stable while the object is live
+    return this->arenas[owner]->heap.usableSize(data);
+}
+
+size_t ArenaAllocator::trim() {
+    size_t purged = 0;
+    for(auto& arena : this->arenas) {
+        std::lock_guard<std::mutex> guard(arena->lock);
+        this->collectRemoteFrees(*arena);
+        purged += arena->heap.trim();
+    }
+    return purged;
+}
+
+AllocStats ArenaAllocator::getStats() const {
+    AllocStats total;
+    for(auto& arena : this->arenas) total += arena->heap.getStats();
+    return total;
+}
+
+size_t ArenaAllocator::statsJson(char* buffer, size_t capacity) const {
+    AllocStats mapped;
+    for(auto& arena : this->arenas) mapped += arena->heap.mapStats();
+
+    StatsJson json(buffer, capacity);
+    json.beginObject();
+    json.add("total", this->getStats());
+    json.add("mapped", mapped);
+
+    json.beginArray("arenas");
+    for(int i = 0; i < this->arenaCount(); i++) {
+        json.beginObject();
+        json.add("total", this->arenaStats(i));
+        this->arenas[i]->heap.writeHeapStats(json);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.endObject();
+    return json.length();
+}
@@ -1,23 +1,122 @@
 #include "block_utils.h"
-#include <unistd.h> 
+#include "chunk_provider.h"
 #include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <unistd.h>
 
 size_t align(size_t n) {
     return (n + sizeof(word_t) - 1) & ~(sizeof(word_t) - 1);
 }
 
 size_t allocSize(size_t size) {
-    return align(sizeof(Block) + size - sizeof(word_t));
+    return align(HEADER_SIZE + size);
 }
 
-Block *requestFromOS(size_t size) {
-    auto block = (Block *)sbrk(0);
-    if(sbrk(allocSize(size)) == (void *)-1) {
-        return nullptr;
-    }
-    return block;
+//grows the heap behind `provider` by one block, syscalls only happen when
+//the provider runs out of space it already holds
+Block *requestFromOS(ChunkProvider* provider, size_t size) {
+    return (Block *)provider->extend(allocSize(size));
 }
 
 Block *getHeader(word_t *data) {
-    return (Block *)((char *)data - offsetof(Block, data));
+    return (Block *)((char *)data - HEADER_SIZE);
+}
+
+void verifyFreeSize(const void* data, size_t size, size_t usable) {
+    if(size <= usable) return;
+
+    fprintf(stderr, "free(%p, %zu): the block holds only %zu bytes\n", data, size, usable);
+    abort();
+}
+
+static size_t pageSize() {
+    static const size_t size = (size_t)sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+static size_t roundUpToPage(size_t n) {
+    return (n + pageSize() - 1) & ~(pageSize() - 1);
+}
+
+bool isValidAlignment(size_t alignment) {
+    return alignment && (alignment & (alignment - 1)) == 0 && alignment <= pageSize();
+}
+
+size_t alignedLead(word_t* data, size_t alignment, size_t minPayload) {
+    uintptr_t address = (uintptr_t)data;
+    if((address & (alignment - 1)) == 0) return 0;
+
+    uintptr_t earliest = address + HEADER_SIZE + minPayload;
+    return ((earliest + alignment - 1) & ~(uintptr_t)(alignment - 1)) - address;
+}
+
+Block* splitFront(Block* block, size_t lead) {
+    Block* rest = reinterpret_cast<Block*>(reinterpret_cast<char*>(block->data) + lead - HEADER_SIZE);
+
+    rest->header = block->size() - lead;
+    rest->setUsed(block->isUsed());
+    rest->setPrevUsed(block->isUsed());
+
+    block->setSize(lead - HEADER_SIZE);
+
+    return rest;
+}
+
+//bytes between the start of a block's mapping and its header
+static size_t mappingOffset(Block* block) {
+    return (uintptr_t)block & (pageSize() - 1);
+}
+
+//the payload runs to the end of the last page, so the rounding is usable
+Block* mapBlock(size_t size, size_t alignment) {
+    size_t offset = alignment > sizeof(word_t) ? alignment - HEADER_SIZE : 0;
+    size_t length = roundUpToPage(offset + HEADER_SIZE + size);
+    if(length < size) return nullptr; //overflow
+
+    void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED) return nullptr;
+
+    Block* block = (Block *)((char *)memory + offset);
+    block->header = length - offset - HEADER_SIZE;
+    block->setUsed(true);
+    block->setMapped(true);
+    return block;
+}
+
+Block* remapBlock(Block* block, size_t size) {
+    size_t offset = mappingOffset(block);
+    size_t oldLength = offset + HEADER_SIZE + block->size();
+    size_t length = roundUpToPage(offset + HEADER_SIZE + size);
+    if(length < size) return nullptr;
+    if(length == oldLength) return block;
+
+    void* memory = mremap((char *)block - offset, oldLength, length, MREMAP_MAYMOVE);
+    if(memory == MAP_FAILED) return nullptr;
+
+    block = (Block *)((char *)memory + offset);
+    block->setSize(length - offset - HEADER_SIZE);
+    return block;
+}
+
+void unmapBlock(Block* block) {
+    munmap((char *)block - mappingOffset(block), mappingSize(block));
+}
+
+size_t mappingSize(Block* block) {
+    return mappingOffset(block) + HEADER_SIZE + block->size();
+}
+
+void writeFooter(Block* block) {
+    char* payloadEnd = reinterpret_cast<char*>(block->data) + block->size();
+    reinterpret_cast<size_t*>(payloadEnd)[-1] = block->size();
+}
+
+//only valid while the physical predecessor is free (!block->isPrevUsed())
+Block* getPreviousFromFooter(Block* block) {
+    size_t prevSize = reinterpret_cast<size_t*>(block)[-1];
+    return reinterpret_cast<Block*>(
+        reinterpret_cast<char*>(block) - prevSize - HEADER_SIZE
+    );
 }
@@ -2,29 +2,65 @@
 #include "block_utils.h"
 
 word_t* BumpAllocator::alloc(size_t size) {
-    size = align(size);
+    if(size > MAX_REQUEST) return nullptr;
+    word_t* data = this->allocFromOS(align(size));
+    if(!data) return nullptr;
 
-    auto block = requestFromOS(size);
+    this->stats.allocs.add();
+    this->stats.liveBytes.add(getHeader(data)->size());
+    return data;
+}
+
+word_t* BumpAllocator::allocFromOS(size_t size) {
+    auto block = requestFromOS(this->provider, size);
     if(!block) return nullptr;
+    this->stats.osRequests.add();
+    this->stats.osBytes.add(allocSize(size));
 
-    block->size = size;
-    block->used = true;
-    block->next = nullptr;
+    //blocks sit back to back, the next one starts right after this payload
+    block->header = size;
+    block->setUsed(true);
 
     if(this->heapStart == nullptr) {
         this->heapStart = block;
     }
 
-    if(this->top != nullptr) {
-        this->top->next = block;
-    }
-
     this->top = block;
 
     return block->data;
 }
 
+//the next block starts where the provider ends, so the lead is known before allocating
+word_t* BumpAllocator::allocAligned(size_t size, size_t alignment) {
+    if(!isValidAlignment(alignment)) return nullptr;
+    if(alignment <= sizeof(word_t)) return this->alloc(size);
+
+    char* next = (char*)this->provider->extend(0);
+    if(!next) return nullptr;
+
+    size_t lead = alignedLead(reinterpret_cast<word_t*>(next + HEADER_SIZE), alignment, 0);
+    if(lead) {
+        word_t* filler = this->allocFromOS(lead - HEADER_SIZE);
+        if(!filler) return nullptr;
+        getHeader(filler)->setUsed(false);
+        this->stats.freeBlocks.add();
+        this->stats.freeBytes.add(lead - HEADER_SIZE);
+    }
+
+    return this->alloc(size);
+}
+
 void BumpAllocator::free(word_t* data) {
     auto start = getHeader(data); //points to the starting of the block now
-    start->used = false;
+    start->setUsed(false);
+
+    this->stats.frees.add();
+    this->stats.liveBytes.sub(start->size());
+    this->stats.freeBlocks.add();
+    this->stats.freeBytes.add(start->size());
+}
+
+void BumpAllocator::free(word_t* data, size_t size) {
+    if(this->verifySizedFree) verifyFreeSize(data, size, getHeader(data)->size());
+    this->free(data);
 }
\ No newline at end of file
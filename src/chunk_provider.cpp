@@ -0,0 +1,152 @@
+#include "chunk_provider.h"
+#include "block_utils.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+
+static size_t pageSize() {
+    static const size_t size = (size_t)sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+static size_t roundUpToPage(size_t n) {
+    return (n + pageSize() - 1) & ~(pageSize() - 1);
+}
+
+void* SbrkChunkProvider::extend(size_t size) {
+    if(this->end == nullptr || size > (size_t)(this->limit - this->end)) {
+        char* brk = (char*)sbrk(0);
+        if(this->limit != nullptr && brk != this->limit) return nullptr; //break moved under us
+
+        size_t needed = this->end ? size - (this->limit - this->end) : size;
+        size_t grow = roundUpToPage(needed);
+        if(grow < this->growth) grow = this->growth;
+
+        if(sbrk(grow) == (void *)-1) return nullptr;
+
+        if(this->end == nullptr) this->start = this->end = brk;
+        this->limit = brk + grow;
+        if(this->growth < MAX_GROWTH) this->growth *= 2;
+    }
+
+    void* start = this->end;
+    this->end += size;
+    return start;
+}
+
+//hands the break back down to the page holding the new end; the rest of that page
+//stays ours and is cleared, so extend keeps returning memory that reads as zero
+bool SbrkChunkProvider::release(size_t size) {
+    if(size > (size_t)(this->end - this->start)) return false;
+    if((char*)sbrk(0) != this->limit) return false; //break moved under us
+
+    char* newEnd = this->end - size;
+    char* keep = (char*)roundUpToPage((uintptr_t)newEnd);
+    if(keep > this->limit) keep = this->limit;
+
+    if(keep < this->limit) {
+        if(sbrk(-(intptr_t)(this->limit - keep)) == (void *)-1) return false;
+        this->limit = keep;
+    }
+
+    memset(newEnd, 0, keep - newEnd);
+    this->end = newEnd;
+    return true;
+}
+
+MmapChunkProvider::MmapChunkProvider(size_t reserveSize)
+    : reserveSize(roundUpToPage(reserveSize)) {}
+
+MmapChunkProvider::MmapChunkProvider(void* range, size_t size)
+    : reserveSize(size), base((char*)range), end((char*)range), committed((char*)range), ownsRange(false) {}
+
+MmapChunkProvider::~MmapChunkProvider() {
+    if(this->base && this->ownsRange) munmap(this->base, this->reserveSize);
+}
+
+bool MmapChunkProvider::reserve() {
+    void* range = mmap(nullptr, this->reserveSize, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(range == MAP_FAILED) return false;
+
+    this->base = (char*)range;
+    this->end = this->base;
+    this->committed = this->base;
+    return true;
+}
+
+//commits at least up to `needed`, in chunks that double up to MAX_COMMIT
+bool MmapChunkProvider::commit(char* needed) {
+    char* limit = this->base + this->reserveSize;
+
+    size_t step = this->commitStep;
+    if((size_t)(needed - this->committed) > step) {
+        step = roundUpToPage(needed - this->committed);
+    }
+    if(step > (size_t)(limit - this->committed)) {
+        step = limit - this->committed;
+    }
+
+    if(mprotect(this->committed, step, PROT_READ | PROT_WRITE) != 0) return false;
+
+    this->committed += step;
+    if(this->commitStep < MAX_COMMIT) this->commitStep *= 2;
+    return true;
+}
+
+void* MmapChunkProvider::extend(size_t size) {
+    if(this->base == nullptr && !this->reserve()) return nullptr;
+    if(size > (size_t)(this->base + this->reserveSize - this->end)) return nullptr;
+
+    if(size > (size_t)(this->committed - this->end) && !this->commit(this->end + size)) {
+        return nullptr;
+    }
+
+    void* start = this->end;
+    this->end += size;
+    return start;
+}
+
+//drops every page above the new end and turns the range back to PROT_NONE,
+//the partial page left at the end is cleared so that it reads as zero again
+bool MmapChunkProvider::release(size_t size) {
+    if(this->base == nullptr || size > (size_t)(this->end - this->base)) return false;
+
+    char* newEnd = this->end - size;
+    char* keep = this->base + roundUpToPage(newEnd - this->base);
+
+    if(keep < this->committed) {
+        size_t length = this->committed - keep;
+        if(madvise(keep, length, MADV_DONTNEED) != 0) return false;
+        if(mprotect(keep, length, PROT_NONE) == 0) this->committed = keep; //else stays usable, just dropped
+    }
+
+    memset(newEnd, 0, keep - newEnd);
+    this->end = newEnd;
+    return true;
+}
+
+BufferChunkProvider::BufferChunkProvider(void* buffer, size_t size) {
+    //blocks need word alignment, skip the unaligned head of the buffer
+    uintptr_t start = align((uintptr_t)buffer);
+    uintptr_t limit = (uintptr_t)buffer + size;
+
+    this->start = this->end = (char*)start;
+    this->limit = start < limit ? (char*)limit : (char*)start;
+}
+
+void* BufferChunkProvider::extend(size_t size) {
+    if(size > (size_t)(this->limit - this->end)) return nullptr;
+
+    void* start = this->end;
+    this->end += size;
+    return start;
+}
+
+bool BufferChunkProvider::release(size_t size) {
+    if(size > (size_t)(this->end - this->start)) return false;
+
+    this->end -= size;
+    return true;
+}
\ No newline at end of file
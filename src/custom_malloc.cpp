@@ -0,0 +1,360 @@
+//drop-in replacement for the C allocation functions and the global operator new/delete,
+//built as libcustomalloc.so to be loaded with LD_PRELOAD
+//every request is served by one SegregatedListAllocator behind one lock
+//with CUSTOMALLOC_TRACE=path set, every call is also recorded to a trace (alloc_trace.h)
+//customalloc_stats() hands out the heap's counters as JSON (alloc_stats.h)
+
+#include "segregated_allocator.h"
+#include "alloc_trace.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+//what glibc guarantees on 64-bit and what operator new assumes (__STDCPP_DEFAULT_NEW_ALIGNMENT__)
+const size_t MIN_ALIGNMENT = 16;
+
+//the allocator lives in static storage and is built on first use: malloc can be called
+//before any constructor of this library has run, from the dynamic loader or libc itself
+alignas(SegregatedListAllocator) char heapStorage[sizeof(SegregatedListAllocator)];
+SegregatedListAllocator* heap = nullptr;
+pthread_mutex_t heapLock = PTHREAD_MUTEX_INITIALIZER;
+
+//built next to the heap when CUSTOMALLOC_TRACE is set, records under the heap lock so
+//the trace has the calls in the order the heap saw them
+alignas(TraceRecorder) char recorderStorage[sizeof(TraceRecorder)];
+TraceRecorder* recorder = nullptr;
+
+//the forking thread holds the lock across fork, so the child never inherits a heap
+//that another thread was halfway through changing
+//a child stops recording, its copy of the trace buffer is the parent's to write
+void lockBeforeFork() { pthread_mutex_lock(&heapLock); }
+void unlockAfterFork() { pthread_mutex_unlock(&heapLock); }
+void unlockInChild() {
+    recorder = nullptr;
+    pthread_mutex_unlock(&heapLock);
+}
+
+//writes out the rest of the trace, records after this point are dropped
+void closeTrace() {
+    pthread_mutex_lock(&heapLock);
+    if(recorder) recorder->close();
+    recorder = nullptr;
+    pthread_mutex_unlock(&heapLock);
+}
+
+//CUSTOMALLOC_TRACE with every %p replaced by the process id, so programs that start
+//others (which inherit the variable) do not truncate each other's trace
+void startTrace() {
+    const char* pattern = getenv("CUSTOMALLOC_TRACE");
+    if(pattern == nullptr || *pattern == '\0') return;
+
+    char path[4096];
+    size_t length = 0;
+    for(const char* c = pattern; *c && length < sizeof(path) - 1; c++) {
+        if(c[0] == '%' && c[1] == 'p') {
+            char digits[16];
+            int count = 0;
+            for(unsigned pid = (unsigned)getpid(); pid || count == 0; pid /= 10) digits[count++] = '0' + pid % 10;
+            while(count && length < sizeof(path) - 1) path[length++] = digits[--count];
+            c++;
+        } else {
+            path[length++] = *c;
+        }
+    }
+    path[length] = '\0';
+
+    TraceRecorder* created = new (recorderStorage) TraceRecorder();
+    if(created->open(path)) recorder = created;
+}
+
+struct HeapGuard {
+    bool created = false;
+
+    HeapGuard() {
+        pthread_mutex_lock(&heapLock);
+        if(heap == nullptr) {
+            heap = new (heapStorage) SegregatedListAllocator();
+            startTrace();
+            this->created = true;
+        }
+    }
+
+    //pthread_atfork and atexit may allocate themselves, so they are called once the lock is released
+    ~HeapGuard() {
+        pthread_mutex_unlock(&heapLock);
+        if(this->created) {
+            pthread_atfork(lockBeforeFork, unlockAfterFork, unlockInChild);
+            if(recorder) atexit(closeTrace);
+        }
+    }
+};
+
+//caller holds the lock
+void traceAlloc(void* ptr, size_t size, size_t alignment) {
+    if(recorder) recorder->recordAlloc(ptr, size, alignment, TraceRecorder::currentThread());
+}
+
+void traceFree(void* ptr) {
+    if(recorder) recorder->recordFree(ptr, TraceRecorder::currentThread());
+}
+
+void traceRealloc(void* old, void* ptr, size_t size) {
+    if(recorder) recorder->recordRealloc(old, ptr, size, TraceRecorder::currentThread());
+}
+
+bool isPowerOfTwo(size_t n) {
+    return n && (n & (n - 1)) == 0;
+}
+
+size_t requiredAlignment(size_t size) {
+    return size > sizeof(word_t) ? MIN_ALIGNMENT : sizeof(word_t);
+}
+
+//blocks only give word alignment, 16 bytes and alignments past a page are reached by
+//moving the pointer up inside a larger block; the word in front of a moved pointer holds the distance back to
+//the block's payload, a multiple of 8 with the USED bit clear, so it is never taken for
+//a header (a used block's header always has USED set)
+void* placeAligned(word_t* data, size_t alignment) {
+    uintptr_t aligned = ((uintptr_t)data + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    size_t offset = aligned - (uintptr_t)data;
+    if(offset) reinterpret_cast<size_t*>(aligned)[-1] = offset;
+    return (void*)aligned;
+}
+
+//payload of the block a pointer handed out here lives in, and how far inside it is
+word_t* blockPayload(void* ptr, size_t& offset) {
+    offset = 0;
+    if(!heap->isSlabObject(ptr)) {
+        size_t word = reinterpret_cast<size_t*>(ptr)[-1];
+        if(!(word & Block::USED)) offset = word;
+    }
+    return reinterpret_cast<word_t*>((char*)ptr - offset);
+}
+
+//caller holds the lock
+void* allocAligned(size_t size, size_t alignment) {
+    //the heap carves stricter alignments out of its free blocks; for the default 16 a
+    //moved pointer costs one word, where carving would leave small slack blocks behind
+    if(alignment > MIN_ALIGNMENT && isValidAlignment(alignment)) {
+        return heap->allocAligned(size, alignment);
+    }
+
+    //slab objects of a class are aligned to the class size, which covers the alignment
+    if(alignment <= SlabAllocator::MAX_SIZE && size <= SlabAllocator::MAX_SIZE) {
+        return heap->alloc(size > alignment ? size : alignment);
+    }
+
+    size_t padded;
+    if(__builtin_add_overflow(size, alignment - sizeof(word_t), &padded)) return nullptr;
+
+    word_t* data = heap->alloc(padded);
+    return data ? placeAligned(data, alignment) : nullptr;
+}
+
+void* allocAlignedLocked(size_t size, size_t alignment) {
+    if(alignment < requiredAlignment(size)) alignment = requiredAlignment(size);
+
+    HeapGuard guard;
+    void* ptr = allocAligned(size, alignment);
+    if(!ptr) errno = ENOMEM;
+    traceAlloc(ptr, size, alignment > requiredAlignment(size) ? alignment : 0);
+    return ptr;
+}
+
+size_t pageSize() {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+void* allocOrThrow(size_t size, size_t alignment) {
+    for(;;) {
+        if(void* ptr = allocAlignedLocked(size, alignment)) return ptr;
+
+        std::new_handler handler = std::get_new_handler();
+        if(!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+}
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    return allocAlignedLocked(size, requiredAlignment(size));
+}
+
+void free(void* ptr) noexcept {
+    if(ptr == nullptr) return;
+
+    HeapGuard guard;
+    size_t offset;
+    heap->free(blockPayload(ptr, offset));
+    traceFree(ptr);
+}
+
+//fresh heap memory and new mappings are not cleared again, see SegregatedListAllocator::calloc
+void* calloc(size_t count, size_t size) noexcept {
+    size_t bytes;
+    if(__builtin_mul_overflow(count, size, &bytes)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    HeapGuard guard;
+    size_t alignment = requiredAlignment(bytes);
+    void* ptr = nullptr;
+
+    if(bytes <= SlabAllocator::MAX_SIZE) {
+        ptr = heap->calloc(1, bytes);
+    } else if(bytes + alignment > bytes) {
+        word_t* data = heap->calloc(1, bytes + alignment - sizeof(word_t));
+        if(data) ptr = placeAligned(data, alignment);
+    }
+
+    if(!ptr) errno = ENOMEM;
+    traceAlloc(ptr, bytes, 0);
+    return ptr;
+}
+
+//the block is resized in place (or remapped) where the allocator can, which keeps the
+//pointer's offset in its block and so its alignment; otherwise the contents go to a fresh
+//allocation of the alignment the new size needs, and when there is none the old pointer
+//stays valid as realloc promises
+void* realloc(void* ptr, size_t size) noexcept {
+    if(ptr == nullptr) return malloc(size);
+    if(size == 0) {
+        free(ptr);
+        return nullptr;
+    }
+
+    HeapGuard guard;
+    size_t offset;
+    word_t* data = blockPayload(ptr, offset);
+
+    size_t padded;
+    if(__builtin_add_overflow(size, offset, &padded)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    size_t alignment = requiredAlignment(size);
+    char* current = (char*)ptr;
+    if(word_t* resized = heap->resizeInPlace(data, padded)) {
+        char* moved = (char*)resized + offset; //a remap keeps the page offset, and the offset word with it
+        if((uintptr_t)moved % alignment == 0) {
+            traceRealloc(ptr, moved, size);
+            return moved;
+        }
+        data = resized;
+        current = moved;
+    }
+
+    void* fresh = allocAligned(size, alignment);
+    if(!fresh) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    size_t oldSize = heap->usableSize(data) - offset;
+    memcpy(fresh, current, oldSize < size ? oldSize : size);
+    heap->free(data);
+    traceRealloc(ptr, fresh, size);
+    return fresh;
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) noexcept {
+    if(!isPowerOfTwo(alignment) || alignment % sizeof(void*) != 0) return EINVAL;
+
+    void* ptr = allocAlignedLocked(size, alignment);
+    if(!ptr) return ENOMEM;
+
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    if(!isPowerOfTwo(alignment)) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return allocAlignedLocked(size, alignment);
+}
+
+//like glibc, an alignment that is not a power of two is rounded up to one
+void* memalign(size_t alignment, size_t size) noexcept {
+    if(alignment > ((size_t)1 << (sizeof(size_t) * 8 - 1))) {
+        errno = EINVAL;
+        return nullptr;
+    }
+
+    size_t rounded = 1;
+    while(rounded < alignment) rounded <<= 1;
+    return allocAlignedLocked(size, rounded);
+}
+
+void* valloc(size_t size) noexcept {
+    return allocAlignedLocked(size, pageSize());
+}
+
+void* pvalloc(size_t size) noexcept {
+    size_t rounded = (size + pageSize() - 1) & ~(pageSize() - 1);
+    if(rounded < size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return allocAlignedLocked(rounded ? rounded : pageSize(), pageSize());
+}
+
+size_t malloc_usable_size(void* ptr) noexcept {
+    if(ptr == nullptr) return 0;
+
+    HeapGuard guard;
+    size_t offset;
+    word_t* data = blockPayload(ptr, offset);
+    return heap->usableSize(data) - offset;
+}
+
+//the heap's counters as one JSON object (SegregatedListAllocator::statsJson), for a metrics
+//exporter in the process to find with dlsym(RTLD_DEFAULT, "customalloc_stats"); the counters
+//are read without the heap lock, so scraping never stalls malloc; returns the length the
+//document needs and writes at most `capacity` bytes, like snprintf
+size_t customalloc_stats(char* buffer, size_t capacity) noexcept {
+    if(heap == nullptr) HeapGuard guard; //builds the heap on first use
+    return heap->statsJson(buffer, capacity);
+}
+
+}
+
+void* operator new(size_t size) { return allocOrThrow(size, sizeof(word_t)); }
+void* operator new[](size_t size) { return allocOrThrow(size, sizeof(word_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocOrThrow(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocOrThrow(size, (size_t)alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return malloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return malloc(size); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocAlignedLocked(size, (size_t)alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocAlignedLocked(size, (size_t)alignment);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { free(ptr); }
\ No newline at end of file
@@ -1,80 +1,28 @@
 #include "block_utils.h"
 #include "explicit_allocator.h"
 #include <iostream>
-
-Block* ExplicitAllocator::findBlock(size_t size, FitFunction strategy) {
-    return (this->*strategy)(size);
+#include <cstring>
+#include <chrono>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static uintptr_t pageSize() {
+    static const uintptr_t size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    return size;
 }
 
-Block* ExplicitAllocator::firstFit(size_t size) {
-    Block* block = this->freeListHead;
-    
-    while(block != nullptr) {
-        if(!block->used && block->size >= size) {
-            return block;
-        }
-        
-        block = block->next;
-    }
-
-    return nullptr;
+static uint64_t nowMillis() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(now).count() + 1; //0 means clean
 }
 
-Block* ExplicitAllocator::nextFit(size_t size) {
-    if(!this->searchStart) {
-        return this->firstFit(size);
-    }
-
-    Block* block = this->searchStart;
-
-    do {
-        if(!block->used && block->size >= size) {
-            return block;
-        }
-        block = block->next ? block->next : this->freeListHead;
-    } while(block != this->searchStart);
-
-    return nullptr;
-}
-
-Block* ExplicitAllocator::bestFit(size_t size) {
-    Block* block = this->freeListHead;
-    Block* resBlock = nullptr;
-
-    while(block != nullptr) {
-        if(!block->used && block->size >= size) {
-            if(resBlock == nullptr || block->size < resBlock->size) {
-                resBlock = block;
-            }
-        }
-        
-        block = block->next;
-    }
-
-    return resBlock;
-}
-
-Block* ExplicitAllocator::worstFit(size_t size) {
-    Block* block = this->freeListHead;
-    Block* resBlock = nullptr;
-
-    while(block != nullptr) {
-        if(!block->used && block->size >= size) {
-            if(resBlock == nullptr || block->size > resBlock->size) {
-                resBlock = block;
-            }
-        }
-        
-        block = block->next;
+//only free blocks carry a footer, so the previous block can only be found while it is free
+Block* ExplicitAllocator::getPhysicalPreviousBlock(Block *block) {
+    if(block == this->heapStart || block->isPrevUsed()) {
+        return nullptr;
     }
 
-    return resBlock;
-}
-
-//TODO: need to figure out a way to get this later
-Block* ExplicitAllocator::getPhysicalPreviousBlock(Block *block) {
-    Block* prevBlock = nullptr;
-    return nullptr;
+    return getPreviousFromFooter(block);
 }
 
 Block* ExplicitAllocator::getPhysicalNextBlock(Block *block) {
@@ -83,31 +31,34 @@ Block* ExplicitAllocator::getPhysicalNextBlock(Block *block) {
     }
 
     Block* nextBlock = reinterpret_cast<Block*>(
-        reinterpret_cast<char*>(block) + sizeof(Block) + block->size - sizeof(word_t) 
+        reinterpret_cast<char*>(block->data) + block->size()
     );
 
     return nextBlock;
 }
 
 bool ExplicitAllocator::canSplit(Block* block, size_t size) {
-    if(block->used) return false;
-    return (block->size >= sizeof(Block) + size);
+    if(block->isUsed()) return false;
+    return (block->size() >= size + HEADER_SIZE + this->minPayload());
 } 
 
 Block* ExplicitAllocator::split(Block* block, size_t size) {
     //this->removeFromFreeList(block);
 
-    size_t originalBlockSize = block->size;
+    size_t originalBlockSize = block->size();
 
     char *newBlockPtr = reinterpret_cast<char*>(block->data) + size;
     Block *newBlock = reinterpret_cast<Block*>(newBlockPtr);
     
-    newBlock->used = false;
-    newBlock->size = sizeof(word_t) + originalBlockSize - size - sizeof(Block);
+    newBlock->header = originalBlockSize - size - HEADER_SIZE;
+    newBlock->setPrevUsed(block->isUsed());
+    if(this->coalesceMode != CoalesceMode::None) writeFooter(newBlock);
 
     if(block == this->top) this->top = newBlock;
+    else this->setPhysicalNextPrevUsed(newBlock, false);
 
-    block->size = size;
+    block->setSize(size);
+    this->stats.splits.add();
 
     return block;
 }
@@ -128,27 +79,43 @@ bool canCoalesce(Block *block) {
 */
 
 bool ExplicitAllocator::canCoalesce(Block *block) {    
-    if(block->used) return false;
+    if(this->coalesceMode == CoalesceMode::None) return false;
+    if(block->isUsed()) return false;
     if(block == this->top) return false;
 
     Block* nextBlock = this->getPhysicalNextBlock(block);
 
-    return nextBlock != nullptr && !nextBlock->used;
+    return nextBlock != nullptr && !nextBlock->isUsed();
+}
+
+bool ExplicitAllocator::canCoalescePrevious(Block *block) {
+    if(this->coalesceMode != CoalesceMode::Bidirectional) return false;
+    if(block->isUsed()) return false;
+
+    return this->getPhysicalPreviousBlock(block) != nullptr;
 }
 
-//TODO: COALESCE WITH PREVIOUS BLOCKS AS WELL
-//ACTUALLY JUST COALESCE BY SCANNING THE WHOLE FREE LIST
-//WILL DO THIS LATER
+//merges a block that is not on the free list with its free physical neighbours
+//the neighbours leave the free list, the caller adds the merged block back
 Block* ExplicitAllocator::coalesce(Block* block) {
-    if(!this->canCoalesce(block)) return block;
+    if(this->canCoalesce(block)) {
+        Block* nextBlock = this->getPhysicalNextBlock(block);
+        this->removeFromFreeList(nextBlock);
 
-    Block* nextBlock = this->getPhysicalNextBlock(block);
-    this->removeFromFreeList(nextBlock);
+        block->setSize(block->size() + nextBlock->size() + HEADER_SIZE);
+        if(nextBlock == this->top) this->top = block;
+        this->stats.coalesces.add();
+    }
 
-    size_t HEADER_SIZE = sizeof(Block) - sizeof(word_t);
-    block->size += nextBlock->size + HEADER_SIZE;
+    if(this->canCoalescePrevious(block)) {
+        Block* prevBlock = this->getPhysicalPreviousBlock(block);
+        this->removeFromFreeList(prevBlock);
 
-    if(nextBlock == this->top) this->top = block;
+        prevBlock->setSize(prevBlock->size() + block->size() + HEADER_SIZE);
+        if(block == this->top) this->top = prevBlock;
+        block = prevBlock;
+        this->stats.coalesces.add();
+    }
 
     return block;
 }
@@ -157,6 +124,8 @@ void ExplicitAllocator::removeFromFreeList(Block* block) {
     Block* prevBlock = block->prev;
     Block* nextBlock = block->next;
 
+    if(block == this->searchStart) this->searchStart = nextBlock;
+
     if(prevBlock) {
         prevBlock->next = nextBlock;
     } else {
@@ -164,6 +133,11 @@ void ExplicitAllocator::removeFromFreeList(Block* block) {
     }
 
     if(nextBlock) nextBlock->prev = prevBlock;
+
+    if(this->indexFreeBlocks) this->freeTree.remove(block);
+
+    this->stats.freeBlocks.sub();
+    this->stats.freeBytes.sub(block->size());
 }
 
 void ExplicitAllocator::addToFreeList(Block* block) {
@@ -175,43 +149,211 @@ void ExplicitAllocator::addToFreeList(Block* block) {
     }
 
     this->freeListHead = block;
+
+    if(this->indexFreeBlocks) this->freeTree.insert(block);
+
+    this->stats.freeBlocks.add();
+    this->stats.freeBytes.add(block->size());
+
+    //blocks holding whole pages remember when they were dirtied, for decay
+    char *start, *end;
+    if(this->purgeableRange(block, start, end)) {
+        if(this->decayMillis == 0) {
+            *this->purgeStamp(block) = 1;
+            this->purgeBlock(block);
+        } else {
+            this->lastDirtied = nowMillis();
+            *this->purgeStamp(block) = this->lastDirtied;
+        }
+    }
 }
 
-word_t* ExplicitAllocator::alloc(size_t size) {
+void ExplicitAllocator::addChainToFreeList(Block* first, Block* last, size_t blocks, size_t bytes) {
+    first->prev = nullptr;
+    last->next = this->freeListHead;
+
+    if(this->freeListHead) {
+        this->freeListHead->prev = last;
+    }
+
+    this->freeListHead = first;
+
+    this->stats.freeBlocks.add(blocks);
+    this->stats.freeBytes.add(bytes);
+}
+
+//whole pages of a free block that hold nothing but stale payload: the list links
+//and tree node at the start, the decay stamp and footer at the end stay mapped
+bool ExplicitAllocator::purgeableRange(Block* block, char*& start, char*& end) {
+    char* payload = reinterpret_cast<char*>(block->data);
+    size_t head = 2 * sizeof(Block*) + (this->indexFreeBlocks ? FreeTree::NODE_SIZE : 0);
+    size_t tail = 2 * sizeof(uint64_t);
+    if(block->size() < head + tail + pageSize()) return false;
+
+    start = (char*)(((uintptr_t)payload + head + pageSize() - 1) & ~(pageSize() - 1));
+    end = (char*)(((uintptr_t)payload + block->size() - tail) & ~(pageSize() - 1));
+    return start < end;
+}
+
+//time the block's pages were last dirtied, 0 once they have been purged
+//only meaningful while the block is free and purgeableRange holds
+uint64_t* ExplicitAllocator::purgeStamp(Block* block) {
+    char* payloadEnd = reinterpret_cast<char*>(block->data) + block->size();
+    return reinterpret_cast<uint64_t*>(payloadEnd) - 2;
+}
+
+size_t ExplicitAllocator::purgeBlock(Block* block) {
+    char *start, *end;
+    if(!this->purgeableRange(block, start, end)) return 0;
+
+    uint64_t* stamp = this->purgeStamp(block);
+    if(*stamp == 0) return 0; //already purged, nothing dirtied it since
+
+    int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+    if(this->purgeAdvice == PurgeAdvice::Free) advice = MADV_FREE;
+#endif
+    if(madvise(start, end - start, advice) != 0) return 0;
+
+    *stamp = 0;
+    return end - start;
+}
+
+size_t ExplicitAllocator::purge() {
+    size_t purged = 0;
+    for(Block* block = this->freeListHead; block; block = block->next) {
+        purged += this->purgeBlock(block);
+    }
+    return purged;
+}
+
+size_t ExplicitAllocator::decay() {
+    uint64_t now = nowMillis();
+    uint64_t delay = this->decayMillis > 0 ? (uint64_t)this->decayMillis : 0;
+    size_t purged = 0;
+
+    for(Block* block = this->freeListHead; block; block = block->next) {
+        char *start, *end;
+        if(!this->purgeableRange(block, start, end)) continue;
+
+        uint64_t stamp = *this->purgeStamp(block);
+        if(stamp != 0 && now - stamp >= delay) purged += this->purgeBlock(block);
+    }
+
+    //a pass walks the whole free list, so passes are spaced a quarter delay apart
+    this->nextDecay = now + delay / 4;
+    return purged;
+}
+
+//runs a decay pass when a block with whole pages was freed since the pass was due
+void ExplicitAllocator::decayTick() {
+    if(this->decayMillis <= 0 || this->lastDirtied < this->nextDecay) return;
+    this->decay();
+}
+
+//the top block shrinks while the heap behind the provider ends right after it
+size_t ExplicitAllocator::releaseTop(size_t keep) {
+    Block* block = this->top;
+    if(block == nullptr || block->isUsed()) return 0;
+
+    keep = align(keep);
+    if(keep < this->minPayload()) keep = this->minPayload();
+    if(block->size() <= keep) return 0;
+
+    char* end = reinterpret_cast<char*>(block->data) + block->size();
+    if(this->provider->extend(0) != end) return 0; //someone else grew the provider since
+
+    size_t released = block->size() - keep;
+    if(!this->provider->release(released)) return 0;
+    this->stats.osBytes.sub(released);
+
+    this->removeFromFreeList(block);
+    block->setSize(keep);
+    if(this->coalesceMode != CoalesceMode::None) writeFooter(block);
+    this->addToFreeList(block);
+
+    return released;
+}
+
+size_t ExplicitAllocator::trim(size_t pad) {
+    size_t released = this->releaseTop(pad);
+    return released + this->purge();
+}
+
+//a free block holds its prev/next links, plus a footer when it can be merged backwards
+//and a tree node when free blocks are indexed
+size_t ExplicitAllocator::minPayload() {
+    size_t payload = (this->coalesceMode == CoalesceMode::None) ? 2 * sizeof(Block*) : MIN_FREE_PAYLOAD;
+    if(this->indexFreeBlocks) payload += FreeTree::NODE_SIZE;
+    return payload;
+}
+
+//without coalescing nobody reads the flag, and a block may have moved here
+//from another heap whose top we do not know
+void ExplicitAllocator::setPhysicalNextPrevUsed(Block* block, bool prevUsed) {
+    if(this->coalesceMode == CoalesceMode::None) return;
+
+    Block* nextBlock = this->getPhysicalNextBlock(block);
+    if(nextBlock) nextBlock->setPrevUsedShared(prevUsed);
+}
+
+size_t ExplicitAllocator::requestSize(size_t size) {
     size = align(size);
+    if(size < this->minPayload()) size = this->minPayload(); //room for the links once freed
+    return size;
+}
+
+word_t* ExplicitAllocator::alloc(size_t size) {
+    if(size > MAX_REQUEST) return nullptr;
+    size = this->requestSize(size);
+
+    word_t* data = this->allocFromFreeList(size);
+    if(!data) data = this->allocFromOS(size);
 
-    if(auto block = this->findBlock(size, &ExplicitAllocator::firstFit)) {
-        if(this->canSplit(block, size)) {
-            block = this->split(block, size);
-            Block* newBlock = this->getPhysicalNextBlock(block);
-            this->addToFreeList(newBlock);
-        }   
-        
-        if(block->next) searchStart = block->next;
-        else searchStart = freeListHead;
-        this->removeFromFreeList(block);
-        this->lastAllocated = block;
-        block->used = true;
-
-        return block->data;
-    }   
-
-    auto block = requestFromOS(size);
+    if(data) this->countAlloc(getHeader(data));
+    return data;
+}
+
+//reuses a free block, size must already be aligned; nullptr when none fits
+word_t* ExplicitAllocator::allocFromFreeList(size_t size) {
+    Block* block = this->findBlock(size);
+    return block ? this->takeFreeBlock(block, size) : nullptr;
+}
+
+//the block leaves the free list before it is split, an indexed block must not change size in the tree
+word_t* ExplicitAllocator::takeFreeBlock(Block* block, size_t size) {
+    if(block->next) searchStart = block->next;
+    else searchStart = freeListHead;
+    this->removeFromFreeList(block);
+
+    if(this->canSplit(block, size)) {
+        block = this->split(block, size);
+        Block* newBlock = this->getPhysicalNextBlock(block);
+        this->addToFreeList(newBlock);
+    }
+
+    this->lastAllocated = block;
+    block->setUsed(true);
+    this->setPhysicalNextPrevUsed(block, true);
+
+    return block->data;
+}
+
+//appends a new block after top, size must already be aligned
+word_t* ExplicitAllocator::allocFromOS(size_t size) {
+    auto block = requestFromOS(this->provider, size);
     if(!block) return nullptr;
+    this->stats.osRequests.add();
+    this->stats.osBytes.add(allocSize(size));
 
-    block->size = size;
-    block->used = true;
-    block->next = nullptr;
-    block->prev = this->top;
+    block->header = size;
+    block->setUsed(true);
+    block->setPrevUsed(this->top == nullptr || this->top->isUsed());
 
     if(this->heapStart == nullptr) {
         this->heapStart = block;
     }
 
-    if(this->top != nullptr) {
-        this->top->next = block;
-    }
-
     this->lastAllocated = block;
     this->top = block;
 
@@ -220,12 +362,158 @@ word_t* ExplicitAllocator::alloc(size_t size) {
 
 void ExplicitAllocator::free(word_t* data) {
     Block* block = getHeader(data);
-    block->used = false;
+    this->countFree(block);
+    this->freeBlock(block);
+}
 
-    if(this->canCoalesce(block)) {
-        this->coalesce(block);
-        return;
-    } 
+void ExplicitAllocator::freeBlock(Block* block) {
+    block->setUsed(false);
+
+    block = this->coalesce(block);
+    if(this->coalesceMode != CoalesceMode::None) writeFooter(block);
+    this->setPhysicalNextPrevUsed(block, false);
 
     this->addToFreeList(block);
+
+    if(this->trimThreshold && this->coalesceMode != CoalesceMode::None &&
+       block == this->top && block->size() >= this->trimThreshold) {
+        this->releaseTop(TOP_PAD);
+    }
+    this->decayTick();
+}
+
+void ExplicitAllocator::free(word_t* data, size_t size) {
+    if(this->verifySizedFree) verifyFreeSize(data, size, getHeader(data)->size());
+    this->free(data);
+}
+
+//merges a free physical successor into a used block when that gets it to `size`
+//a free top is always taken, growTop can extend it further
+bool ExplicitAllocator::absorbNext(Block* block, size_t size) {
+    if(this->coalesceMode == CoalesceMode::None) return false;
+
+    Block* nextBlock = this->getPhysicalNextBlock(block);
+    if(nextBlock == nullptr || nextBlock->isUsed()) return false;
+    if(nextBlock != this->top && block->size() + HEADER_SIZE + nextBlock->size() < size) return false;
+
+    this->removeFromFreeList(nextBlock);
+    block->setSize(block->size() + HEADER_SIZE + nextBlock->size());
+    if(nextBlock == this->top) this->top = block;
+    this->setPhysicalNextPrevUsed(block, true);
+    this->stats.coalesces.add();
+
+    return true;
+}
+
+//the top block can grow in place while the heap behind the provider ends right after it
+bool ExplicitAllocator::growTop(Block* block, size_t size) {
+    if(block != this->top) return false;
+
+    char* end = reinterpret_cast<char*>(block->data) + block->size();
+    if(this->provider->extend(0) != end) return false; //someone else grew the provider since
+    if(!this->provider->extend(size - block->size())) return false;
+    this->stats.osRequests.add();
+    this->stats.osBytes.add(size - block->size());
+
+    block->setSize(size);
+    return true;
+}
+
+//only recycled blocks are cleared: a block fresh from a zero-filling provider
+//has never been written, so its pages are neither touched nor faulted in
+//purged blocks count as recycled, MADV_FREE pages may still hold their old contents
+word_t* ExplicitAllocator::calloc(size_t count, size_t size) {
+    size_t bytes;
+    if(__builtin_mul_overflow(count, size, &bytes) || bytes > MAX_REQUEST) return nullptr;
+
+    size_t blockSize = align(bytes);
+    if(blockSize < this->minPayload()) blockSize = this->minPayload();
+
+    if(word_t* data = this->allocFromFreeList(blockSize)) {
+        this->countAlloc(getHeader(data));
+        memset(data, 0, bytes);
+        return data;
+    }
+
+    word_t* data = this->allocFromOS(blockSize);
+    if(!data) return nullptr;
+
+    this->countAlloc(getHeader(data));
+    if(!this->provider->zeroFilled()) memset(data, 0, bytes);
+
+    return data;
+}
+
+//takes a block padded by the alignment and cuts it at the aligned address, the front
+//and the tail go back on the free list and merge with their neighbours
+word_t* ExplicitAllocator::allocAligned(size_t size, size_t alignment) {
+    if(!isValidAlignment(alignment)) return nullptr;
+    if(alignment <= sizeof(word_t)) return this->alloc(size);
+    if(size > MAX_REQUEST) return nullptr; //then neither aligning it nor the padding wraps
+
+    size = align(size);
+    if(size < this->minPayload()) size = this->minPayload();
+
+    //room for the aligned payload wherever the block starts
+    size_t padded = size + this->minPayload() + alignment;
+
+    word_t* data = this->allocFromFreeList(padded);
+    if(!data) data = this->allocFromOS(padded);
+    if(!data) return nullptr;
+
+    Block* block = getHeader(data);
+    if(size_t lead = alignedLead(data, alignment, this->minPayload())) {
+        Block* front = block;
+        block = splitFront(front, lead);
+        if(front == this->top) this->top = block;
+        this->stats.splits.add();
+        this->freeBlock(front); //merges the front with a free predecessor
+    }
+
+    if(block->size() >= size + HEADER_SIZE + this->minPayload()) {
+        this->split(block, size);
+        this->freeBlock(this->getPhysicalNextBlock(block));
+    }
+
+    this->lastAllocated = block;
+    this->countAlloc(block);
+    return block->data;
+}
+
+//resizes in place when possible: shrinking splits off the tail, growing takes a free
+//successor or extends the heap at top; only otherwise the payload moves
+word_t* ExplicitAllocator::realloc(word_t* data, size_t size) {
+    if(data == nullptr) return this->alloc(size);
+    if(size == 0) {
+        this->free(data);
+        return nullptr;
+    }
+
+    if(size > MAX_REQUEST) return nullptr; //the block stays as it is
+
+    Block* block = getHeader(data);
+    size_t oldSize = block->size();
+
+    size = align(size);
+    if(size < this->minPayload()) size = this->minPayload();
+
+    if(size > block->size()) this->absorbNext(block, size);
+    if(size > block->size()) this->growTop(block, size);
+
+    if(size <= block->size()) {
+        if(block->size() >= size + HEADER_SIZE + this->minPayload()) {
+            this->split(block, size);
+            this->freeBlock(this->getPhysicalNextBlock(block)); //merges the tail with a free successor
+        }
+        this->stats.liveBytes.add(block->size() - oldSize); //wraps back down when it shrank
+        return data;
+    }
+
+    word_t* newData = this->alloc(size);
+    if(!newData) return nullptr;
+
+    memcpy(newData, data, oldSize);
+    this->free(data);
+
+    return newData;
 }
\ No newline at end of file
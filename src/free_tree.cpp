@@ -0,0 +1,312 @@
+#include "free_tree.h"
+
+FreeTree::Node* FreeTree::node(Block* block) const {
+    return reinterpret_cast<Node*>(reinterpret_cast<char*>(block->data) + this->nodeOffset);
+}
+
+Block* FreeTree::parent(Block* block) const {
+    return reinterpret_cast<Block*>(this->node(block)->parentColor & ~(uintptr_t)1);
+}
+
+bool FreeTree::isRed(Block* block) const {
+    return block && (this->node(block)->parentColor & 1);
+}
+
+void FreeTree::setParent(Block* block, Block* parent) {
+    Node* n = this->node(block);
+    n->parentColor = reinterpret_cast<uintptr_t>(parent) | (n->parentColor & 1);
+}
+
+void FreeTree::setRed(Block* block, bool red) {
+    Node* n = this->node(block);
+    n->parentColor = red ? (n->parentColor | 1) : (n->parentColor & ~(uintptr_t)1);
+}
+
+//the address breaks ties, so every key is unique
+bool FreeTree::less(Block* a, Block* b) {
+    if(a->size() != b->size()) return a->size() < b->size();
+    return a < b;
+}
+
+Block* FreeTree::minimum(Block* block) const {
+    while(this->left(block)) block = this->left(block);
+    return block;
+}
+
+void FreeTree::rotateLeft(Block* x) {
+    Block* y = this->right(x);
+
+    this->right(x) = this->left(y);
+    if(this->left(y)) this->setParent(this->left(y), x);
+
+    this->transplant(x, y);
+
+    this->left(y) = x;
+    this->setParent(x, y);
+}
+
+void FreeTree::rotateRight(Block* x) {
+    Block* y = this->left(x);
+
+    this->left(x) = this->right(y);
+    if(this->right(y)) this->setParent(this->right(y), x);
+
+    this->transplant(x, y);
+
+    this->right(y) = x;
+    this->setParent(x, y);
+}
+
+//puts `to` where `from` hangs in the tree, `from` keeps its own links
+void FreeTree::transplant(Block* from, Block* to) {
+    Block* p = this->parent(from);
+
+    if(!p) this->root = to;
+    else if(from == this->left(p)) this->left(p) = to;
+    else this->right(p) = to;
+
+    if(to) this->setParent(to, p);
+}
+
+void FreeTree::insert(Block* block) {
+    Block* p = nullptr;
+    Block* x = this->root;
+
+    while(x) {
+        p = x;
+        x = less(block, x) ? this->left(x) : this->right(x);
+    }
+
+    Node* n = this->node(block);
+    n->left = nullptr;
+    n->right = nullptr;
+    n->parentColor = reinterpret_cast<uintptr_t>(p) | 1;
+
+    if(!p) this->root = block;
+    else if(less(block, p)) this->left(p) = block;
+    else this->right(p) = block;
+
+    this->insertFixup(block);
+    this->count++;
+}
+
+void FreeTree::insertFixup(Block* z) {
+    while(this->isRed(this->parent(z))) {
+        Block* p = this->parent(z);
+        Block* g = this->parent(p); //exists, the root is black
+
+        if(p == this->left(g)) {
+            Block* uncle = this->right(g);
+
+            if(this->isRed(uncle)) {
+                this->setRed(p, false);
+                this->setRed(uncle, false);
+                this->setRed(g, true);
+                z = g;
+            } else {
+                if(z == this->right(p)) {
+                    z = p;
+                    this->rotateLeft(z);
+                    p = this->parent(z);
+                }
+                this->setRed(p, false);
+                this->setRed(g, true);
+                this->rotateRight(g);
+            }
+        } else {
+            Block* uncle = this->left(g);
+
+            if(this->isRed(uncle)) {
+                this->setRed(p, false);
+                this->setRed(uncle, false);
+                this->setRed(g, true);
+                z = g;
+            } else {
+                if(z == this->left(p)) {
+                    z = p;
+                    this->rotateRight(z);
+                    p = this->parent(z);
+                }
+                this->setRed(p, false);
+                this->setRed(g, true);
+                this->rotateLeft(g);
+            }
+        }
+    }
+
+    this->setRed(this->root, false);
+}
+
+void FreeTree::remove(Block* z) {
+    Block* y = z;
+    bool removedRed = this->isRed(y);
+    Block* x;
+    Block* xParent;
+
+    if(!this->left(z)) {
+        x = this->right(z);
+        xParent = this->parent(z);
+        this->transplant(z, x);
+    } else if(!this->right(z)) {
+        x = this->left(z);
+        xParent = this->parent(z);
+        this->transplant(z, x);
+    } else {
+        //the successor takes z's place and color
+        y = this->minimum(this->right(z));
+        removedRed = this->isRed(y);
+        x = this->right(y);
+
+        if(this->parent(y) == z) {
+            xParent = y;
+        } else {
+            xParent = this->parent(y);
+            this->transplant(y, x);
+            this->right(y) = this->right(z);
+            this->setParent(this->right(y), y);
+        }
+
+        this->transplant(z, y);
+        this->left(y) = this->left(z);
+        this->setParent(this->left(y), y);
+        this->setRed(y, this->isRed(z));
+    }
+
+    if(!removedRed) this->removeFixup(x, xParent);
+    this->count--;
+}
+
+//x carries an extra black; it may be null, so its parent is passed along
+void FreeTree::removeFixup(Block* x, Block* p) {
+    while(x != this->root && !this->isRed(x)) {
+        if(x == this->left(p)) {
+            Block* w = this->right(p);
+
+            if(this->isRed(w)) {
+                this->setRed(w, false);
+                this->setRed(p, true);
+                this->rotateLeft(p);
+                w = this->right(p);
+            }
+
+            if(!this->isRed(this->left(w)) && !this->isRed(this->right(w))) {
+                this->setRed(w, true);
+                x = p;
+                p = this->parent(x);
+            } else {
+                if(!this->isRed(this->right(w))) {
+                    this->setRed(this->left(w), false);
+                    this->setRed(w, true);
+                    this->rotateRight(w);
+                    w = this->right(p);
+                }
+                this->setRed(w, this->isRed(p));
+                this->setRed(p, false);
+                this->setRed(this->right(w), false);
+                this->rotateLeft(p);
+                x = this->root;
+            }
+        } else {
+            Block* w = this->left(p);
+
+            if(this->isRed(w)) {
+                this->setRed(w, false);
+                this->setRed(p, true);
+                this->rotateRight(p);
+                w = this->left(p);
+            }
+
+            if(!this->isRed(this->left(w)) && !this->isRed(this->right(w))) {
+                this->setRed(w, true);
+                x = p;
+                p = this->parent(x);
+            } else {
+                if(!this->isRed(this->left(w))) {
+                    this->setRed(this->right(w), false);
+                    this->setRed(w, true);
+                    this->rotateLeft(w);
+                    w = this->left(p);
+                }
+                this->setRed(w, this->isRed(p));
+                this->setRed(p, false);
+                this->setRed(this->left(w), false);
+                this->rotateRight(p);
+                x = this->root;
+            }
+        }
+    }
+
+    if(x) this->setRed(x, false);
+}
+
+Block* FreeTree::lowerBound(size_t size) const {
+    Block* best = nullptr;
+    Block* x = this->root;
+
+    while(x) {
+        if(x->size() >= size) {
+            best = x;
+            x = this->left(x);
+        } else {
+            x = this->right(x);
+        }
+    }
+
+    return best;
+}
+
+Block* FreeTree::largest() const {
+    Block* x = this->root;
+    while(x && this->right(x)) x = this->right(x);
+    return x;
+}
+
+Block* FreeTree::first() const {
+    return this->root ? this->minimum(this->root) : nullptr;
+}
+
+Block* FreeTree::next(Block* block) const {
+    if(this->right(block)) return this->minimum(this->right(block));
+
+    Block* p = this->parent(block);
+    while(p && block == this->right(p)) {
+        block = p;
+        p = this->parent(p);
+    }
+    return p;
+}
+
+int FreeTree::blackHeight(Block* block, bool& valid) const {
+    if(!block) return 1;
+
+    Block* l = this->left(block);
+    Block* r = this->right(block);
+
+    if(l && (this->parent(l) != block || !less(l, block))) valid = false;
+    if(r && (this->parent(r) != block || !less(block, r))) valid = false;
+    if(this->isRed(block) && (this->isRed(l) || this->isRed(r))) valid = false;
+
+    int leftHeight = this->blackHeight(l, valid);
+    int rightHeight = this->blackHeight(r, valid);
+    if(leftHeight != rightHeight) valid = false;
+
+    return leftHeight + (this->isRed(block) ? 0 : 1);
+}
+
+bool FreeTree::isValid() const {
+    if(!this->root) return this->count == 0;
+    if(this->isRed(this->root) || this->parent(this->root)) return false;
+
+    bool valid = true;
+    this->blackHeight(this->root, valid);
+
+    size_t walked = 0;
+    Block* previous = nullptr;
+    for(Block* block = this->first(); block; block = this->next(block)) {
+        if(previous && !less(previous, block)) valid = false;
+        previous = block;
+        walked++;
+    }
+
+    return valid && walked == this->count;
+}
\ No newline at end of file
@@ -1,170 +1,149 @@
 #include "block_utils.h"
 #include "implicit_allocator.h"
-
-//uses the strategy function as passed
-Block* ImplicitAllocator::findBlock(size_t size, FitFunction strategy) {
-    return (this->*strategy)(size);
-}
-
-//return the first empty block that can fit the requirement
-Block* ImplicitAllocator::firstFit(size_t size) {
-    Block* block = this->heapStart;
-    
-    while(block != nullptr) {
-        if(!block->used && block->size >= size) {
-            return block;
-        }
-        
-        block = block->next;
-    }
-
-    return nullptr;
-}
-
-//returns the first empty block starting from the last allocated block that can fit the requirement
-Block* ImplicitAllocator::nextFit(size_t size) {
-    if(!this->lastAllocated) return nullptr; // no blocks yet
-
-    Block* block = this->lastAllocated->next ? this->lastAllocated->next : this->heapStart;
-    Block* start = block;
-
-    do {
-        if(!block->used && block->size >= size) {
-            return block;
-        }
-
-        block = block->next ? block->next : this->heapStart;
-    } while(block != start);
-
-    return nullptr;
-}
-
-//returns the block that can fit the requirement and of the smallest possible size
-Block* ImplicitAllocator::bestFit(size_t size) {
-    Block* block = this->heapStart;
-    Block* resBlock = nullptr;
-
-    while(block != nullptr) {
-        if(!block->used && block->size >= size) {
-            if(resBlock == nullptr || block->size < resBlock->size) {
-                resBlock = block;
-            }
-        }
-        
-        block = block->next;
-    }
-
-    return resBlock;
-}
-
-Block* ImplicitAllocator::worstFit(size_t size) {
-    Block* block = this->heapStart;
-    Block* resBlock = nullptr;
-
-    while(block != nullptr) {
-        if(!block->used && block->size >= size) {
-            if(resBlock == nullptr || block->size > resBlock->size) {
-                resBlock = block;
-            }
-        }
-        
-        block = block->next;
-    }
-
-    return resBlock;
-}
+#include <cstring>
 
 /*
-Block = header + data + extra data
+Block = header + payload
 
-block1 = header + data + size - data -> to allocate
-block2 = header + data
+block1 = header + size -> to allocate
+block2 = header + MIN_PAYLOAD
 
-therefore, Block - block1 >= block2
-Block >= block1 + block2
-header + extra data >= 2header + size
-extra data >= header + data + size - data
+therefore, Block >= block1 + block2
+header + payload >= 2header + size + MIN_PAYLOAD
 
-block->size >= sizeof(Block) + size 
-Block->size = data + extra data */
+block->size >= HEADER_SIZE + MIN_PAYLOAD + size */
 bool ImplicitAllocator::canSplit(Block* block, size_t size) {
-    return (block->size >= sizeof(Block) + size);
+    return (block->size() >= HEADER_SIZE + this->minPayload() + size);
 } 
 
+//an indexed free block carries its tree node in the payload
+size_t ImplicitAllocator::minPayload() {
+    return this->indexFreeBlocks ? FreeTree::NODE_SIZE : MIN_PAYLOAD;
+}
+
 /* 
 block1 block2
 i will allocate to block1
 
-block1 -> sizeof(Block) + size - sizeof(word_t)
+block1 -> HEADER_SIZE + size
 block2 starts from offset + size of above block
 
-sizeof(Block) + block->size - sizeof(word_t)
-block1 = sizeof(Block) + size - sizeof(word_t)
-block2 = sizeof(Block) + x - sizeof(word_t)
+HEADER_SIZE + originalBlockSize = 
+HEADER_SIZE + size + HEADER_SIZE + x
 
-sizeof(Block) + originalBlockSize - sizeof(word_t) = 
-2sizeof(Block) + size + x - 2sizeof(word_t)
-
-x = sizeof(word_t) + block->size - size - sizeof(Block) */
+x = originalBlockSize - size - HEADER_SIZE */
 Block* ImplicitAllocator::split(Block* block, size_t size) {
-    Block* originalNextBlock = nullptr;
-    size_t originalBlockSize = block->size;
-
-    if(block->next != nullptr) {
-        originalNextBlock = block->next;
-    }
+    size_t originalBlockSize = block->size();
 
     char *newBlockPtr = reinterpret_cast<char*>(block->data) + size;
     Block *newBlock = reinterpret_cast<Block*>(newBlockPtr);
     
-    newBlock->used = false;
-    newBlock->size = sizeof(word_t) + originalBlockSize - size - sizeof(Block);
-    newBlock->next = originalNextBlock;
+    newBlock->header = originalBlockSize - size - HEADER_SIZE;
+    newBlock->setUsed(false);
 
-    block->size = size;
-    block->next = newBlock;
+    if(block == this->top) this->top = newBlock;
+
+    block->setSize(size);
+    this->stats.splits.add();
 
     return block;
 }
 
-word_t* ImplicitAllocator::alloc(size_t size) {
+size_t ImplicitAllocator::requestSize(size_t size) {
     size = align(size);
+    if(size < this->minPayload()) size = this->minPayload();
+    return size;
+}
+
+word_t* ImplicitAllocator::alloc(size_t size) {
+    if(size > MAX_REQUEST) return nullptr;
+    size = this->requestSize(size);
 
-    if(auto block = this->findBlock(size, &ImplicitAllocator::firstFit)) {
-        if(this->canSplit(block, size)) block = this->split(block, size);
-        this->lastAllocated = block;
-        block->used = true;
-        return block->data;
-    }   
+    word_t* data;
+    if(Block* block = this->findBlock(size)) data = this->takeFreeBlock(block, size);
+    else data = this->allocFromOS(size);
 
-    auto block = requestFromOS(size);
+    if(data) this->countAlloc(getHeader(data));
+    return data;
+}
+
+word_t* ImplicitAllocator::takeFreeBlock(Block* block, size_t size) {
+    if(this->indexFreeBlocks) this->freeTree.remove(block);
+    this->stats.freeBlocks.sub();
+    this->stats.freeBytes.sub(block->size());
+
+    if(this->canSplit(block, size)) {
+        block = this->split(block, size);
+        Block* remainder = this->getPhysicalNextBlock(block);
+        if(this->indexFreeBlocks) this->freeTree.insert(remainder);
+        this->stats.freeBlocks.add();
+        this->stats.freeBytes.add(remainder->size());
+    }
+    this->lastAllocated = block;
+    block->setUsed(true);
+    return block->data;
+}
+
+//appends a new block after top, size must already be aligned
+word_t* ImplicitAllocator::allocFromOS(size_t size) {
+    auto block = requestFromOS(this->provider, size);
     if(!block) return nullptr;
+    this->stats.osRequests.add();
+    this->stats.osBytes.add(allocSize(size));
 
-    block->size = size;
-    block->used = true;
-    block->next = nullptr;
+    block->header = size;
+    block->setUsed(true);
 
     if(this->heapStart == nullptr) {
         this->heapStart = block;
     }
 
-    if(this->top != nullptr) {
-        this->top->next = block;
-    }
-
     this->lastAllocated = block;
     this->top = block;
 
     return block->data;
 }
 
+word_t* ImplicitAllocator::allocAligned(size_t size, size_t alignment) {
+    if(!isValidAlignment(alignment)) return nullptr;
+    if(alignment <= sizeof(word_t)) return this->alloc(size);
+    if(size > MAX_REQUEST) return nullptr; //then neither aligning it nor the padding wraps
+
+    size = align(size);
+    if(size < this->minPayload()) size = this->minPayload();
+
+    //room for the aligned payload wherever the block starts
+    size_t padded = size + this->minPayload() + alignment;
+
+    word_t* data;
+    if(Block* found = this->findBlock(padded)) data = this->takeFreeBlock(found, padded);
+    else data = this->allocFromOS(padded);
+    if(!data) return nullptr;
+
+    Block* block = getHeader(data);
+    if(size_t lead = alignedLead(data, alignment, this->minPayload())) {
+        Block* front = block;
+        block = splitFront(front, lead);
+        if(front == this->top) this->top = block;
+        this->stats.splits.add();
+        this->freeBlock(front);
+    }
+
+    if(this->canSplit(block, size)) {
+        this->split(block, size);
+        this->freeBlock(this->getPhysicalNextBlock(block)); //merges the tail with a free successor
+    }
+
+    this->lastAllocated = block;
+    this->countAlloc(block);
+    return block->data;
+}
+
 bool ImplicitAllocator::canCoalesce(Block *block) {
-    if(block->next == nullptr) return false;
-    if(block->used || block->next->used) return false; 
-    
-    //physical check for more security
-    char *blockEnd = reinterpret_cast<char*>(block) + sizeof(Block) + block->size - sizeof(word_t); 
-    return (reinterpret_cast<char*>(block->next) == blockEnd);
+    Block* nextBlock = this->getPhysicalNextBlock(block);
+
+    if(nextBlock == nullptr) return false;
+    return !block->isUsed() && !nextBlock->isUsed();
 }
 
 /*
@@ -178,20 +157,114 @@ payload = payload1 + header2 + payload2
 we don't need the header of the second block
 so we can utilise it for the user payload memory*/
 Block* ImplicitAllocator::coalesce(Block* block) {
-    Block* nextBlock = block->next;
+    Block* nextBlock = this->getPhysicalNextBlock(block);
+    if(this->indexFreeBlocks) this->freeTree.remove(nextBlock);
+
+    block->setSize(block->size() + nextBlock->size() + HEADER_SIZE);
 
-    size_t HEADER_SIZE = sizeof(Block) - sizeof(word_t);
-    block->size += nextBlock->size + HEADER_SIZE;
-    block->next = nextBlock->next;
+    if(nextBlock == this->top) this->top = block;
+    if(nextBlock == this->lastAllocated) this->lastAllocated = block;
+    this->stats.coalesces.add();
+    this->stats.freeBlocks.sub();
+    this->stats.freeBytes.sub(nextBlock->size());
 
     return block;
 }
 
 void ImplicitAllocator::free(word_t* data) {
     Block* block = getHeader(data); //points to the starting of the block now
-    block->used = false;
+    this->countFree(block);
+    this->freeBlock(block);
+}
+
+void ImplicitAllocator::freeBlock(Block* block) {
+    block->setUsed(false);
 
     if(this->canCoalesce(block)) {
         this->coalesce(block);
     }
+
+    if(this->indexFreeBlocks) this->freeTree.insert(block);
+    this->stats.freeBlocks.add();
+    this->stats.freeBytes.add(block->size());
+}
+
+void ImplicitAllocator::free(word_t* data, size_t size) {
+    if(this->verifySizedFree) verifyFreeSize(data, size, getHeader(data)->size());
+    this->free(data);
+}
+
+//merges the run of free blocks after a used block when that gets it to `size`
+//(free only merges forward, so free neighbours can sit side by side)
+//a run reaching top is always taken, growTop can extend it further
+bool ImplicitAllocator::absorbNext(Block* block, size_t size) {
+    size_t available = block->size();
+    Block* nextBlock = this->getPhysicalNextBlock(block);
+    Block* last = block;
+
+    while(nextBlock && !nextBlock->isUsed() && available < size) {
+        available += HEADER_SIZE + nextBlock->size();
+        last = nextBlock;
+        nextBlock = this->getPhysicalNextBlock(nextBlock);
+    }
+
+    if(last == block || (available < size && last != this->top)) return false;
+
+    //nextBlock is now the first block after the run, nullptr when the run ends at top
+    while(this->getPhysicalNextBlock(block) != nextBlock) {
+        this->coalesce(block);
+    }
+    return true;
+}
+
+//the top block can grow in place while the heap behind the provider ends right after it
+bool ImplicitAllocator::growTop(Block* block, size_t size) {
+    if(block != this->top) return false;
+
+    char* end = reinterpret_cast<char*>(block->data) + block->size();
+    if(this->provider->extend(0) != end) return false; //someone else grew the provider since
+    if(!this->provider->extend(size - block->size())) return false;
+    this->stats.osRequests.add();
+    this->stats.osBytes.add(size - block->size());
+
+    block->setSize(size);
+    return true;
+}
+
+//resizes in place when possible: shrinking splits off the tail, growing takes a free
+//successor or extends the heap at top; only otherwise the payload moves
+word_t* ImplicitAllocator::realloc(word_t* data, size_t size) {
+    if(data == nullptr) return this->alloc(size);
+    if(size == 0) {
+        this->free(data);
+        return nullptr;
+    }
+
+    if(size > MAX_REQUEST) return nullptr; //the block stays as it is
+
+    Block* block = getHeader(data);
+    size_t oldSize = block->size();
+
+    size = align(size);
+    if(size < this->minPayload()) size = this->minPayload();
+
+    if(size > block->size()) this->absorbNext(block, size);
+    if(size > block->size()) this->growTop(block, size);
+
+    if(size <= block->size()) {
+        if(this->canSplit(block, size)) {
+            this->split(block, size);
+            this->freeBlock(this->getPhysicalNextBlock(block)); //merges the tail with a free successor
+        }
+        this->stats.liveBytes.add(block->size() - oldSize); //wraps back down when it shrank
+        return data;
+    }
+
+    word_t* newData = this->alloc(size);
+    if(!newData) return nullptr;
+
+    memcpy(newData, data, oldSize);
+    this->free(data);
+
+    return newData;
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "region_allocator.h"
+#include <cstdint>
+
+static char* alignUp(char* p, size_t alignment) {
+    return (char*)(((uintptr_t)p + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+//slow path of alloc: the current chunk is tried with the alignment applied,
+//then the next chunk, which is large enough for the worst-case padding
+word_t* RegionAllocator::carve(size_t size, size_t alignment) {
+    char* start = alignUp(this->cursor, alignment);
+    if(this->cursor == nullptr || start > this->limit || size > (size_t)(this->limit - start)) {
+        size_t needed;
+        if(__builtin_add_overflow(size, alignment - sizeof(word_t), &needed)) return nullptr;
+        if(!this->nextChunk(needed)) return nullptr;
+        start = alignUp(this->cursor, alignment);
+    }
+
+    this->cursor = start + align(size);
+    return reinterpret_cast<word_t*>(start);
+}
+
+word_t* RegionAllocator::allocAligned(size_t size, size_t alignment) {
+    if(!isValidAlignment(alignment)) return nullptr;
+    if(alignment <= sizeof(word_t)) return this->alloc(size);
+    return this->carve(size, alignment);
+}
+
+//the first spare chunk with room for `needed` bytes, else a new one from the provider;
+//chunks double up to MAX_CHUNK and a request that does not fit one gets a chunk of its size
+bool RegionAllocator::nextChunk(size_t needed) {
+    Chunk** link = &this->spare;
+    while(*link && (size_t)((*link)->end - (*link)->data()) < needed) link = &(*link)->prev;
+
+    Chunk* chunk = *link;
+    if(chunk) {
+        *link = chunk->prev;
+    } else {
+        size_t size = this->growth;
+        if(needed > size - sizeof(Chunk)) {
+            if(needed > SIZE_MAX - sizeof(Chunk) - sizeof(word_t)) return false;
+            size = align(needed + sizeof(Chunk));
+        }
+
+        chunk = (Chunk*)this->provider->extend(size);
+        if(!chunk) return false;
+        chunk->end = (char*)chunk + size;
+        this->stats.osRequests.add();
+        this->stats.osBytes.add(size);
+
+        if(this->growth < MAX_CHUNK) this->growth *= 2;
+    }
+
+    if(this->current == nullptr) this->first = chunk;
+    chunk->prev = this->current;
+    this->current = chunk;
+    this->cursor = chunk->data();
+    this->limit = chunk->end;
+    return true;
+}
+
+void RegionAllocator::rewind(Checkpoint mark) {
+    while(this->current != mark.chunk) {
+        Chunk* chunk = this->current;
+        this->current = chunk->prev;
+        chunk->prev = this->spare;
+        this->spare = chunk;
+    }
+
+    if(this->current == nullptr) {
+        this->first = nullptr;
+        this->cursor = this->limit = nullptr;
+        return;
+    }
+
+    this->cursor = mark.cursor;
+    this->limit = this->current->end;
+}
+
+void RegionAllocator::reset() {
+    if(this->current == nullptr) return;
+
+    this->first->prev = this->spare;
+    this->spare = this->current;
+    this->current = this->first = nullptr;
+    this->cursor = this->limit = nullptr;
+}
+
+AllocStats RegionAllocator::getStats() const {
+    AllocStats stats = this->stats.read();
+
+    for(Chunk* chunk = this->current; chunk; chunk = chunk->prev) {
+        char* end = (chunk == this->current) ? this->cursor : chunk->end;
+        stats.liveBytes += end - chunk->data();
+    }
+    if(this->current) stats.freeBytes += this->limit - this->cursor;
+
+    for(Chunk* chunk = this->spare; chunk; chunk = chunk->prev) {
+        stats.freeBytes += chunk->end - chunk->data();
+        stats.freeBlocks++;
+    }
+    return stats;
+}
@@ -1,4 +1,39 @@
 #include "segregated_allocator.h"
+#include <cstring>
+
+//a small bucket reuses blocks of its own size class but never merges them:
+//with a shared provider a block's physical neighbour can belong to another bucket
+//the open-ended last bucket keeps its blocks in a tree and takes the best fit, a first-fit
+//walk would pass over ever more unmergeable leftovers too small for the request
+//with a heap of its own (every bucket has one here) it also merges its blocks and trims
+//its top like an ExplicitAllocator, and its blocks always come back to it, whatever their size
+SegregatedListAllocator::SegregatedListAllocator() {
+    for(int i = 0; i < NUM_BUCKETS - 1; i++) {
+        segregatedList[i].coalesceMode = ExplicitAllocator::CoalesceMode::None;
+    }
+    segregatedList[NUM_BUCKETS - 1].indexFreeBlocks = true;
+    segregatedList[NUM_BUCKETS - 1].searchMode = ExplicitAllocator::SearchMode::BestFit;
+}
+
+SegregatedListAllocator::SegregatedListAllocator(ChunkProvider* provider)
+    : SegregatedListAllocator() {
+    useSlabs = false;
+    mmapThreshold = 0;
+    for(int i = 0; i < NUM_BUCKETS; i++) {
+        segregatedList[i].coalesceMode = ExplicitAllocator::CoalesceMode::None;
+        segregatedList[i].provider = provider;
+    }
+}
+
+SegregatedListAllocator::SegregatedListAllocator(ChunkProvider* provider, ChunkProvider* runs)
+    : slabs(runs) {
+    for(int i = 0; i < NUM_BUCKETS; i++) {
+        segregatedList[i].coalesceMode = ExplicitAllocator::CoalesceMode::None;
+        segregatedList[i].provider = provider;
+    }
+    segregatedList[NUM_BUCKETS - 1].indexFreeBlocks = true;
+    segregatedList[NUM_BUCKETS - 1].searchMode = ExplicitAllocator::SearchMode::BestFit;
+}
 
 //8 16 32 64 128 >128
 //0  1  2  3   4    5
@@ -11,13 +46,586 @@ int SegregatedListAllocator::getBucket(size_t size) {
     return 5;
 }
 
+//payload of every block in a small bucket
+size_t SegregatedListAllocator::bucketSize(int bucket) {
+    return sizeof(word_t) << bucket;
+}
+
+//smallest piece worth cutting off a block: with slabs serving everything up to 64 bytes,
+//the heap lists of the buckets below 128 bytes are never taken from again
+//(also room for a free block of the merging heap, should the piece come from there)
+size_t SegregatedListAllocator::minSlack() {
+    size_t slack = useSlabs ? bucketSize(NUM_BUCKETS - 2) : MIN_PAYLOAD;
+    return slack > largeMinPayload() ? slack : largeMinPayload();
+}
+
+//smallest block of the open-ended bucket's heap, whose free blocks may carry a footer
+size_t SegregatedListAllocator::largeMinPayload() {
+    return segregatedList[NUM_BUCKETS - 1].minPayload();
+}
+
+//true while the open-ended bucket merges its blocks, which it only does with a heap of its own
+bool SegregatedListAllocator::largeMerges() const {
+    return segregatedList[NUM_BUCKETS - 1].coalesceMode != ExplicitAllocator::CoalesceMode::None;
+}
+
+//blocks between the start and the top of the merging heap, whose provider is its own
+//so the range holds nothing else
+bool SegregatedListAllocator::inLargeHeap(Block* block) {
+    ExplicitAllocator& large = segregatedList[NUM_BUCKETS - 1];
+    return largeMerges() && block >= large.heapStart && block <= large.top;
+}
+
+//bucket a heap block goes back to when freed: the merging heap's blocks return to it,
+//any other block to the largest bucket it serves, never into the merging heap
+int SegregatedListAllocator::homeBucket(Block* block) {
+    if(inLargeHeap(block)) return NUM_BUCKETS - 1;
+
+    int bucket = getFreeBucket(block->size());
+    if(bucket == NUM_BUCKETS - 1 && largeMerges()) bucket--;
+    return bucket;
+}
+
+//payload alloc hands out for a request of `size` bytes
+size_t SegregatedListAllocator::requestSize(size_t size) {
+    if(size < MIN_PAYLOAD) return MIN_PAYLOAD;
+    int bucket = getBucket(size);
+    return bucket < NUM_BUCKETS - 1 ? bucketSize(bucket) : align(size);
+}
+
+//largest bucket whose every request a free block of this size can serve
+int SegregatedListAllocator::getFreeBucket(size_t blockSize) {
+    int bucket = getBucket(blockSize);
+    if(bucket < NUM_BUCKETS - 1 && blockSize < bucketSize(bucket)) bucket--;
+    return bucket < 0 ? 0 : bucket;
+}
+
+size_t SegregatedListAllocator::usableSize(word_t* data) {
+    if(slabs.owns(data)) return SlabAllocator::runOf(data)->objectSize;
+    return getHeader(data)->sharedSize(); //no lock taken, see Block::setPrevUsedShared
+}
+
+void SegregatedListAllocator::updateBucketBit(int bucket) {
+    if(segregatedList[bucket].freeListHead) nonEmptyBuckets |= (1u << bucket);
+    else nonEmptyBuckets &= ~(1u << bucket);
+}
+
+void SegregatedListAllocator::countAlloc(Block* block) {
+    segregatedList[homeBucket(block)].countAlloc(block);
+}
+
+void SegregatedListAllocator::countFree(Block* block) {
+    segregatedList[homeBucket(block)].countFree(block);
+}
+
+void SegregatedListAllocator::releaseBlock(Block* block) {
+    int bucket = homeBucket(block);
+    segregatedList[bucket].freeBlock(block);
+    updateBucketBit(bucket);
+}
+
+word_t* SegregatedListAllocator::allocMapped(size_t size, size_t alignment) {
+    Block* block = mapBlock(size, alignment);
+    if(!block) return nullptr;
+
+    mappedStats.allocs.addShared();
+    mappedStats.osRequests.addShared();
+    mappedStats.osBytes.addShared(mappingSize(block));
+    mappedStats.liveBytes.addShared(block->size());
+    return block->data;
+}
+
+void SegregatedListAllocator::freeMapped(Block* block) {
+    mappedStats.frees.addShared();
+    mappedStats.osBytes.subShared(mappingSize(block));
+    mappedStats.liveBytes.subShared(block->size());
+    unmapBlock(block);
+}
+
+//hands out a free block of bucket `source`, splitting off what the request does not need
+//the remainder goes to the bucket matching its own size, keeping every small
+//bucket's list made of blocks that fit all of its requests; the merging heap keeps its
+//remainders and its neighbours' boundary tags up to date
+word_t* SegregatedListAllocator::takeBlock(int source, Block* block, size_t size) {
+    ExplicitAllocator& list = segregatedList[source];
+
+    if(list.coalesceMode != ExplicitAllocator::CoalesceMode::None) {
+        word_t* data = list.takeFreeBlock(block, size);
+        updateBucketBit(source);
+        return data;
+    }
+
+    list.removeFromFreeList(block);
+    updateBucketBit(source);
+
+    if(list.canSplit(block, size)) {
+        list.split(block, size);
+        Block* remainder = reinterpret_cast<Block*>(reinterpret_cast<char*>(block->data) + size);
+
+        int target = getFreeBucket(remainder->size());
+        segregatedList[target].addToFreeList(remainder);
+        updateBucketBit(target);
+    }
+
+    block->setUsed(true);
+    return block->data;
+}
+
+//cuts a block handed out down to `size` bytes and releases the tail, false when the tail
+//is too small to be handed out again (it stays on the block); the heap whose top it is
+//moves its top along, the merging heap merges the tail with a free successor
+bool SegregatedListAllocator::shrinkBlock(Block* block, size_t size) {
+    if(inLargeHeap(block)) {
+        ExplicitAllocator& large = segregatedList[NUM_BUCKETS - 1];
+        if(size < largeMinPayload()) size = largeMinPayload();
+        if(block->size() < size + HEADER_SIZE + largeMinPayload()) return false;
+
+        large.split(block, size);
+        releaseBlock(large.getPhysicalNextBlock(block));
+        return true;
+    }
+
+    if(block->size() < size + HEADER_SIZE + minSlack()) return false;
+
+    ExplicitAllocator* owner = &segregatedList[getFreeBucket(size)];
+    for(ExplicitAllocator& list : segregatedList) {
+        if(list.top == block) owner = &list;
+    }
+
+    owner->split(block, size);
+    releaseBlock(reinterpret_cast<Block*>(reinterpret_cast<char*>(block->data) + size));
+    return true;
+}
+
+//requests up to 64 bytes are served from slab runs with no block header at all
+//small buckets hand out blocks of the full bucket size, so the head of their list
+//always fits; an empty bucket borrows from the smallest non-empty larger bucket
+//(found with one count-trailing-zeros) before the heap grows
 word_t* SegregatedListAllocator::alloc(size_t size) {
+    if(useSlabs && size <= SlabAllocator::MAX_SIZE) {
+        return slabs.alloc(getBucket(size));
+    }
+
+    if(mmapThreshold && size >= mmapThreshold) return allocMapped(size);
+
+    bool zeroed;
+    word_t* data = allocBlock(size, zeroed);
+    if(data) countAlloc(getHeader(data));
+    return data;
+}
+
+//bucket path of alloc, `zeroed` tells whether the block came untouched from a zero-filling provider
+word_t* SegregatedListAllocator::allocBlock(size_t size, bool& zeroed) {
+    zeroed = false;
+    if(size < MIN_PAYLOAD) size = MIN_PAYLOAD;
+
     int bucket = getBucket(size);
-    return segregatedList[bucket].alloc(size);
+    if(bucket < NUM_BUCKETS - 1) size = bucketSize(bucket);
+    else size = align(size);
+
+    if(nonEmptyBuckets & (1u << bucket)) {
+        ExplicitAllocator& list = segregatedList[bucket];
+        if(Block* block = list.findBlock(size)) {
+            return takeBlock(bucket, block, size);
+        }
+    }
+
+    //any block in a larger small bucket is bigger than the request, the merging heap's
+    //free blocks come in any size and are searched (for one that can also be freed there)
+    unsigned larger = nonEmptyBuckets & ~((2u << bucket) - 1);
+    if(larger) {
+        int source = __builtin_ctz(larger);
+        ExplicitAllocator& list = segregatedList[source];
+        if(list.coalesceMode == ExplicitAllocator::CoalesceMode::None) {
+            return takeBlock(source, list.freeListHead, size);
+        }
+
+        size_t needed = size < largeMinPayload() ? largeMinPayload() : size;
+        if(Block* block = list.findBlock(needed)) return takeBlock(source, block, needed);
+    }
+
+    //the merging heap extends a free top instead of leaving it behind a new block
+    ExplicitAllocator& large = segregatedList[NUM_BUCKETS - 1];
+    Block* top = large.top;
+    if(bucket == NUM_BUCKETS - 1 && largeMerges() && top && !top->isUsed()) {
+        large.removeFromFreeList(top);
+        top->setUsed(true);
+        if(large.growTop(top, size)) {
+            updateBucketBit(bucket);
+            return top->data;
+        }
+        top->setUsed(false);
+        large.addToFreeList(top);
+    }
+
+    zeroed = segregatedList[bucket].provider->zeroFilled();
+    return segregatedList[bucket].allocFromOS(size);
+}
+
+//new mappings and fresh heap blocks already read as zero, only recycled memory
+//(and the tiny slab objects) is cleared
+word_t* SegregatedListAllocator::calloc(size_t count, size_t size) {
+    size_t bytes;
+    if(__builtin_mul_overflow(count, size, &bytes)) return nullptr;
+
+    bool zeroed = false;
+    word_t* data;
+
+    if(useSlabs && bytes <= SlabAllocator::MAX_SIZE) {
+        data = slabs.alloc(getBucket(bytes));
+    } else if(mmapThreshold && bytes >= mmapThreshold) {
+        data = allocMapped(bytes);
+        zeroed = true;
+    } else {
+        data = allocBlock(bytes, zeroed);
+        if(data) countAlloc(getHeader(data));
+    }
+
+    if(data && !zeroed) memset(data, 0, bytes);
+    return data;
 }
 
 void SegregatedListAllocator::free(word_t* data) {
+    if(slabs.owns(data)) {
+        slabs.free(data);
+        return;
+    }
+
+    Block* block = getHeader(data);
+    if(block->isMapped()) {
+        freeMapped(block);
+        return;
+    }
+
+    countFree(block);
+    releaseBlock(block);
+}
+
+//a heap block is never smaller than the class of the size it was allocated (or last
+//reallocated) for, so that bucket can take it back: the list is picked from the size and
+//the address alone, without waiting on the header; the header is still read to clear the
+//used bit and for the byte counters, which count the block's real size
+void SegregatedListAllocator::free(word_t* data, size_t size) {
+    if(slabs.owns(data)) {
+        if(verifySizedFree) verifyFreeSize(data, size, usableSize(data));
+        slabs.free(data);
+        return;
+    }
+
+    size = requestSize(size); //the payload alloc handed out for it
+    if(verifySizedFree) verifyFreeSize(data, size, usableSize(data));
+
+    //mappings are told apart by the size, the merging heap's blocks by address
     Block* block = getHeader(data);
-    int bucket = getBucket(block->size);
-    segregatedList[bucket].free(data);
-}
\ No newline at end of file
+    int bucket = getBucket(size);
+    if(bucket == NUM_BUCKETS - 1 || (mmapThreshold && size >= mmapThreshold) || inLargeHeap(block)) {
+        free(data);
+        return;
+    }
+
+    countFree(block);
+    block->setUsed(false);
+    segregatedList[bucket].addChainToFreeList(block, block, 1, block->size());
+    nonEmptyBuckets |= 1u << bucket;
+}
+
+//a free block that is already aligned (most often one an earlier aligned request gave
+//back) is taken as it is; otherwise a padded block is cut at the aligned address
+word_t* SegregatedListAllocator::allocAligned(size_t size, size_t alignment) {
+    if(!isValidAlignment(alignment)) return nullptr;
+    if(alignment <= sizeof(word_t)) return alloc(size);
+
+    //slab objects of a class are aligned to the class size
+    if(useSlabs && size <= SlabAllocator::MAX_SIZE && alignment <= SlabAllocator::MAX_SIZE) {
+        return slabs.alloc(getBucket(size > alignment ? size : alignment));
+    }
+
+    if(mmapThreshold && size >= mmapThreshold) return allocMapped(size, alignment);
+    if(size > MAX_REQUEST) return nullptr; //then neither requestSize nor the padding wraps
+
+    size = requestSize(size);
+
+    Block* block = takeAligned(size, alignment);
+    if(!block) {
+        //room for the aligned payload wherever the block starts, with a front piece large
+        //enough for a bucket that hands it out again and a block the merging heap can take back
+        size_t slack = minSlack();
+        size_t needed = size < largeMinPayload() ? largeMinPayload() : size;
+        bool zeroed;
+        word_t* data = allocBlock(needed + slack + alignment, zeroed);
+        if(!data) return nullptr;
+
+        block = getHeader(data);
+        if(size_t lead = alignedLead(data, alignment, slack)) {
+            Block* front = block;
+            block = splitFront(front, lead);
+            for(ExplicitAllocator& list : segregatedList) {
+                if(list.top == front) list.top = block;
+            }
+            segregatedList[NUM_BUCKETS - 1].stats.splits.add();
+            releaseBlock(front);
+        }
+    }
+
+    shrinkBlock(block, size);
+    countAlloc(block);
+    return block->data;
+}
+
+//looks at the first few blocks of the bucket of `size` and of the open-ended bucket,
+//where aligned blocks go back to when freed, for one with an aligned payload
+Block* SegregatedListAllocator::takeAligned(size_t size, size_t alignment) {
+    int buckets[] = {getBucket(size), NUM_BUCKETS - 1};
+    int scanned = buckets[0] == buckets[1] ? 1 : 2;
+
+    for(int b = 0; b < scanned; b++) {
+        int bucket = buckets[b];
+        Block* block = segregatedList[bucket].freeListHead;
+        for(int i = 0; block && i < ALIGNED_SCAN; i++, block = block->next) {
+            if(block->size() >= size && ((uintptr_t)block->data & (alignment - 1)) == 0) {
+                //taken whole, shrinkBlock cuts it with the same rule as fresh blocks
+                takeBlock(bucket, block, block->size());
+                return block;
+            }
+        }
+    }
+    return nullptr;
+}
+
+size_t SegregatedListAllocator::allocBatch(size_t size, size_t count, word_t** out) {
+    if(useSlabs && size <= SlabAllocator::MAX_SIZE) {
+        return slabs.allocBatch(getBucket(size), count, out);
+    }
+
+    size_t done = 0;
+
+    if(mmapThreshold && size >= mmapThreshold) {
+        for(; done < count; done++) {
+            if(!(out[done] = alloc(size))) break;
+        }
+        return done;
+    }
+
+    if(size < MIN_PAYLOAD) size = MIN_PAYLOAD;
+
+    int bucket = getBucket(size);
+    if(bucket < NUM_BUCKETS - 1) size = bucketSize(bucket);
+    else size = align(size);
+
+    size_t stride = HEADER_SIZE + size;
+    size_t total;
+    if(__builtin_mul_overflow(count, stride, &total)) return 0;
+
+    ExplicitAllocator& list = segregatedList[bucket];
+    if(bucket < NUM_BUCKETS - 1) {
+        //blocks on a small bucket's list hold its class, a short one ends the run and
+        //the rest is cut from a fresh block
+        while(done < count && list.freeListHead && list.freeListHead->size() >= size) {
+            out[done] = takeBlock(bucket, list.freeListHead, size);
+            countAlloc(getHeader(out[done++]));
+        }
+    } else if(!largeMerges()) {
+        //leftovers too small for the rest of the batch are used up first, best fit first
+        //(a merging heap has no such leftovers, its free blocks grow back together)
+        while(done < count && (nonEmptyBuckets & (1u << bucket))) {
+            Block* block = list.findBlock(size);
+            if(!block || block->size() + HEADER_SIZE >= (count - done) * stride) break;
+            out[done] = takeBlock(bucket, block, size);
+            countAlloc(getHeader(out[done++]));
+        }
+    }
+
+    //the rest is cut from one block in a single pass
+    size_t remaining = count - done;
+    if(remaining == 0) return done;
+    total = remaining * stride;
+
+    //small pieces are too small for the merging heap, they are cut from their bucket's own
+    bool zeroed;
+    word_t* data;
+    if(bucket < NUM_BUCKETS - 1 && largeMerges()) {
+        data = list.allocFromOS(total - HEADER_SIZE);
+    } else {
+        data = allocBlock(total - HEADER_SIZE, zeroed);
+    }
+    if(!data) return done;
+
+    //the last piece keeps whatever the block had beyond the request
+    Block* block = getHeader(data);
+    size_t lastSize = block->size() - (remaining - 1) * stride;
+    Block* piece = block;
+
+    for(size_t i = 0; i < remaining; i++) {
+        piece = reinterpret_cast<Block*>(reinterpret_cast<char*>(block) + i * stride);
+        if(i > 0) piece->header = Block::USED | Block::PREV_USED;
+        piece->setSize(i + 1 < remaining ? size : lastSize);
+        countAlloc(piece);
+        out[done++] = piece->data;
+    }
+
+    //a block fresh from the provider was its bucket's top, which is now the last piece
+    for(ExplicitAllocator& other : segregatedList) {
+        if(other.top == block) other.top = piece;
+    }
+
+    return done;
+}
+
+void SegregatedListAllocator::freeBatch(word_t** ptrs, size_t count) {
+    Block* first[NUM_BUCKETS - 1] = {};
+    Block* last[NUM_BUCKETS - 1] = {};
+    size_t chained[NUM_BUCKETS - 1] = {};
+    size_t chainedBytes[NUM_BUCKETS - 1] = {};
+    size_t i = 0;
+
+    while(i < count) {
+        size_t slabEnd = i;
+        while(slabEnd < count && slabs.owns(ptrs[slabEnd])) slabEnd++;
+        if(slabEnd > i) {
+            slabs.freeBatch(ptrs + i, slabEnd - i);
+            i = slabEnd;
+            continue;
+        }
+
+        Block* block = getHeader(ptrs[i++]);
+        if(block->isMapped()) {
+            freeMapped(block);
+            continue;
+        }
+
+        //the open-ended bucket indexes its blocks, may merge them and purge their pages
+        int bucket = homeBucket(block);
+        segregatedList[bucket].countFree(block);
+        if(bucket == NUM_BUCKETS - 1) {
+            segregatedList[bucket].freeBlock(block);
+            continue;
+        }
+
+        chained[bucket]++;
+        chainedBytes[bucket] += block->size();
+        block->setUsed(false);
+        block->prev = last[bucket];
+        block->next = nullptr;
+        if(last[bucket]) last[bucket]->next = block;
+        else first[bucket] = block;
+        last[bucket] = block;
+    }
+
+    for(int bucket = 0; bucket < NUM_BUCKETS - 1; bucket++) {
+        if(first[bucket]) {
+            segregatedList[bucket].addChainToFreeList(first[bucket], last[bucket], chained[bucket], chainedBytes[bucket]);
+        }
+    }
+    for(int bucket = 0; bucket < NUM_BUCKETS; bucket++) updateBucketBit(bucket);
+}
+
+//anything resizeInPlace cannot do moves the payload
+word_t* SegregatedListAllocator::realloc(word_t* data, size_t size) {
+    if(data == nullptr) return alloc(size);
+    if(size == 0) {
+        free(data);
+        return nullptr;
+    }
+    if(size > MAX_REQUEST) return nullptr; //the block stays as it is
+
+    if(word_t* resized = resizeInPlace(data, size)) return resized;
+
+    size_t oldSize = usableSize(data);
+    word_t* newData = alloc(size);
+    if(!newData) return nullptr;
+
+    memcpy(newData, data, oldSize < size ? oldSize : size);
+    free(data);
+
+    return newData;
+}
+
+//small buckets never merge blocks, so their blocks only grow in place within the slack
+//of their size class; the merging heap's blocks also take a free successor or extend its
+//top, mapped blocks are resized by the kernel
+word_t* SegregatedListAllocator::resizeInPlace(word_t* data, size_t size) {
+    if(size > MAX_REQUEST) return nullptr;
+
+    size_t oldSize = usableSize(data);
+    Block* block = slabs.owns(data) ? nullptr : getHeader(data); //slab objects have no header
+    bool mapped = block && block->isMapped();
+    bool wantMapped = mmapThreshold && size >= mmapThreshold;
+
+    if(mapped && wantMapped) {
+        block = remapBlock(block, size);
+        if(!block) return nullptr; //the mapping stays as it is
+
+        //both wrap back down when it shrank
+        mappedStats.osBytes.addShared(block->size() - oldSize);
+        mappedStats.liveBytes.addShared(block->size() - oldSize);
+        return block->data;
+    }
+
+    //a heap block stays put only while it holds the whole class of the new size, so a
+    //sized free with that size still finds it big enough for the bucket it picks; it is
+    //cut down to that class and its live bytes move to the bucket of its new size
+    if(!mapped && !wantMapped && (block ? requestSize(size) : size) <= oldSize) {
+        int before = block ? homeBucket(block) : 0;
+        if(block && shrinkBlock(block, requestSize(size))) {
+            segregatedList[before].stats.liveBytes.sub(oldSize);
+            segregatedList[homeBucket(block)].stats.liveBytes.add(block->size());
+        }
+        return data;
+    }
+
+    //what a free successor or the top's growth adds beyond the request goes back at once
+    if(!wantMapped && block && inLargeHeap(block)) {
+        ExplicitAllocator& large = segregatedList[NUM_BUCKETS - 1];
+        size_t needed = requestSize(size);
+        large.absorbNext(block, needed);
+        if(needed > block->size()) large.growTop(block, needed);
+        if(needed <= block->size()) shrinkBlock(block, needed);
+
+        updateBucketBit(NUM_BUCKETS - 1);
+        large.stats.liveBytes.add(block->size() - oldSize);
+        if(needed <= block->size()) return data;
+    }
+
+    return nullptr;
+}
+
+size_t SegregatedListAllocator::trim() {
+    ExplicitAllocator& large = segregatedList[NUM_BUCKETS - 1];
+    return largeMerges() ? large.trim() : large.purge();
+}
+
+AllocStats SegregatedListAllocator::heapStats() const {
+    AllocStats total;
+    for(int i = 0; i < NUM_BUCKETS; i++) total += bucketStats(i);
+    for(int i = 0; i < SlabAllocator::NUM_CLASSES; i++) total += slabStats(i);
+    total += slabs.poolStats();
+    return total;
+}
+
+AllocStats SegregatedListAllocator::getStats() const {
+    AllocStats total = heapStats();
+    total += mapStats();
+    return total;
+}
+
+void SegregatedListAllocator::writeHeapStats(StatsJson& json) const {
+    json.beginArray("buckets");
+    for(int i = 0; i < NUM_BUCKETS; i++) json.add(nullptr, bucketStats(i));
+    json.endArray();
+
+    json.beginArray("slabs");
+    for(int i = 0; i < SlabAllocator::NUM_CLASSES; i++) json.add(nullptr, slabStats(i));
+    json.endArray();
+
+    json.add("slab_pool", slabs.poolStats());
+}
+
+size_t SegregatedListAllocator::statsJson(char* buffer, size_t capacity) const {
+    StatsJson json(buffer, capacity);
+    json.beginObject();
+    json.add("total", getStats());
+    writeHeapStats(json);
+    json.add("mapped", mapStats());
+    json.endObject();
+    return json.length();
+}
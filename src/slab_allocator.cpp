@@ -0,0 +1,178 @@
+#include "slab_allocator.h"
+
+size_t SlabAllocator::classSize(int sizeClass) {
+    return sizeof(word_t) << sizeClass;
+}
+
+//runs are RUN_SIZE aligned because the region is page aligned and grows in whole runs
+SlabRun* SlabAllocator::runOf(const void* data) {
+    return reinterpret_cast<SlabRun*>(reinterpret_cast<uintptr_t>(data) & ~(uintptr_t)(RUN_SIZE - 1));
+}
+
+bool SlabAllocator::owns(const void* data) const {
+    const char* ptr = static_cast<const char*>(data);
+    return ptr >= this->regionStart.load(std::memory_order_acquire) &&
+           ptr < this->regionEnd.load(std::memory_order_acquire);
+}
+
+void SlabAllocator::pushPartial(SlabRun* run) {
+    SlabRun* head = this->partialRuns[run->sizeClass];
+    run->prev = nullptr;
+    run->next = head;
+    if(head) head->prev = run;
+    this->partialRuns[run->sizeClass] = run;
+}
+
+void SlabAllocator::removePartial(SlabRun* run) {
+    if(run->prev) run->prev->next = run->next;
+    else this->partialRuns[run->sizeClass] = run->next;
+
+    if(run->next) run->next->prev = run->prev;
+    run->prev = run->next = nullptr;
+}
+
+//reuses an empty run if there is one, otherwise grows the region by one run
+//objects are carved lazily from `unused`, so a fresh run touches only its header
+SlabRun* SlabAllocator::newRun(int sizeClass) {
+    SlabRun* run = this->emptyRuns;
+
+    if(run) {
+        this->emptyRuns = run->next;
+        this->pooledRuns.sub();
+    } else {
+        char* memory = static_cast<char*>(this->region->extend(RUN_SIZE));
+        if(!memory) return nullptr;
+
+        if(this->regionStart.load(std::memory_order_relaxed) == nullptr) {
+            this->regionStart.store(memory, std::memory_order_release);
+        }
+        this->regionEnd.store(memory + RUN_SIZE, std::memory_order_release);
+        run = reinterpret_cast<SlabRun*>(memory);
+        this->runsTaken.add();
+    }
+
+    *run = SlabRun();
+    run->sizeClass = sizeClass;
+    run->objectSize = classSize(sizeClass);
+    run->capacity = (RUN_SIZE - RUN_HEADER_SIZE) / run->objectSize;
+    run->unused = reinterpret_cast<char*>(run) + RUN_HEADER_SIZE;
+    this->slots[sizeClass].add(run->capacity);
+
+    this->pushPartial(run);
+    return run;
+}
+
+word_t* SlabAllocator::alloc(int sizeClass) {
+    SlabRun* run = this->partialRuns[sizeClass];
+    if(!run && !(run = this->newRun(sizeClass))) return nullptr;
+
+    word_t* data = run->freeList;
+    if(data) {
+        run->freeList = *reinterpret_cast<word_t**>(data);
+    } else {
+        data = reinterpret_cast<word_t*>(run->unused);
+        run->unused += run->objectSize;
+    }
+
+    //full runs leave the partial list until an object comes back
+    if(++run->used == run->capacity) this->removePartial(run);
+    this->allocs[sizeClass].add();
+
+    return data;
+}
+
+void SlabAllocator::free(word_t* data) {
+    SlabRun* run = runOf(data);
+
+    *reinterpret_cast<word_t**>(data) = run->freeList;
+    run->freeList = data;
+
+    this->frees[run->sizeClass].add();
+    this->objectsReturned(run, 1);
+}
+
+size_t SlabAllocator::allocBatch(int sizeClass, size_t count, word_t** out) {
+    size_t done = 0;
+
+    while(done < count) {
+        SlabRun* run = this->partialRuns[sizeClass];
+        if(!run && !(run = this->newRun(sizeClass))) break;
+
+        while(done < count && run->used < run->capacity) {
+            word_t* data = run->freeList;
+            if(data) {
+                run->freeList = *reinterpret_cast<word_t**>(data);
+            } else {
+                data = reinterpret_cast<word_t*>(run->unused);
+                run->unused += run->objectSize;
+            }
+
+            run->used++;
+            out[done++] = data;
+        }
+
+        if(run->used == run->capacity) this->removePartial(run);
+    }
+
+    this->allocs[sizeClass].add(done);
+    return done;
+}
+
+void SlabAllocator::freeBatch(word_t** ptrs, size_t count) {
+    size_t i = 0;
+
+    while(i < count) {
+        SlabRun* run = runOf(ptrs[i]);
+        word_t* head = run->freeList;
+        uint32_t freed = 0;
+
+        for(; i < count && runOf(ptrs[i]) == run; i++, freed++) {
+            *reinterpret_cast<word_t**>(ptrs[i]) = head;
+            head = ptrs[i];
+        }
+
+        run->freeList = head;
+        this->frees[run->sizeClass].add(freed);
+        this->objectsReturned(run, freed);
+    }
+}
+
+//a run with room again goes back on its partial list, an emptied one into the pool
+void SlabAllocator::objectsReturned(SlabRun* run, uint32_t count) {
+    bool wasFull = run->used == run->capacity;
+    run->used -= count;
+    if(wasFull) this->pushPartial(run);
+
+    //the last partial run of a class stays put, so one object going back
+    //and forth does not recycle the run every time
+    if(run->used == 0 && (run->prev || run->next)) {
+        this->removePartial(run);
+        run->next = this->emptyRuns;
+        this->emptyRuns = run;
+        this->slots[run->sizeClass].sub(run->capacity);
+        this->pooledRuns.add();
+    }
+}
+
+//read without the counts in step, so the object counts are clamped
+AllocStats SlabAllocator::classStats(int sizeClass) const {
+    AllocStats stats;
+    stats.frees = this->frees[sizeClass].get();
+    stats.allocs = this->allocs[sizeClass].get();
+
+    uint64_t live = stats.allocs > stats.frees ? stats.allocs - stats.frees : 0;
+    uint64_t slots = this->slots[sizeClass].get();
+    stats.freeBlocks = slots > live ? slots - live : 0;
+    stats.liveBytes = live * classSize(sizeClass);
+    stats.freeBytes = stats.freeBlocks * classSize(sizeClass);
+    return stats;
+}
+
+AllocStats SlabAllocator::poolStats() const {
+    AllocStats stats;
+    stats.osRequests = this->runsTaken.get();
+    stats.osBytes = stats.osRequests * RUN_SIZE;
+    stats.freeBlocks = this->pooledRuns.get();
+    stats.freeBytes = stats.freeBlocks * (RUN_SIZE - RUN_HEADER_SIZE);
+    return stats;
+}
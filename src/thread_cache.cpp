@@ -0,0 +1,187 @@
+#include "thread_cache.h"
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+//epoch of the allocator currently owning each slot, 0 when the slot is free
+std::atomic<uint64_t> slotEpochs[ThreadCachedAllocator::MAX_INSTANCES];
+std::atomic<uint64_t> nextEpoch{1};
+//held by an exiting thread from the epoch check through its drain, and by the destructor
+//while it frees the slot, so an owner cannot be destroyed halfway through a drain
+std::mutex slotLocks[ThreadCachedAllocator::MAX_INSTANCES];
+
+//all caches of one thread, drained into their (still live) owners when the thread exits
+struct ThreadCacheSet {
+    ThreadCache caches[ThreadCachedAllocator::MAX_INSTANCES];
+
+    ~ThreadCacheSet() {
+        for(int i = 0; i < ThreadCachedAllocator::MAX_INSTANCES; i++) {
+            ThreadCache& cache = this->caches[i];
+            if(cache.owner == nullptr) continue;
+            std::lock_guard<std::mutex> lock(slotLocks[i]);
+            if(slotEpochs[i].load(std::memory_order_acquire) != cache.epoch) continue; //owner is gone
+            cache.owner->drain(cache);
+        }
+    }
+};
+
+thread_local ThreadCacheSet threadCaches;
+
+inline word_t* nextCached(word_t* data) {
+    return *reinterpret_cast<word_t**>(data);
+}
+
+inline void setNextCached(word_t* data, word_t* next) {
+    *reinterpret_cast<word_t**>(data) = next;
+}
+
+}
+
+ThreadCachedAllocator::ThreadCachedAllocator() {
+    this->epoch = nextEpoch.fetch_add(1, std::memory_order_relaxed);
+
+    for(int i = 0; i < MAX_INSTANCES; i++) {
+        uint64_t expected = 0;
+        if(slotEpochs[i].compare_exchange_strong(expected, this->epoch, std::memory_order_acq_rel)) {
+            this->slot = i;
+            break;
+        }
+    }
+    //no free slot: every call goes through the shared lists under the lock
+}
+
+ThreadCachedAllocator::~ThreadCachedAllocator() {
+    if(this->slot >= 0) {
+        std::lock_guard<std::mutex> lock(slotLocks[this->slot]);
+        slotEpochs[this->slot].store(0, std::memory_order_release);
+    }
+}
+
+size_t ThreadCachedAllocator::cachedSize(int bucket) {
+    return sizeof(word_t) << bucket; //8 16 32 64 128, same as the shared buckets
+}
+
+//a cached block must be able to serve any request of its bucket,
+//so a block lands in the largest bucket whose size it fully covers
+int ThreadCachedAllocator::cachedBucket(size_t blockSize) {
+    int bucket = this->shared.getFreeBucket(blockSize);
+    return bucket < NUM_CACHED_BUCKETS ? bucket : -1;
+}
+
+ThreadCache& ThreadCachedAllocator::localCache() {
+    ThreadCache& cache = threadCaches.caches[this->slot];
+
+    if(cache.epoch != this->epoch) {
+        //slot was used by an allocator that no longer exists, its blocks went with it
+        cache = ThreadCache();
+        cache.owner = this;
+        cache.epoch = this->epoch;
+    }
+
+    return cache;
+}
+
+bool ThreadCachedAllocator::refill(ThreadCache& cache, int bucket) {
+    std::lock_guard<std::mutex> guard(this->sharedLock);
+
+    for(int i = 0; i < BATCH_SIZE; i++) {
+        word_t* data = this->shared.alloc(cachedSize(bucket));
+        if(!data) break;
+
+        setNextCached(data, cache.freeList[bucket]);
+        cache.freeList[bucket] = data;
+        cache.count[bucket]++;
+    }
+
+    return cache.freeList[bucket] != nullptr;
+}
+
+void ThreadCachedAllocator::flush(ThreadCache& cache, int bucket, int count) {
+    std::lock_guard<std::mutex> guard(this->sharedLock);
+
+    while(count-- > 0 && cache.freeList[bucket]) {
+        word_t* data = cache.freeList[bucket];
+        cache.freeList[bucket] = nextCached(data);
+        cache.count[bucket]--;
+        this->shared.free(data, cachedSize(bucket)); //every block cached for the bucket holds this much
+    }
+}
+
+word_t* ThreadCachedAllocator::alloc(size_t size) {
+    int bucket = this->shared.getBucket(size);
+
+    if(bucket >= NUM_CACHED_BUCKETS || this->slot < 0) {
+        std::lock_guard<std::mutex> guard(this->sharedLock);
+        return this->shared.alloc(size);
+    }
+
+    ThreadCache& cache = this->localCache();
+    if(!cache.freeList[bucket] && !this->refill(cache, bucket)) return nullptr;
+
+    word_t* data = cache.freeList[bucket];
+    cache.freeList[bucket] = nextCached(data);
+    cache.count[bucket]--;
+
+    return data;
+}
+
+//cached blocks are always recycled, so small requests are cleared here;
+//larger ones let the shared allocator skip clearing fresh memory
+word_t* ThreadCachedAllocator::calloc(size_t count, size_t size) {
+    size_t bytes;
+    if(__builtin_mul_overflow(count, size, &bytes)) return nullptr;
+
+    if(this->shared.getBucket(bytes) >= NUM_CACHED_BUCKETS || this->slot < 0) {
+        std::lock_guard<std::mutex> guard(this->sharedLock);
+        return this->shared.calloc(1, bytes);
+    }
+
+    word_t* data = this->alloc(bytes);
+    if(data) memset(data, 0, bytes);
+    return data;
+}
+
+void ThreadCachedAllocator::free(word_t* data) {
+    this->release(data, this->cachedBucket(this->shared.usableSize(data)));
+}
+
+//blocks handed out for a cached bucket are at least cachedSize(bucket) bytes
+void ThreadCachedAllocator::free(word_t* data, size_t size) {
+    if(this->verifySizedFree) verifyFreeSize(data, size, this->shared.usableSize(data));
+
+    int bucket = this->shared.getBucket(size);
+    this->release(data, bucket < NUM_CACHED_BUCKETS ? bucket : -1);
+}
+
+void ThreadCachedAllocator::release(word_t* data, int bucket) {
+    if(bucket < 0 || this->slot < 0) {
+        std::lock_guard<std::mutex> guard(this->sharedLock);
+        this->shared.free(data);
+        return;
+    }
+
+    ThreadCache& cache = this->localCache();
+    setNextCached(data, cache.freeList[bucket]);
+    cache.freeList[bucket] = data;
+    cache.count[bucket]++;
+
+    if(cache.count[bucket] >= CACHE_CAPACITY) {
+        this->flush(cache, bucket, BATCH_SIZE);
+    }
+}
+
+size_t ThreadCachedAllocator::usableSize(word_t* data) {
+    return this->shared.usableSize(data);
+}
+
+void ThreadCachedAllocator::flushThreadCache() {
+    if(this->slot < 0) return;
+    this->drain(this->localCache());
+}
+
+void ThreadCachedAllocator::drain(ThreadCache& cache) {
+    for(int bucket = 0; bucket < NUM_CACHED_BUCKETS; bucket++) {
+        this->flush(cache, bucket, cache.count[bucket]);
+    }
+}
\ No newline at end of file
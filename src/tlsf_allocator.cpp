@@ -0,0 +1,260 @@
+#include "block_utils.h"
+#include "tlsf_allocator.h"
+
+//index of the most significant set bit
+static int fls(size_t n) {
+    return 63 - __builtin_clzll(n);
+}
+
+//first level = power of two of the size, second level = next SL_INDEX_COUNT_LOG2 bits
+//sizes below SMALL_BLOCK_SIZE all share first level 0 in steps of the alignment
+void TlsfAllocator::mappingInsert(size_t size, int& fl, int& sl) {
+    if(size < SMALL_BLOCK_SIZE) {
+        fl = 0;
+        sl = (int)(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+        return;
+    }
+
+    int bit = fls(size);
+    sl = (int)(size >> (bit - SL_INDEX_COUNT_LOG2)) ^ (1 << SL_INDEX_COUNT_LOG2);
+    fl = bit - (FL_INDEX_SHIFT - 1);
+}
+
+//rounds the size up to the next bin boundary first, so every block in the
+//bin found (or any bin above it) is large enough without looking at it
+void TlsfAllocator::mappingSearch(size_t size, int& fl, int& sl) {
+    if(size >= SMALL_BLOCK_SIZE) {
+        size += (size_t(1) << (fls(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+
+    this->mappingInsert(size, fl, sl);
+}
+
+Block* TlsfAllocator::findSuitableBlock(int& fl, int& sl) {
+    //rest of the bins in this first level
+    uint32_t slMap = this->slBitmap[fl] & (~0u << sl);
+
+    if(!slMap) {
+        //nothing here, take the smallest non-empty first level above
+        uint32_t flMap = (fl + 1 < 32) ? this->flBitmap & (~0u << (fl + 1)) : 0;
+        if(!flMap) return nullptr;
+
+        fl = __builtin_ctz(flMap);
+        slMap = this->slBitmap[fl];
+    }
+
+    sl = __builtin_ctz(slMap);
+    return this->freeLists[fl][sl];
+}
+
+void TlsfAllocator::insertBlock(Block* block) {
+    int fl, sl;
+    this->mappingInsert(block->size(), fl, sl);
+
+    Block* head = this->freeLists[fl][sl];
+    block->prev = nullptr;
+    block->next = head;
+    if(head) head->prev = block;
+
+    this->freeLists[fl][sl] = block;
+    this->flBitmap |= (1u << fl);
+    this->slBitmap[fl] |= (1u << sl);
+    this->stats.freeBlocks.add();
+    this->stats.freeBytes.add(block->size());
+}
+
+void TlsfAllocator::removeBlock(Block* block) {
+    int fl, sl;
+    this->mappingInsert(block->size(), fl, sl);
+
+    Block* prevBlock = block->prev;
+    Block* nextBlock = block->next;
+
+    if(prevBlock) prevBlock->next = nextBlock;
+    if(nextBlock) nextBlock->prev = prevBlock;
+
+    if(this->freeLists[fl][sl] == block) {
+        this->freeLists[fl][sl] = nextBlock;
+
+        if(!nextBlock) {
+            this->slBitmap[fl] &= ~(1u << sl);
+            if(!this->slBitmap[fl]) this->flBitmap &= ~(1u << fl);
+        }
+    }
+    this->stats.freeBlocks.sub();
+    this->stats.freeBytes.sub(block->size());
+}
+
+//only free blocks carry a footer, so the previous block can only be found while it is free
+Block* TlsfAllocator::getPhysicalPreviousBlock(Block* block) {
+    if(block == this->heapStart || block->isPrevUsed()) {
+        return nullptr;
+    }
+
+    return getPreviousFromFooter(block);
+}
+
+Block* TlsfAllocator::getPhysicalNextBlock(Block* block) {
+    if(block == this->top) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<Block*>(reinterpret_cast<char*>(block->data) + block->size());
+}
+
+void TlsfAllocator::setPhysicalNextPrevUsed(Block* block, bool prevUsed) {
+    Block* nextBlock = this->getPhysicalNextBlock(block);
+    if(nextBlock) nextBlock->setPrevUsed(prevUsed);
+}
+
+bool TlsfAllocator::canSplit(Block* block, size_t size) {
+    return block->size() >= size + HEADER_SIZE + MIN_FREE_PAYLOAD;
+}
+
+//cuts `size` bytes off the front of a block, the rest becomes a new free block
+Block* TlsfAllocator::split(Block* block, size_t size) {
+    Block* remainder = reinterpret_cast<Block*>(reinterpret_cast<char*>(block->data) + size);
+
+    remainder->header = block->size() - size - HEADER_SIZE;
+    remainder->setPrevUsed(block->isUsed());
+    writeFooter(remainder);
+
+    if(block == this->top) this->top = remainder;
+    else this->setPhysicalNextPrevUsed(remainder, false);
+
+    block->setSize(size);
+    this->stats.splits.add();
+
+    return block;
+}
+
+//a merge may not grow a block past MAX_BLOCK_SIZE, there is no bin above it
+bool TlsfAllocator::canMerge(Block* block, Block* neighbour) {
+    return block->size() + HEADER_SIZE + neighbour->size() <= MAX_BLOCK_SIZE;
+}
+
+//merges a block that is in no list with its free physical neighbours,
+//a neighbour that would make it too large is left as a free block of its own
+Block* TlsfAllocator::coalesce(Block* block) {
+    Block* nextBlock = this->getPhysicalNextBlock(block);
+
+    if(nextBlock && !nextBlock->isUsed() && this->canMerge(block, nextBlock)) {
+        this->removeBlock(nextBlock);
+        block->setSize(block->size() + nextBlock->size() + HEADER_SIZE);
+        if(nextBlock == this->top) this->top = block;
+        this->stats.coalesces.add();
+    }
+
+    Block* prevBlock = this->getPhysicalPreviousBlock(block);
+    if(prevBlock && this->canMerge(prevBlock, block)) {
+        this->removeBlock(prevBlock);
+        prevBlock->setSize(prevBlock->size() + block->size() + HEADER_SIZE);
+        if(block == this->top) this->top = prevBlock;
+        this->stats.coalesces.add();
+        block = prevBlock;
+    }
+
+    return block;
+}
+
+word_t* TlsfAllocator::alloc(size_t size) {
+    if(size > MAX_BLOCK_SIZE) return nullptr; //before align, which wraps near SIZE_MAX
+    size = align(size);
+    if(size < MIN_FREE_PAYLOAD) size = MIN_FREE_PAYLOAD; //room for links and footer once freed
+
+    Block* block = this->allocBlock(size);
+    if(!block) return nullptr;
+
+    this->stats.allocs.add();
+    this->stats.liveBytes.add(block->size());
+    return block->data;
+}
+
+Block* TlsfAllocator::allocBlock(size_t size) {
+    if(size > MAX_BLOCK_SIZE) return nullptr;
+
+    int fl, sl;
+    this->mappingSearch(size, fl, sl);
+
+    Block* block = (fl < FL_INDEX_COUNT) ? this->findSuitableBlock(fl, sl) : nullptr;
+
+    if(block) {
+        this->removeBlock(block);
+
+        if(this->canSplit(block, size)) {
+            this->split(block, size);
+            this->insertBlock(this->getPhysicalNextBlock(block));
+        }
+    } else {
+        block = requestFromOS(this->provider, size);
+        if(!block) return nullptr;
+        this->stats.osRequests.add();
+        this->stats.osBytes.add(allocSize(size));
+
+        block->header = size;
+        block->setPrevUsed(this->top == nullptr || this->top->isUsed());
+
+        if(this->heapStart == nullptr) {
+            this->heapStart = block;
+        }
+
+        this->top = block;
+    }
+
+    block->setUsed(true);
+    this->setPhysicalNextPrevUsed(block, true);
+
+    return block;
+}
+
+word_t* TlsfAllocator::allocAligned(size_t size, size_t alignment) {
+    if(!isValidAlignment(alignment)) return nullptr;
+    if(alignment <= sizeof(word_t)) return this->alloc(size);
+
+    if(size > MAX_BLOCK_SIZE) return nullptr;
+    size = align(size);
+    if(size < MIN_FREE_PAYLOAD) size = MIN_FREE_PAYLOAD;
+
+    //room for the aligned payload wherever the block starts
+    Block* block = this->allocBlock(size + MIN_FREE_PAYLOAD + alignment);
+    if(!block) return nullptr;
+
+    if(size_t lead = alignedLead(block->data, alignment, MIN_FREE_PAYLOAD)) {
+        Block* front = block;
+        block = splitFront(front, lead);
+        if(front == this->top) this->top = block;
+        this->stats.splits.add();
+        this->freeBlock(front); //merges the front with a free predecessor
+    }
+
+    if(this->canSplit(block, size)) {
+        this->split(block, size);
+        this->freeBlock(this->getPhysicalNextBlock(block));
+    }
+
+    this->stats.allocs.add();
+    this->stats.liveBytes.add(block->size());
+    return block->data;
+}
+
+void TlsfAllocator::free(word_t* data) {
+    Block* block = getHeader(data);
+    this->stats.frees.add();
+    this->stats.liveBytes.sub(block->size());
+    this->freeBlock(block);
+}
+
+void TlsfAllocator::freeBlock(Block* block) {
+    block->setUsed(false);
+
+    block = this->coalesce(block);
+    writeFooter(block);
+    this->setPhysicalNextPrevUsed(block, false);
+
+    this->insertBlock(block);
+}
+
+void TlsfAllocator::free(word_t* data, size_t size) {
+    if(this->verifySizedFree) verifyFreeSize(data, size, getHeader(data)->size());
+    this->free(data);
+}
\ No newline at end of file